@@ -0,0 +1,54 @@
+#pragma once
+
+#include "sensors/BaseLidarSensor.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+namespace benchmarks
+{
+
+constexpr int kLaserCount = 32;
+constexpr int kAzimuthSteps = 2170;
+constexpr float kMountHeight = 1.8F;
+constexpr float kPi = 3.14159265F;
+constexpr std::size_t kBeamsPerScan = static_cast<std::size_t>(kLaserCount) * kAzimuthSteps;
+
+/// Calls `beam(elevation, azimuth)` [rad] for every beam of one HDL-32-like revolution: 32 lasers
+/// from -30.67 to +10.67 degrees, laser by laser, each sweeping kAzimuthSteps azimuths.
+template <typename Beam>
+void forEachBeam(Beam&& beam)
+{
+    for (int laser = 0; laser < kLaserCount; ++laser)
+    {
+        const float elevation = (-30.67F + 1.33F * static_cast<float>(laser)) * kPi / 180.0F;
+        for (int step = 0; step < kAzimuthSteps; ++step)
+        {
+            const float azimuth = 2.0F * kPi * static_cast<float>(step) / static_cast<float>(kAzimuthSteps);
+            beam(elevation, azimuth);
+        }
+    }
+}
+
+/// Appends an HDL-32-like scan over a flat floor kMountHeight below the sensor, closed by a wavy
+/// wall between 30 and 50 m, shifted by `offsetY` [m].
+inline void appendWavyWallScan(float offsetY, lidar::BaseLidarSensor::PointCloud& points)
+{
+    forEachBeam(
+        [&](float elevation, float azimuth)
+        {
+            float range = 40.0F + 10.0F * std::sin(3.0F * azimuth);
+            if (elevation < 0.0F)
+            {
+                range = std::min(range, kMountHeight / std::tan(-elevation));
+            }
+            const float horizontal = range * std::cos(elevation);
+            points.push_back(lidar::LidarPoint{horizontal * std::cos(azimuth),
+                                               horizontal * std::sin(azimuth) + offsetY,
+                                               range * std::sin(elevation),
+                                               1.0F});
+        });
+}
+
+} // namespace benchmarks
@@ -0,0 +1,149 @@
+#include "benchmarks/SyntheticScan.hpp"
+#include "engine/ThreadPool.hpp"
+#include "mapping/KdTree.hpp"
+#include "sensors/BaseLidarSensor.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include <random>
+#include <vector>
+
+namespace
+{
+
+constexpr std::size_t kNeighbours = 8U;
+constexpr float kRadius = 0.5F;
+
+lidar::BaseLidarSensor::PointCloud makeScan()
+{
+    lidar::BaseLidarSensor::PointCloud points;
+    points.reserve(benchmarks::kBeamsPerScan);
+    benchmarks::appendWavyWallScan(0.0F, points);
+    return points;
+}
+
+// Queries are jittered scan points, as outlier removal or normal estimation would issue them.
+lidar::BaseLidarSensor::PointCloud makeQueries(const lidar::BaseLidarSensor::PointCloud& scan, std::size_t count)
+{
+    std::mt19937 rng(3U);
+    std::uniform_int_distribution<std::size_t> pick(0U, scan.size() - 1U);
+    std::uniform_real_distribution<float> jitter(-0.1F, 0.1F);
+    lidar::BaseLidarSensor::PointCloud queries(count);
+    for (auto& query : queries)
+    {
+        query = scan[pick(rng)];
+        query.x += jitter(rng);
+        query.y += jitter(rng);
+        query.z += jitter(rng);
+    }
+    return queries;
+}
+
+float distanceSquared(const lidar::LidarPoint& a, const lidar::LidarPoint& b)
+{
+    const float dx = a.x - b.x;
+    const float dy = a.y - b.y;
+    const float dz = a.z - b.z;
+    return dx * dx + dy * dy + dz * dz;
+}
+
+template <typename Body>
+double millisecondsPer(int iterations, Body&& body)
+{
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i)
+    {
+        body();
+    }
+    const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / iterations;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    const int iterations = argc > 1 ? std::max(1, std::atoi(argv[1])) : 20;
+    const std::size_t queryCount = argc > 2 ? static_cast<std::size_t>(std::max(1, std::atoi(argv[2]))) : 1000U;
+    const auto scan = makeScan();
+    const auto queries = makeQueries(scan, queryCount);
+    lidar::ThreadPool pool;
+
+    std::printf("%zu points, %zu queries, %d iterations, %zu pool threads\n",
+                scan.size(),
+                queries.size(),
+                iterations,
+                pool.concurrency());
+    std::printf("%-28s %12s\n", "operation", "ms");
+
+    mapping::KdTree tree;
+    std::printf("%-28s %12.3f\n", "build", millisecondsPer(iterations, [&]() { tree.build(scan); }));
+    tree.setThreadPool(&pool);
+    std::printf("%-28s %12.3f\n", "build (pool)", millisecondsPer(iterations, [&]() { tree.build(scan); }));
+    tree.setThreadPool(nullptr);
+
+    // The checksums keep the optimizer from dropping the queries.
+    std::size_t checksum = 0U;
+    std::array<mapping::KdNeighbour, kNeighbours> neighbours;
+    std::vector<mapping::KdNeighbour> inRadius;
+    std::printf("%-28s %12.3f\n", "nearest", millisecondsPer(iterations, [&]() {
+                    for (const auto& query : queries)
+                    {
+                        mapping::KdNeighbour closest;
+                        tree.nearest(glm::vec3(query.x, query.y, query.z), closest);
+                        checksum += closest.index;
+                    }
+                }));
+    std::printf("%-28s %12.3f\n", "nearest (brute force)", millisecondsPer(std::max(1, iterations / 10), [&]() {
+                    for (const auto& query : queries)
+                    {
+                        float best = std::numeric_limits<float>::infinity();
+                        std::size_t bestIndex = 0U;
+                        for (std::size_t i = 0; i < scan.size(); ++i)
+                        {
+                            const float distance = distanceSquared(scan[i], query);
+                            bestIndex = distance < best ? i : bestIndex;
+                            best = std::min(best, distance);
+                        }
+                        checksum += bestIndex;
+                    }
+                }));
+    std::printf("%-28s %12.3f\n", "8-nn", millisecondsPer(iterations, [&]() {
+                    for (const auto& query : queries)
+                    {
+                        checksum += tree.nearestK(glm::vec3(query.x, query.y, query.z), neighbours);
+                    }
+                }));
+    std::printf("%-28s %12.3f\n", "radius 0.5 m", millisecondsPer(iterations, [&]() {
+                    for (const auto& query : queries)
+                    {
+                        tree.radiusSearch(glm::vec3(query.x, query.y, query.z), kRadius, inRadius);
+                        checksum += inRadius.size();
+                    }
+                }));
+    std::printf("%-28s %12.3f\n", "radius 0.5 m (brute force)", millisecondsPer(std::max(1, iterations / 10), [&]() {
+                    for (const auto& query : queries)
+                    {
+                        checksum += static_cast<std::size_t>(std::count_if(
+                            scan.begin(), scan.end(), [&query](const lidar::LidarPoint& point) {
+                                return distanceSquared(point, query) <= kRadius * kRadius;
+                            }));
+                    }
+                }));
+
+    std::vector<mapping::KdNeighbour> batch;
+    std::printf("%-28s %12.3f\n", "8-nn batch", millisecondsPer(iterations, [&]() {
+                    tree.nearestKBatch(queries, kNeighbours, batch);
+                }));
+    tree.setThreadPool(&pool);
+    std::printf("%-28s %12.3f\n", "8-nn batch (pool)", millisecondsPer(iterations, [&]() {
+                    tree.nearestKBatch(queries, kNeighbours, batch);
+                }));
+
+    std::printf("checksum %zu\n", checksum);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,181 @@
+#include "benchmarks/SyntheticScan.hpp"
+#include "engine/ThreadPool.hpp"
+#include "mapping/ScanRegistration.hpp"
+#include "sensors/BaseLidarSensor.hpp"
+#include "sensors/LidarFactory.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+using benchmarks::kMountHeight;
+using benchmarks::kPi;
+
+constexpr float kMaxRange = 100.0F;
+constexpr std::size_t kSyntheticScans = 50U;
+
+struct Box
+{
+    Eigen::Vector3f min;
+    Eigen::Vector3f max;
+};
+
+// Street canyon: staggered facades on both sides, parked cars and poles, all in world coordinates.
+std::vector<Box> makeStreet()
+{
+    std::vector<Box> boxes;
+    for (int block = 0; block < 20; ++block)
+    {
+        const float x = -40.0F + 12.0F * static_cast<float>(block);
+        const float setback = 2.0F * static_cast<float>(block % 3);
+        boxes.push_back({{x, 9.0F + setback, -kMountHeight}, {x + 10.0F, 20.0F, 12.0F}});
+        boxes.push_back({{x + 4.0F, -20.0F, -kMountHeight}, {x + 14.0F, -8.0F - setback, 9.0F}});
+        boxes.push_back({{x + 2.0F, 5.5F, -kMountHeight}, {x + 6.5F, 7.3F, -0.3F}});
+        boxes.push_back({{x + 7.0F, -6.5F, -kMountHeight}, {x + 7.3F, -6.2F, 3.0F}});
+    }
+    return boxes;
+}
+
+float intersect(const Box& box, const Eigen::Vector3f& origin, const Eigen::Vector3f& direction)
+{
+    float near = 0.0F;
+    float far = kMaxRange;
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        const float inverse = 1.0F / direction[axis];
+        float t0 = (box.min[axis] - origin[axis]) * inverse;
+        float t1 = (box.max[axis] - origin[axis]) * inverse;
+        if (t0 > t1)
+        {
+            std::swap(t0, t1);
+        }
+        near = std::max(near, t0);
+        far = std::min(far, t1);
+    }
+    return near <= far ? near : std::numeric_limits<float>::infinity();
+}
+
+// Ray-casts an HDL-32-like scan from `pose` (x, y, yaw) and returns it in the sensor frame.
+lidar::BaseLidarSensor::PointCloud castScan(const std::vector<Box>& street, float x, float y, float yaw)
+{
+    lidar::BaseLidarSensor::PointCloud points;
+    points.reserve(benchmarks::kBeamsPerScan);
+    const Eigen::Vector3f origin(x, y, 0.0F);
+    benchmarks::forEachBeam(
+        [&](float elevation, float azimuth)
+        {
+            const Eigen::Vector3f local(
+                std::cos(elevation) * std::cos(azimuth), std::cos(elevation) * std::sin(azimuth), std::sin(elevation));
+            const Eigen::Vector3f world(std::cos(yaw) * local.x() - std::sin(yaw) * local.y(),
+                                        std::sin(yaw) * local.x() + std::cos(yaw) * local.y(),
+                                        local.z());
+            float range = elevation < 0.0F ? kMountHeight / -world.z() : std::numeric_limits<float>::infinity();
+            for (const auto& box : street)
+            {
+                range = std::min(range, intersect(box, origin, world));
+            }
+            if (range < kMaxRange)
+            {
+                points.push_back(lidar::LidarPoint{local.x() * range, local.y() * range, local.z() * range, 1.0F});
+            }
+        });
+    return points;
+}
+
+std::vector<lidar::BaseLidarSensor::PointCloud> readCapture(const std::string& path, std::size_t maxScans)
+{
+    std::vector<lidar::BaseLidarSensor::PointCloud> scans;
+    auto sensor = lidar::LidarFactory::createSensor("velodyne", path);
+    if (!sensor)
+    {
+        return scans;
+    }
+    sensor->configure(30.0F, 120.0F);
+    lidar::BaseLidarSensor::PointCloud scan;
+    uint64_t timestamp = 0U;
+    while (scans.size() < maxScans && sensor->readNextScan(scan, timestamp))
+    {
+        scans.push_back(scan);
+    }
+    return scans;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    const std::string path = argc > 1 ? argv[1] : "data/testCase.pcap";
+    const std::size_t maxScans = argc > 2 ? static_cast<std::size_t>(std::max(2, std::atoi(argv[2]))) : 100U;
+
+    auto scans = readCapture(path, maxScans);
+    // Ground truth only exists for the synthetic drive: 1 m per scan (10 m/s), weaving across the lane.
+    std::vector<Eigen::Vector3f> truth;
+    if (scans.size() < 2U)
+    {
+        std::printf("%s holds fewer than two scans; using a synthetic street drive\n", path.c_str());
+        scans.clear();
+        const auto street = makeStreet();
+        for (std::size_t i = 0; i < kSyntheticScans; ++i)
+        {
+            const float t = static_cast<float>(i);
+            truth.emplace_back(t, 1.5F * std::sin(t / 8.0F), std::atan(0.1875F * std::cos(t / 8.0F)));
+            scans.push_back(castScan(street, truth.back().x(), truth.back().y(), truth.back().z()));
+        }
+    }
+
+    lidar::ThreadPool pool;
+    mapping::ScanRegistration registration;
+    registration.setThreadPool(&pool);
+    mapping::RegistrationResult result;
+    registration.registerScan(scans.front(), result);
+
+    double totalMs = 0.0;
+    double worstMs = 0.0;
+    std::size_t iterations = 0U;
+    std::size_t failures = 0U;
+    for (std::size_t i = 1; i < scans.size(); ++i)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        failures += registration.registerScan(scans[i], result) ? 0U : 1U;
+        const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        totalMs += elapsed.count();
+        worstMs = std::max(worstMs, elapsed.count());
+        iterations += result.iterations;
+    }
+
+    const std::size_t registered = scans.size() - 1U;
+    const Eigen::Vector3f position = registration.pose().translation();
+    const float yaw = std::atan2(registration.pose().linear()(1, 0), registration.pose().linear()(0, 0));
+    std::printf("%zu scans of ~%zu points, %zu pool threads\n", scans.size(), scans.front().size(), pool.concurrency());
+    std::printf("%.2f ms/scan (worst %.2f ms), %.1f iterations/scan, %zu failed\n",
+                totalMs / static_cast<double>(registered),
+                worstMs,
+                static_cast<double>(iterations) / static_cast<double>(registered),
+                failures);
+    std::printf("final pose x %.3f m  y %.3f m  yaw %.2f deg\n", position.x(), position.y(), yaw * 180.0F / kPi);
+    if (!truth.empty())
+    {
+        // Express the final ground-truth pose in the frame of the first scan.
+        const float startYaw = truth.front().z();
+        const Eigen::Vector3f travelled = truth.back() - truth.front();
+        const float endX = std::cos(startYaw) * travelled.x() + std::sin(startYaw) * travelled.y();
+        const float endY = -std::sin(startYaw) * travelled.x() + std::cos(startYaw) * travelled.y();
+        const float distance = std::hypot(endX, endY);
+        std::printf("ground truth x %.3f m  y %.3f m  yaw %.2f deg, drift %.2f%% of %.1f m\n",
+                    endX,
+                    endY,
+                    travelled.z() * 180.0F / kPi,
+                    100.0F * std::hypot(endX - position.x(), endY - position.y()) / distance,
+                    distance);
+    }
+    return EXIT_SUCCESS;
+}
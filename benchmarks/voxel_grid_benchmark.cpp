@@ -0,0 +1,62 @@
+#include "benchmarks/SyntheticScan.hpp"
+#include "mapping/VoxelGridFilter.hpp"
+#include "sensors/BaseLidarSensor.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+namespace
+{
+
+// Several scans stacked along y, as an accumulated map would be, reach the voxel counts where
+// the radix sort pays off.
+lidar::BaseLidarSensor::PointCloud makeScans(int scanCount)
+{
+    lidar::BaseLidarSensor::PointCloud points;
+    points.reserve(static_cast<std::size_t>(scanCount) * benchmarks::kBeamsPerScan);
+    for (int scan = 0; scan < scanCount; ++scan)
+    {
+        benchmarks::appendWavyWallScan(1.3F * static_cast<float>(scan), points);
+    }
+    return points;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    const int iterations = argc > 1 ? std::max(1, std::atoi(argv[1])) : 50;
+    const int scanCount = argc > 2 ? std::max(1, std::atoi(argv[2])) : 1;
+    const auto scan = makeScans(scanCount);
+    constexpr std::array<float, 6> kLeafSizes = {0.02F, 0.05F, 0.1F, 0.2F, 0.5F, 1.0F};
+    constexpr std::array<mapping::VoxelGridMethod, 2> kMethods = {mapping::VoxelGridMethod::Hash,
+                                                                   mapping::VoxelGridMethod::RadixSort};
+
+    std::printf("%zu points, %d iterations\n", scan.size(), iterations);
+    std::printf("%8s  %-10s %10s %12s\n", "leaf [m]", "method", "voxels", "ms/frame");
+    lidar::BaseLidarSensor::PointCloud output;
+    for (const float leafSize : kLeafSizes)
+    {
+        for (const auto method : kMethods)
+        {
+            mapping::VoxelGridFilter filter({leafSize, mapping::VoxelReduction::Centroid, method});
+            filter.filter(scan, output); // Warm-up grows the arena.
+
+            const auto start = std::chrono::steady_clock::now();
+            for (int i = 0; i < iterations; ++i)
+            {
+                filter.filter(scan, output);
+            }
+            const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+            std::printf("%8.2f  %-10s %10zu %12.3f\n",
+                        leafSize,
+                        method == mapping::VoxelGridMethod::Hash ? "hash" : "radix",
+                        output.size(),
+                        elapsed.count() / iterations);
+        }
+    }
+    return EXIT_SUCCESS;
+}
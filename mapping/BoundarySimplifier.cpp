@@ -0,0 +1,134 @@
+#include "mapping/BoundarySimplifier.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace mapping
+{
+
+namespace
+{
+float segmentDistance(const glm::vec2& a, const glm::vec2& b, const glm::vec2& point) noexcept
+{
+    const glm::vec2 edge = b - a;
+    const float lengthSquared = glm::dot(edge, edge);
+    float t = 0.0F;
+    if (lengthSquared > 0.0F)
+    {
+        t = std::clamp(glm::dot(point - a, edge) / lengthSquared, 0.0F, 1.0F);
+    }
+    const glm::vec2 offset = point - (a + edge * t);
+    return std::sqrt(glm::dot(offset, offset));
+}
+} // namespace
+
+BoundarySimplifier::BoundarySimplifier(const BoundarySimplifierSettings& settings)
+{
+    configure(settings);
+}
+
+void BoundarySimplifier::configure(const BoundarySimplifierSettings& settings)
+{
+    m_settings = settings;
+    m_settings.tolerance = std::max(settings.tolerance, 0.0F);
+    m_settings.maxVertices = std::max(settings.maxVertices, kMinVertices);
+}
+
+float BoundarySimplifier::simplify(std::span<const glm::vec2> polygon, std::vector<glm::vec2>& simplified)
+{
+    simplified.clear();
+    const std::size_t count = polygon.size();
+    if (count <= kMinVertices)
+    {
+        simplified.assign(polygon.begin(), polygon.end());
+        return 0.0F;
+    }
+
+    uint32_t farthest = 0U;
+    float farthestSquared = -1.0F;
+    for (uint32_t i = 1U; i < count; ++i)
+    {
+        const glm::vec2 offset = polygon[i] - polygon[0];
+        const float distanceSquared = glm::dot(offset, offset);
+        if (distanceSquared > farthestSquared)
+        {
+            farthestSquared = distanceSquared;
+            farthest = i;
+        }
+    }
+
+    m_keep.assign(count, 0U);
+    m_keep[0] = 1U;
+    m_keep[farthest] = 1U;
+    std::size_t kept = 2U;
+    m_heap.clear();
+    m_heap.reserve(count);
+    pushEdge(polygon, 0U, farthest);
+    pushEdge(polygon, farthest, static_cast<uint32_t>(count));
+
+    while (!m_heap.empty())
+    {
+        const float worst = m_heap.front().deviation;
+        bool split = kept < kMinVertices;
+        if (m_settings.mode == SimplificationMode::DouglasPeucker)
+        {
+            split = split || worst > m_settings.tolerance;
+        }
+        else
+        {
+            split = split || (kept < m_settings.maxVertices && worst > 0.0F);
+        }
+        if (!split)
+        {
+            break;
+        }
+
+        std::pop_heap(m_heap.begin(), m_heap.end(), lessDeviation);
+        const Edge edge = m_heap.back();
+        m_heap.pop_back();
+        m_keep[edge.farthest] = 1U;
+        ++kept;
+        pushEdge(polygon, edge.first, edge.farthest);
+        pushEdge(polygon, edge.farthest, edge.last);
+    }
+
+    simplified.reserve(kept);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        if (m_keep[i] != 0U)
+        {
+            simplified.push_back(polygon[i]);
+        }
+    }
+    return m_heap.empty() ? 0.0F : m_heap.front().deviation;
+}
+
+bool BoundarySimplifier::lessDeviation(const Edge& lhs, const Edge& rhs) noexcept
+{
+    return lhs.deviation < rhs.deviation;
+}
+
+void BoundarySimplifier::pushEdge(std::span<const glm::vec2> polygon, uint32_t first, uint32_t last)
+{
+    if (last - first < 2U)
+    {
+        return;
+    }
+
+    const glm::vec2& a = polygon[first];
+    const glm::vec2& b = polygon[last % polygon.size()];
+    Edge edge{-1.0F, first, last, first + 1U};
+    for (uint32_t i = first + 1U; i < last; ++i)
+    {
+        const float deviation = segmentDistance(a, b, polygon[i]);
+        if (deviation > edge.deviation)
+        {
+            edge.deviation = deviation;
+            edge.farthest = i;
+        }
+    }
+    m_heap.push_back(edge);
+    std::push_heap(m_heap.begin(), m_heap.end(), lessDeviation);
+}
+
+} // namespace mapping
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace mapping
+{
+
+enum class SimplificationMode
+{
+    /// Keep as few vertices as the tolerance allows.
+    DouglasPeucker,
+    /// Keep exactly `maxVertices` (or all of them), spending each one where the error is largest.
+    VertexBudget,
+};
+
+struct BoundarySimplifierSettings
+{
+    SimplificationMode mode = SimplificationMode::DouglasPeucker;
+    /// Douglas-Peucker: largest allowed distance between a dropped vertex and its edge [m].
+    float tolerance = 0.1F;
+    /// Vertex budget: vertices kept per polygon, at least kMinVertices.
+    std::size_t maxVertices = 32U;
+};
+
+/// Reduces a closed polygon, such as the free-space boundary, to a subset of its vertices before
+/// it is sent over a bandwidth-limited link. The ring is split at its first vertex and the vertex
+/// farthest from it. Both chains are refined with Douglas-Peucker, but iteratively: pending edges
+/// sit in a max-heap keyed by their farthest dropped vertex, and the worst edge is split first.
+/// Tolerance mode stops once the worst edge is within tolerance, which keeps the same vertices as
+/// the recursive algorithm. Budget mode stops once the budget is spent. Either way the top of the
+/// heap is the maximum deviation of the result. The heap and keep flags are reused across calls.
+class BoundarySimplifier
+{
+public:
+    static constexpr std::size_t kMinVertices = 3U;
+
+    explicit BoundarySimplifier(const BoundarySimplifierSettings& settings = {});
+
+    void configure(const BoundarySimplifierSettings& settings);
+    const BoundarySimplifierSettings& settings() const noexcept { return m_settings; }
+
+    /// Writes the kept vertices of `polygon` to `simplified` in their original order and returns
+    /// the largest distance from a dropped vertex to the simplified outline [m]. The first vertex
+    /// must not be repeated at the end. Polygons with kMinVertices or fewer are copied unchanged.
+    float simplify(std::span<const glm::vec2> polygon, std::vector<glm::vec2>& simplified);
+
+private:
+    struct Edge
+    {
+        float deviation = 0.0F;
+        uint32_t first = 0U;
+        /// May equal the vertex count, meaning the first vertex again.
+        uint32_t last = 0U;
+        uint32_t farthest = 0U;
+    };
+
+    static bool lessDeviation(const Edge& lhs, const Edge& rhs) noexcept;
+    void pushEdge(std::span<const glm::vec2> polygon, uint32_t first, uint32_t last);
+
+    BoundarySimplifierSettings m_settings;
+    std::vector<Edge> m_heap;
+    std::vector<uint8_t> m_keep;
+};
+
+} // namespace mapping
@@ -0,0 +1,212 @@
+#include "mapping/ContourClearance.hpp"
+#include "mapping/ContourMask.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace mapping
+{
+
+namespace
+{
+float distanceToSegment(const glm::vec2& a, const glm::vec2& b, const glm::vec2& point)
+{
+    const glm::vec2 ab = b - a;
+    const float abSquared = glm::dot(ab, ab);
+    if (abSquared < 1e-6F)
+    {
+        return glm::length(point - a);
+    }
+
+    float t = glm::dot(point - a, ab) / abSquared;
+    t = std::clamp(t, 0.0F, 1.0F);
+    const glm::vec2 projection = a + ab * t;
+    return glm::length(point - projection);
+}
+} // namespace
+
+ContourClearance::ContourClearance(float cellSize, float gridMargin)
+    : m_cellSize(std::max(cellSize, 1e-3F))
+    , m_gridMargin(std::max(gridMargin, 0.0F))
+    , m_nearBodyBand(2.0F * m_cellSize)
+    // The distance field is 1-Lipschitz, so bilinear interpolation is off by at most half a cell diagonal.
+    , m_interpolationError(m_cellSize * 0.70710678F)
+{
+}
+
+void ContourClearance::setContour(const std::vector<glm::vec2>& contour)
+{
+    m_contour = contour;
+    m_field.clear();
+    m_columns = 0U;
+    m_rows = 0U;
+    if (empty())
+    {
+        return;
+    }
+
+    m_contourMin = glm::vec2(std::numeric_limits<float>::max());
+    m_contourMax = glm::vec2(-std::numeric_limits<float>::max());
+    for (const auto& vertex : m_contour)
+    {
+        m_contourMin = glm::min(m_contourMin, vertex);
+        m_contourMax = glm::max(m_contourMax, vertex);
+    }
+
+    m_origin = m_contourMin - glm::vec2(m_gridMargin);
+    const glm::vec2 extent = (m_contourMax - m_contourMin) + glm::vec2(2.0F * m_gridMargin);
+    m_columns = static_cast<std::size_t>(std::ceil(extent.x / m_cellSize)) + 1U;
+    m_rows = static_cast<std::size_t>(std::ceil(extent.y / m_cellSize)) + 1U;
+
+    m_field.resize(m_columns * m_rows);
+    for (std::size_t row = 0; row < m_rows; ++row)
+    {
+        for (std::size_t column = 0; column < m_columns; ++column)
+        {
+            const glm::vec2 node = m_origin + glm::vec2(static_cast<float>(column), static_cast<float>(row)) * m_cellSize;
+            const float unsignedDistance = exactDistance(node);
+            m_field[row * m_columns + column] =
+                ContourMask::crossingTest(m_contour, node) ? -unsignedDistance : unsignedDistance;
+        }
+    }
+}
+
+float ContourClearance::signedDistance(const glm::vec2& point) const
+{
+    if (empty())
+    {
+        return std::numeric_limits<float>::max();
+    }
+    const float unsignedDistance = distance(point);
+    return ContourMask::crossingTest(m_contour, point) ? -unsignedDistance : unsignedDistance;
+}
+
+float ContourClearance::distance(const glm::vec2& point) const
+{
+    if (empty())
+    {
+        return std::numeric_limits<float>::max();
+    }
+
+    const float approximation = approximateDistance(point);
+    if (approximation < 0.0F || approximation < m_nearBodyBand)
+    {
+        return exactDistance(point);
+    }
+    return approximation;
+}
+
+float ContourClearance::exactDistance(const glm::vec2& point) const
+{
+    if (empty())
+    {
+        return std::numeric_limits<float>::max();
+    }
+
+    float best = std::numeric_limits<float>::max();
+    for (std::size_t idx = 0; idx < m_contour.size(); ++idx)
+    {
+        const auto& start = m_contour[idx];
+        const auto& end = m_contour[(idx + 1) % m_contour.size()];
+        best = std::min(best, distanceToSegment(start, end, point));
+    }
+    return best;
+}
+
+void ContourClearance::closestPoints(const lidar::BaseLidarSensor::PointCloud& points,
+                                     std::size_t count,
+                                     std::vector<ClearancePoint>& result)
+{
+    result.clear();
+    if (empty() || count == 0U || points.empty())
+    {
+        return;
+    }
+
+    // Pass 1: approximate distances, pruned by the contour bounds once `count` candidates exist.
+    // `result` doubles as a max-heap of the best approximations. A pruned point is farther than
+    // the heap's worst approximation plus its error, so it cannot be among the exact best.
+    const auto fartherFirst = [](const ClearancePoint& lhs, const ClearancePoint& rhs) { return lhs.distance < rhs.distance; };
+    m_approximateScratch.assign(points.size(), std::numeric_limits<float>::max());
+    for (std::size_t i = 0; i < points.size(); ++i)
+    {
+        const glm::vec2 position(points[i].x, points[i].y);
+        if (result.size() == count && boundsLowerBound(position) > result.front().distance + m_interpolationError)
+        {
+            continue;
+        }
+
+        const float approximation = distance(position);
+        m_approximateScratch[i] = approximation;
+        if (result.size() < count)
+        {
+            result.push_back({position, approximation, i});
+            std::push_heap(result.begin(), result.end(), fartherFirst);
+        }
+        else if (approximation < result.front().distance)
+        {
+            std::pop_heap(result.begin(), result.end(), fartherFirst);
+            result.back() = {position, approximation, i};
+            std::push_heap(result.begin(), result.end(), fartherFirst);
+        }
+    }
+
+    // Pass 2: every point that could still beat the current set within the interpolation error
+    // is re-ranked with its exact distance.
+    const float threshold = result.front().distance + 2.0F * m_interpolationError;
+    result.clear();
+    for (std::size_t i = 0; i < points.size(); ++i)
+    {
+        if (m_approximateScratch[i] > threshold)
+        {
+            continue;
+        }
+        const glm::vec2 position(points[i].x, points[i].y);
+        const float exact = exactDistance(position);
+        if (result.size() < count)
+        {
+            result.push_back({position, exact, i});
+            std::push_heap(result.begin(), result.end(), fartherFirst);
+        }
+        else if (exact < result.front().distance)
+        {
+            std::pop_heap(result.begin(), result.end(), fartherFirst);
+            result.back() = {position, exact, i};
+            std::push_heap(result.begin(), result.end(), fartherFirst);
+        }
+    }
+    std::sort_heap(result.begin(), result.end(), fartherFirst);
+}
+
+float ContourClearance::approximateDistance(const glm::vec2& point) const
+{
+    const glm::vec2 local = (point - m_origin) / m_cellSize;
+    if (local.x < 0.0F || local.y < 0.0F || local.x >= static_cast<float>(m_columns - 1U) ||
+        local.y >= static_cast<float>(m_rows - 1U))
+    {
+        // Outside the grid: defer to the exact distance.
+        return -1.0F;
+    }
+
+    const auto column = static_cast<std::size_t>(local.x);
+    const auto row = static_cast<std::size_t>(local.y);
+    const float fx = local.x - static_cast<float>(column);
+    const float fy = local.y - static_cast<float>(row);
+    const std::size_t base = row * m_columns + column;
+    const float d00 = std::fabs(m_field[base]);
+    const float d10 = std::fabs(m_field[base + 1U]);
+    const float d01 = std::fabs(m_field[base + m_columns]);
+    const float d11 = std::fabs(m_field[base + m_columns + 1U]);
+    const float bottom = d00 + (d10 - d00) * fx;
+    const float top = d01 + (d11 - d01) * fx;
+    return bottom + (top - bottom) * fy;
+}
+
+float ContourClearance::boundsLowerBound(const glm::vec2& point) const
+{
+    const glm::vec2 outside = glm::max(glm::max(m_contourMin - point, point - m_contourMax), glm::vec2(0.0F));
+    return glm::length(outside);
+}
+
+} // namespace mapping
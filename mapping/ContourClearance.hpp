@@ -0,0 +1,63 @@
+#pragma once
+
+#include "sensors/BaseLidarSensor.hpp"
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <vector>
+
+namespace mapping
+{
+
+/// Clearance between points and the vehicle outline. A signed distance field (negative inside)
+/// sampled on a grid around the contour is built once per contour change. Queries interpolate it
+/// bilinearly and switch to exact segment distances close to the body or outside the grid.
+class ContourClearance
+{
+public:
+    struct ClearancePoint
+    {
+        glm::vec2 position = glm::vec2(0.0F);
+        float distance = 0.0F;
+        std::size_t index = 0U;
+    };
+
+    explicit ContourClearance(float cellSize = 0.05F, float gridMargin = 3.0F);
+
+    void setContour(const std::vector<glm::vec2>& contour);
+    bool empty() const noexcept { return m_contour.size() < 2; }
+
+    /// Distance to the outline; negative inside the contour.
+    float signedDistance(const glm::vec2& point) const;
+    /// Unsigned distance to the outline, matching the exact per-edge distance up to the grid error.
+    float distance(const glm::vec2& point) const;
+    float exactDistance(const glm::vec2& point) const;
+
+    /// The `count` points closest to the outline, nearest first, with exact distances.
+    void closestPoints(const lidar::BaseLidarSensor::PointCloud& points,
+                       std::size_t count,
+                       std::vector<ClearancePoint>& result);
+
+    /// Largest difference between the interpolated and exact unsigned distance.
+    float interpolationError() const noexcept { return m_interpolationError; }
+
+private:
+    float approximateDistance(const glm::vec2& point) const;
+    float boundsLowerBound(const glm::vec2& point) const;
+
+    float m_cellSize;
+    float m_gridMargin;
+    float m_nearBodyBand;
+    float m_interpolationError;
+    std::vector<glm::vec2> m_contour;
+    glm::vec2 m_contourMin = glm::vec2(0.0F);
+    glm::vec2 m_contourMax = glm::vec2(0.0F);
+    glm::vec2 m_origin = glm::vec2(0.0F);
+    std::size_t m_columns = 0U;
+    std::size_t m_rows = 0U;
+    std::vector<float> m_field;
+    std::vector<float> m_approximateScratch;
+};
+
+} // namespace mapping
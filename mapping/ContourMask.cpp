@@ -0,0 +1,200 @@
+#include "mapping/ContourMask.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace mapping
+{
+
+namespace
+{
+constexpr float kMinCellSize = 0.02F;
+constexpr std::size_t kMaxCellsPerAxis = 256U;
+// Cells closer than this to an edge are treated as boundary cells to absorb float rounding.
+constexpr float kEdgePadding = 1e-4F;
+
+void setBit(std::vector<uint64_t>& bits, std::size_t cell)
+{
+    bits[cell >> 6U] |= uint64_t{1} << (cell & 63U);
+}
+
+// Separating-axis test between segment ab and the axis-aligned box [boxMin, boxMax].
+bool segmentTouchesBox(const glm::vec2& a, const glm::vec2& b, const glm::vec2& boxMin, const glm::vec2& boxMax)
+{
+    if (std::max(a.x, b.x) < boxMin.x || std::min(a.x, b.x) > boxMax.x || std::max(a.y, b.y) < boxMin.y ||
+        std::min(a.y, b.y) > boxMax.y)
+    {
+        return false;
+    }
+
+    const glm::vec2 direction = b - a;
+    const glm::vec2 normal(-direction.y, direction.x);
+    const glm::vec2 corners[4] = {boxMin, {boxMax.x, boxMin.y}, boxMax, {boxMin.x, boxMax.y}};
+    float minProjection = std::numeric_limits<float>::max();
+    float maxProjection = -std::numeric_limits<float>::max();
+    for (const auto& corner : corners)
+    {
+        const float projection = glm::dot(corner - a, normal);
+        minProjection = std::min(minProjection, projection);
+        maxProjection = std::max(maxProjection, projection);
+    }
+    return minProjection <= 0.0F && maxProjection >= 0.0F;
+}
+} // namespace
+
+void ContourMask::build(const std::vector<glm::vec2>& contour, const glm::vec2& center, float radius)
+{
+    m_contour = contour;
+    m_insideBits.clear();
+    m_boundaryBits.clear();
+    m_columns = 0U;
+    m_rows = 0U;
+    if (m_contour.size() < 3)
+    {
+        return;
+    }
+
+    m_center = center;
+    // Widened slightly so points on the enclosing circle still reach the exact test.
+    const float rejectRadius = radius * 1.001F + kEdgePadding;
+    m_rejectRadiusSquared = rejectRadius * rejectRadius;
+
+    glm::vec2 minCorner(std::numeric_limits<float>::max());
+    glm::vec2 maxCorner(-std::numeric_limits<float>::max());
+    for (const auto& vertex : m_contour)
+    {
+        minCorner = glm::min(minCorner, vertex);
+        maxCorner = glm::max(maxCorner, vertex);
+    }
+
+    const glm::vec2 extent = maxCorner - minCorner;
+    m_cellSize = std::max(kMinCellSize, std::max(extent.x, extent.y) / static_cast<float>(kMaxCellsPerAxis - 2U));
+    m_inverseCellSize = 1.0F / m_cellSize;
+    // One padding cell on every side keeps edges off the raster border.
+    m_origin = minCorner - glm::vec2(m_cellSize);
+    m_columns = static_cast<std::size_t>(std::ceil(extent.x * m_inverseCellSize)) + 3U;
+    m_rows = static_cast<std::size_t>(std::ceil(extent.y * m_inverseCellSize)) + 3U;
+
+    const std::size_t wordCount = (m_columns * m_rows + 63U) / 64U;
+    m_insideBits.assign(wordCount, 0U);
+    m_boundaryBits.assign(wordCount, 0U);
+
+    const glm::vec2 padding(kEdgePadding);
+    for (std::size_t i = 0, j = m_contour.size() - 1U; i < m_contour.size(); j = i++)
+    {
+        const glm::vec2& a = m_contour[j];
+        const glm::vec2& b = m_contour[i];
+        const glm::vec2 edgeMin = (glm::min(a, b) - m_origin) * m_inverseCellSize;
+        const glm::vec2 edgeMax = (glm::max(a, b) - m_origin) * m_inverseCellSize;
+        const std::size_t firstColumn = static_cast<std::size_t>(std::max(0.0F, std::floor(edgeMin.x) - 1.0F));
+        const std::size_t firstRow = static_cast<std::size_t>(std::max(0.0F, std::floor(edgeMin.y) - 1.0F));
+        const std::size_t lastColumn = std::min(m_columns - 1U, static_cast<std::size_t>(edgeMax.x) + 1U);
+        const std::size_t lastRow = std::min(m_rows - 1U, static_cast<std::size_t>(edgeMax.y) + 1U);
+
+        for (std::size_t row = firstRow; row <= lastRow; ++row)
+        {
+            for (std::size_t column = firstColumn; column <= lastColumn; ++column)
+            {
+                const glm::vec2 cellMin = m_origin + glm::vec2(static_cast<float>(column), static_cast<float>(row)) * m_cellSize;
+                if (segmentTouchesBox(a, b, cellMin - padding, cellMin + glm::vec2(m_cellSize) + padding))
+                {
+                    setBit(m_boundaryBits, row * m_columns + column);
+                }
+            }
+        }
+    }
+
+    // No edge crosses the remaining cells, so their centre decides the whole cell.
+    for (std::size_t row = 0; row < m_rows; ++row)
+    {
+        for (std::size_t column = 0; column < m_columns; ++column)
+        {
+            const std::size_t cell = row * m_columns + column;
+            if (testBit(m_boundaryBits, cell))
+            {
+                continue;
+            }
+            const glm::vec2 cellCenter =
+                m_origin + (glm::vec2(static_cast<float>(column), static_cast<float>(row)) + glm::vec2(0.5F)) * m_cellSize;
+            if (crossingTest(m_contour, cellCenter))
+            {
+                setBit(m_insideBits, cell);
+            }
+        }
+    }
+}
+
+ContourMask::Region ContourMask::region(const glm::vec2& point) const
+{
+    if (m_columns == 0U)
+    {
+        return Region::Outside;
+    }
+
+    const glm::vec2 offset = point - m_center;
+    if (glm::dot(offset, offset) > m_rejectRadiusSquared)
+    {
+        return Region::Outside;
+    }
+
+    const glm::vec2 local = (point - m_origin) * m_inverseCellSize;
+    if (local.x < 0.0F || local.y < 0.0F)
+    {
+        return Region::Outside;
+    }
+    const auto column = static_cast<std::size_t>(local.x);
+    const auto row = static_cast<std::size_t>(local.y);
+    if (column >= m_columns || row >= m_rows)
+    {
+        return Region::Outside;
+    }
+
+    const std::size_t cell = row * m_columns + column;
+    if (testBit(m_boundaryBits, cell))
+    {
+        return Region::Boundary;
+    }
+    return testBit(m_insideBits, cell) ? Region::Inside : Region::Outside;
+}
+
+bool ContourMask::contains(const glm::vec2& point) const
+{
+    switch (region(point))
+    {
+        case Region::Inside:
+            return true;
+        case Region::Boundary:
+            return crossingTest(m_contour, point);
+        default:
+            return false;
+    }
+}
+
+bool ContourMask::crossingTest(const std::vector<glm::vec2>& contour, const glm::vec2& point)
+{
+    if (contour.size() < 3)
+    {
+        return false;
+    }
+
+    bool inside = false;
+    size_t count = contour.size();
+    size_t j = count - 1;
+    for (size_t i = 0; i < count; ++i)
+    {
+        const auto& a = contour[i];
+        const auto& b = contour[j];
+        const bool intersects = ((a.y > point.y) != (b.y > point.y)) &&
+            (point.x <
+             (b.x - a.x) * (point.y - a.y) / ((b.y - a.y) != 0.0F ? (b.y - a.y) : std::numeric_limits<float>::epsilon()) + a.x);
+        if (intersects)
+        {
+            inside = !inside;
+        }
+        j = i;
+    }
+    return inside;
+}
+
+} // namespace mapping
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace mapping
+{
+
+/// Acceleration structure for point-in-contour queries. A bounding circle rejects far points;
+/// inside it a bit raster answers every cell no contour edge touches, and only boundary cells
+/// fall back to the exact crossing test, so results match the exact test everywhere.
+class ContourMask
+{
+public:
+    enum class Region : uint8_t
+    {
+        Outside = 0,
+        Inside,
+        Boundary
+    };
+
+    /// `center`/`radius` describe a circle enclosing the contour.
+    void build(const std::vector<glm::vec2>& contour, const glm::vec2& center, float radius);
+
+    bool contains(const glm::vec2& point) const;
+    /// Raster answer without the exact fallback; Boundary means the exact test is required.
+    Region region(const glm::vec2& point) const;
+
+    float cellSize() const noexcept { return m_cellSize; }
+
+    static bool crossingTest(const std::vector<glm::vec2>& contour, const glm::vec2& point);
+
+private:
+    bool testBit(const std::vector<uint64_t>& bits, std::size_t cell) const
+    {
+        return (bits[cell >> 6U] >> (cell & 63U)) & 1U;
+    }
+
+    std::vector<glm::vec2> m_contour;
+    glm::vec2 m_center = glm::vec2(0.0F);
+    float m_rejectRadiusSquared = 0.0F;
+    glm::vec2 m_origin = glm::vec2(0.0F);
+    float m_cellSize = 0.0F;
+    float m_inverseCellSize = 0.0F;
+    std::size_t m_columns = 0U;
+    std::size_t m_rows = 0U;
+    std::vector<uint64_t> m_insideBits;
+    std::vector<uint64_t> m_boundaryBits;
+};
+
+} // namespace mapping
@@ -0,0 +1,375 @@
+#include "mapping/EuclideanClustering.hpp"
+#include "mapping/SpatialHash.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+namespace mapping
+{
+
+namespace
+{
+constexpr std::size_t kMinTableCells = 1024U;
+
+// Cells that can hold points within tolerance of a cell of side tolerance / sqrt(2) lie up to two
+// cells away, minus the (+-2, +-2) corners. Per row offset 0, 1, 2 that is this many cells either
+// side; only the forward half (later rows, or later cells of the same row) is visited.
+constexpr std::array<int32_t, 3> kNeighbourReach = {2, 2, 1};
+
+uint64_t cellKey(int32_t cellX, int32_t cellY)
+{
+    return (static_cast<uint64_t>(static_cast<uint32_t>(cellX)) << 32U) | static_cast<uint32_t>(cellY);
+}
+
+int32_t cellIndex(float value, float inverseCellSize)
+{
+    return static_cast<int32_t>(floorToCell(value, inverseCellSize));
+}
+
+} // namespace
+
+std::array<glm::vec2, 4> ObstacleCluster::orientedCorners() const
+{
+    const glm::vec2 axisU(std::cos(orientation), std::sin(orientation));
+    const glm::vec2 axisV(-axisU.y, axisU.x);
+    const glm::vec2 u = axisU * orientedHalfExtents.x;
+    const glm::vec2 v = axisV * orientedHalfExtents.y;
+    return {orientedCenter - u - v, orientedCenter + u - v, orientedCenter + u + v, orientedCenter - u + v};
+}
+
+EuclideanClustering::EuclideanClustering(const EuclideanClusteringSettings& settings)
+{
+    configure(settings);
+}
+
+void EuclideanClustering::configure(const EuclideanClusteringSettings& settings)
+{
+    m_settings = settings;
+    m_settings.tolerance = std::max(settings.tolerance, 0.01F);
+    m_settings.minPoints = std::max<std::size_t>(settings.minPoints, 1U);
+    m_settings.maxPoints = std::max(settings.maxPoints, m_settings.minPoints);
+    m_cellSize = m_settings.tolerance * 0.70710678F;
+    m_inverseCellSize = 1.0F / m_cellSize;
+}
+
+void EuclideanClustering::resetTable(std::size_t expectedCells)
+{
+    std::size_t capacity = 16U;
+    while (capacity < expectedCells * 2U)
+    {
+        capacity *= 2U;
+    }
+    if (m_table.size() != capacity)
+    {
+        m_table.assign(capacity, CellEntry{});
+        m_generation = 0U;
+    }
+    if (++m_generation == 0U)
+    {
+        std::fill(m_table.begin(), m_table.end(), CellEntry{});
+        m_generation = 1U;
+    }
+}
+
+void EuclideanClustering::growTable()
+{
+    resetTable(m_table.size());
+    const std::size_t mask = m_table.size() - 1U;
+    for (std::size_t cell = 0; cell < m_cellCoordinates.size(); ++cell)
+    {
+        const uint64_t key = cellKey(m_cellCoordinates[cell].x, m_cellCoordinates[cell].y);
+        std::size_t slot = hashSlot(key, mask);
+        while (m_table[slot].generation == m_generation)
+        {
+            slot = (slot + 1U) & mask;
+        }
+        m_table[slot] = CellEntry{key, m_generation, static_cast<uint32_t>(cell)};
+    }
+}
+
+void EuclideanClustering::sortCells()
+{
+    const std::size_t cellCount = m_cellCoordinates.size();
+    m_sortedCells.resize(cellCount);
+    for (std::size_t cell = 0; cell < cellCount; ++cell)
+    {
+        // Flipping the sign bits makes unsigned order match signed (y, x) order.
+        const auto row = static_cast<uint32_t>(m_cellCoordinates[cell].y) ^ 0x80000000U;
+        const auto column = static_cast<uint32_t>(m_cellCoordinates[cell].x) ^ 0x80000000U;
+        m_sortedCells[cell] = {(static_cast<uint64_t>(row) << 32U) | column, static_cast<uint32_t>(cell)};
+    }
+    std::sort(m_sortedCells.begin(), m_sortedCells.end());
+
+    m_cellRemap.resize(cellCount);
+    m_sortedCoordinates.resize(cellCount);
+    for (std::size_t rank = 0; rank < cellCount; ++rank)
+    {
+        const uint32_t cell = m_sortedCells[rank].second;
+        m_cellRemap[cell] = static_cast<uint32_t>(rank);
+        m_sortedCoordinates[rank] = m_cellCoordinates[cell];
+    }
+    m_cellCoordinates.swap(m_sortedCoordinates);
+    for (auto& cell : m_pointCell)
+    {
+        cell = m_cellRemap[cell];
+    }
+}
+
+uint32_t EuclideanClustering::insertCell(int32_t cellX, int32_t cellY)
+{
+    const uint64_t key = cellKey(cellX, cellY);
+    const std::size_t mask = m_table.size() - 1U;
+    std::size_t slot = hashSlot(key, mask);
+    while (m_table[slot].generation == m_generation)
+    {
+        if (m_table[slot].key == key)
+        {
+            return m_table[slot].cell;
+        }
+        slot = (slot + 1U) & mask;
+    }
+    const auto cell = static_cast<uint32_t>(m_cellCoordinates.size());
+    m_table[slot] = CellEntry{key, m_generation, cell};
+    m_cellCoordinates.emplace_back(cellX, cellY);
+    return cell;
+}
+
+uint32_t EuclideanClustering::findRoot(uint32_t cell) noexcept
+{
+    while (m_parent[cell] != cell)
+    {
+        m_parent[cell] = m_parent[m_parent[cell]];
+        cell = m_parent[cell];
+    }
+    return cell;
+}
+
+void EuclideanClustering::unite(uint32_t a, uint32_t b) noexcept
+{
+    if (m_componentSize[a] < m_componentSize[b])
+    {
+        std::swap(a, b);
+    }
+    m_parent[b] = a;
+    m_componentSize[a] += m_componentSize[b];
+}
+
+bool EuclideanClustering::cellsTouch(uint32_t a,
+                                     uint32_t b,
+                                     const lidar::BaseLidarSensor::PointCloud& points) const noexcept
+{
+    const float toleranceSquared = m_settings.tolerance * m_settings.tolerance;
+    for (uint32_t i = m_cellStart[a]; i < m_cellStart[a + 1U]; ++i)
+    {
+        const auto& p = points[m_cellPoints[i]];
+        for (uint32_t j = m_cellStart[b]; j < m_cellStart[b + 1U]; ++j)
+        {
+            const auto& q = points[m_cellPoints[j]];
+            const float dx = p.x - q.x;
+            const float dy = p.y - q.y;
+            if (dx * dx + dy * dy < toleranceSquared)
+            {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+void EuclideanClustering::cluster(const lidar::BaseLidarSensor::PointCloud& points)
+{
+    const std::size_t count = points.size();
+    m_clusters.clear();
+    m_labels.assign(count, kNoCluster);
+    if (count == 0U)
+    {
+        return;
+    }
+
+    // Occupied cells are far fewer than points, so the table is sized from the last frame's cell
+    // count and grows on demand; a small table stays in cache.
+    resetTable(std::max<std::size_t>(m_cellCoordinates.size(), kMinTableCells));
+    m_cellCoordinates.clear();
+    m_pointCell.resize(count);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        if (m_cellCoordinates.size() * 2U >= m_table.size())
+        {
+            growTable();
+        }
+        m_pointCell[i] =
+            insertCell(cellIndex(points[i].x, m_inverseCellSize), cellIndex(points[i].y, m_inverseCellSize));
+    }
+
+    sortCells();
+
+    // Counting sort of point indices by cell.
+    const std::size_t cellCount = m_cellCoordinates.size();
+    m_cellStart.assign(cellCount + 1U, 0U);
+    for (const uint32_t cell : m_pointCell)
+    {
+        ++m_cellStart[cell + 1U];
+    }
+    std::partial_sum(m_cellStart.begin(), m_cellStart.end(), m_cellStart.begin());
+    m_cellPoints.resize(count);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        m_cellPoints[m_cellStart[m_pointCell[i]]++] = static_cast<uint32_t>(i);
+    }
+    // The fill advanced every start to the next cell's start; shift them back.
+    for (std::size_t cell = cellCount; cell > 0U; --cell)
+    {
+        m_cellStart[cell] = m_cellStart[cell - 1U];
+    }
+    m_cellStart[0] = 0U;
+
+    m_parent.resize(cellCount);
+    std::iota(m_parent.begin(), m_parent.end(), 0U);
+    m_componentSize.resize(cellCount);
+    for (std::size_t cell = 0; cell < cellCount; ++cell)
+    {
+        m_componentSize[cell] = m_cellStart[cell + 1U] - m_cellStart[cell];
+    }
+
+    // Cells are in row-major order, so each neighbour row is a contiguous run reached by a
+    // cursor that only moves forward.
+    const auto link = [&](uint32_t cell, uint32_t neighbour) {
+        const uint32_t rootA = findRoot(cell);
+        const uint32_t rootB = findRoot(neighbour);
+        if (rootA != rootB && cellsTouch(cell, neighbour, points))
+        {
+            unite(rootA, rootB);
+        }
+    };
+    const auto before = [this](uint32_t cell, int32_t cellX, int32_t cellY) {
+        const glm::ivec2 coordinates = m_cellCoordinates[cell];
+        return coordinates.y < cellY || (coordinates.y == cellY && coordinates.x < cellX);
+    };
+    std::array<uint32_t, 2> rowCursor{0U, 0U};
+    for (uint32_t cell = 0; cell < cellCount; ++cell)
+    {
+        const glm::ivec2 coordinates = m_cellCoordinates[cell];
+        for (uint32_t row = 0; row < 3U; ++row)
+        {
+            const int32_t cellY = coordinates.y + static_cast<int32_t>(row);
+            const int32_t reach = kNeighbourReach[row];
+            uint32_t neighbour = cell + 1U;
+            if (row > 0U)
+            {
+                uint32_t& cursor = rowCursor[row - 1U];
+                while (cursor < cellCount && before(cursor, coordinates.x - reach, cellY))
+                {
+                    ++cursor;
+                }
+                neighbour = cursor;
+            }
+            for (; neighbour < cellCount && m_cellCoordinates[neighbour].y == cellY
+                   && m_cellCoordinates[neighbour].x <= coordinates.x + reach;
+                 ++neighbour)
+            {
+                link(cell, neighbour);
+            }
+        }
+    }
+
+    buildClusters(points);
+}
+
+void EuclideanClustering::buildClusters(const lidar::BaseLidarSensor::PointCloud& points)
+{
+    const std::size_t cellCount = m_cellCoordinates.size();
+    m_cellCluster.assign(cellCount, kNoCluster);
+    for (uint32_t cell = 0; cell < cellCount; ++cell)
+    {
+        const uint32_t root = findRoot(cell);
+        const std::size_t size = m_componentSize[root];
+        if (root == cell && size >= m_settings.minPoints && size <= m_settings.maxPoints)
+        {
+            m_cellCluster[root] = static_cast<int32_t>(m_clusters.size());
+            ObstacleCluster cluster;
+            cluster.boundsMin = glm::vec2(std::numeric_limits<float>::max());
+            cluster.boundsMax = glm::vec2(std::numeric_limits<float>::lowest());
+            cluster.minZ = std::numeric_limits<float>::max();
+            cluster.maxZ = std::numeric_limits<float>::lowest();
+            m_clusters.push_back(cluster);
+        }
+    }
+    // Resolve every cell to its cluster once, so the point passes below are plain lookups.
+    for (uint32_t cell = 0; cell < cellCount; ++cell)
+    {
+        m_cellCluster[cell] = m_cellCluster[findRoot(cell)];
+    }
+    m_moments.assign(m_clusters.size(), Moments{});
+
+    for (std::size_t i = 0; i < points.size(); ++i)
+    {
+        const int32_t label = m_cellCluster[m_pointCell[i]];
+        m_labels[i] = label;
+        if (label == kNoCluster)
+        {
+            continue;
+        }
+        const auto& point = points[i];
+        ObstacleCluster& cluster = m_clusters[static_cast<std::size_t>(label)];
+        ++cluster.pointCount;
+        cluster.boundsMin = glm::min(cluster.boundsMin, glm::vec2(point.x, point.y));
+        cluster.boundsMax = glm::max(cluster.boundsMax, glm::vec2(point.x, point.y));
+        cluster.minZ = std::min(cluster.minZ, point.z);
+        cluster.maxZ = std::max(cluster.maxZ, point.z);
+        Moments& moments = m_moments[static_cast<std::size_t>(label)];
+        moments.sumX += point.x;
+        moments.sumY += point.y;
+        moments.sumXX += static_cast<double>(point.x) * point.x;
+        moments.sumXY += static_cast<double>(point.x) * point.y;
+        moments.sumYY += static_cast<double>(point.y) * point.y;
+    }
+
+    // Principal axis from the 2D covariance, then one more pass for the extents along it.
+    for (std::size_t index = 0; index < m_clusters.size(); ++index)
+    {
+        ObstacleCluster& cluster = m_clusters[index];
+        const Moments& moments = m_moments[index];
+        const double inverseCount = 1.0 / static_cast<double>(cluster.pointCount);
+        const double meanX = moments.sumX * inverseCount;
+        const double meanY = moments.sumY * inverseCount;
+        const double covXX = moments.sumXX * inverseCount - meanX * meanX;
+        const double covXY = moments.sumXY * inverseCount - meanX * meanY;
+        const double covYY = moments.sumYY * inverseCount - meanY * meanY;
+        cluster.centroid = glm::vec2(static_cast<float>(meanX), static_cast<float>(meanY));
+        cluster.orientation = static_cast<float>(0.5 * std::atan2(2.0 * covXY, covXX - covYY));
+    }
+    m_orientedExtents.resize(m_clusters.size());
+    for (std::size_t index = 0; index < m_clusters.size(); ++index)
+    {
+        const float orientation = m_clusters[index].orientation;
+        m_orientedExtents[index] = Extent{};
+        m_orientedExtents[index].axis = glm::vec2(std::cos(orientation), std::sin(orientation));
+    }
+    for (std::size_t i = 0; i < points.size(); ++i)
+    {
+        if (m_labels[i] == kNoCluster)
+        {
+            continue;
+        }
+        const auto index = static_cast<std::size_t>(m_labels[i]);
+        Extent& extent = m_orientedExtents[index];
+        const glm::vec2 offset = glm::vec2(points[i].x, points[i].y) - m_clusters[index].centroid;
+        const glm::vec2 local(extent.axis.x * offset.x + extent.axis.y * offset.y,
+                              extent.axis.x * offset.y - extent.axis.y * offset.x);
+        extent.min = glm::min(extent.min, local);
+        extent.max = glm::max(extent.max, local);
+    }
+    for (std::size_t index = 0; index < m_clusters.size(); ++index)
+    {
+        ObstacleCluster& cluster = m_clusters[index];
+        const Extent& extent = m_orientedExtents[index];
+        const glm::vec2 localCenter = (extent.min + extent.max) * 0.5F;
+        cluster.orientedCenter = cluster.centroid
+                                 + glm::vec2(extent.axis.x * localCenter.x - extent.axis.y * localCenter.y,
+                                             extent.axis.y * localCenter.x + extent.axis.x * localCenter.y);
+        cluster.orientedHalfExtents = (extent.max - extent.min) * 0.5F;
+    }
+}
+
+} // namespace mapping
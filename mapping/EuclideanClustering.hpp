@@ -0,0 +1,125 @@
+#pragma once
+
+#include "sensors/BaseLidarSensor.hpp"
+
+#include <glm/glm.hpp>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace mapping
+{
+
+struct EuclideanClusteringSettings
+{
+    /// Points closer than this in the ground plane belong to the same cluster [m].
+    float tolerance = 0.5F;
+    std::size_t minPoints = 5U;
+    std::size_t maxPoints = std::numeric_limits<std::size_t>::max();
+};
+
+struct ObstacleCluster
+{
+    std::size_t pointCount = 0U;
+    glm::vec2 centroid = glm::vec2(0.0F);
+    glm::vec2 boundsMin = glm::vec2(0.0F);
+    glm::vec2 boundsMax = glm::vec2(0.0F);
+    /// Oriented box along the principal axis of the points.
+    glm::vec2 orientedCenter = glm::vec2(0.0F);
+    glm::vec2 orientedHalfExtents = glm::vec2(0.0F);
+    /// Angle of the box's first axis from +x [rad].
+    float orientation = 0.0F;
+    float minZ = 0.0F;
+    float maxZ = 0.0F;
+
+    std::array<glm::vec2, 4> orientedCorners() const;
+};
+
+/// Groups points whose ground-plane distance is below the tolerance. Points are bucketed into
+/// square cells of side tolerance / sqrt(2), so every pair inside one cell is already connected
+/// and union-find runs over cells rather than points. Points find their cell through a flat hash
+/// of cell coordinates. The cells are then sorted row-major and swept once. Neighbouring cells are
+/// joined on the first point pair found within tolerance, and pairs already in one component are
+/// skipped. All buffers are reused across frames.
+class EuclideanClustering
+{
+public:
+    static constexpr int32_t kNoCluster = -1;
+
+    explicit EuclideanClustering(const EuclideanClusteringSettings& settings = {});
+
+    void configure(const EuclideanClusteringSettings& settings);
+    const EuclideanClusteringSettings& settings() const noexcept { return m_settings; }
+
+    /// Clusters `points` and replaces clusters() and labels().
+    void cluster(const lidar::BaseLidarSensor::PointCloud& points);
+
+    const std::vector<ObstacleCluster>& clusters() const noexcept { return m_clusters; }
+    /// Cluster index per input point, or kNoCluster when its component was too small or too large.
+    const std::vector<int32_t>& labels() const noexcept { return m_labels; }
+
+private:
+    struct CellEntry
+    {
+        uint64_t key = 0U;
+        uint32_t generation = 0U;
+        uint32_t cell = 0U;
+    };
+
+    struct Extent
+    {
+        glm::vec2 axis = glm::vec2(1.0F, 0.0F);
+        glm::vec2 min = glm::vec2(std::numeric_limits<float>::max());
+        glm::vec2 max = glm::vec2(std::numeric_limits<float>::lowest());
+    };
+
+    struct Moments
+    {
+        double sumX = 0.0;
+        double sumY = 0.0;
+        double sumXX = 0.0;
+        double sumXY = 0.0;
+        double sumYY = 0.0;
+    };
+
+    void resetTable(std::size_t expectedCells);
+    void growTable();
+    void sortCells();
+    uint32_t insertCell(int32_t cellX, int32_t cellY);
+    uint32_t findRoot(uint32_t cell) noexcept;
+    void unite(uint32_t a, uint32_t b) noexcept;
+    bool cellsTouch(uint32_t a, uint32_t b, const lidar::BaseLidarSensor::PointCloud& points) const noexcept;
+    void buildClusters(const lidar::BaseLidarSensor::PointCloud& points);
+
+    EuclideanClusteringSettings m_settings;
+    float m_cellSize = 0.0F;
+    float m_inverseCellSize = 0.0F;
+
+    // Cell hash, reset by generation stamps rather than clearing.
+    std::vector<CellEntry> m_table;
+    uint32_t m_generation = 0U;
+    std::vector<glm::ivec2> m_cellCoordinates;
+    std::vector<uint32_t> m_pointCell;
+    // Row-major cell order, so neighbour rows can be swept instead of looked up.
+    std::vector<std::pair<uint64_t, uint32_t>> m_sortedCells;
+    std::vector<uint32_t> m_cellRemap;
+    std::vector<glm::ivec2> m_sortedCoordinates;
+    // Points grouped by cell (CSR).
+    std::vector<uint32_t> m_cellStart;
+    std::vector<uint32_t> m_cellPoints;
+    // Union-find over cells.
+    std::vector<uint32_t> m_parent;
+    std::vector<uint32_t> m_componentSize;
+    std::vector<int32_t> m_cellCluster;
+    std::vector<Moments> m_moments;
+    std::vector<Extent> m_orientedExtents;
+
+    std::vector<ObstacleCluster> m_clusters;
+    std::vector<int32_t> m_labels;
+};
+
+} // namespace mapping
@@ -0,0 +1,173 @@
+#include "mapping/FreeSpaceAccumulator.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <limits>
+
+namespace mapping
+{
+
+glm::vec2 PlanarMotion::apply(const glm::vec2& point) const noexcept
+{
+    const float c = std::cos(yaw);
+    const float s = std::sin(yaw);
+    return glm::vec2(c * point.x - s * point.y, s * point.x + c * point.y) + translation;
+}
+
+void FreeSpaceAccumulator::configure(const FreeSpaceAccumulatorSettings& settings)
+{
+    m_settings = settings;
+    m_settings.windowFrames = std::clamp<std::size_t>(settings.windowFrames, 1U, kMaxWindowFrames);
+    m_settings.decay = std::clamp(settings.decay, 0.0F, 1.0F);
+    m_settings.holdThreshold = std::clamp(settings.holdThreshold, 0.0F, 1.0F);
+    reset(m_sensorCount);
+}
+
+void FreeSpaceAccumulator::reset(std::size_t sensorCount)
+{
+    m_sensorCount = sensorCount;
+    m_framesSeen = 0U;
+    m_head = 0U;
+    m_hitHistory.assign(sensorCount, 0U);
+    m_confidence.assign(sensorCount, 0.0F);
+
+    const std::size_t ringSize =
+        m_settings.filter == FreeSpaceFilter::MinimumOfFrames ? sensorCount * m_settings.windowFrames : 0U;
+    m_ringDistanceSquared.assign(ringSize, std::numeric_limits<float>::max());
+    m_ringPosition.assign(ringSize, glm::vec2(0.0F));
+
+    const std::size_t heldSize = m_settings.filter == FreeSpaceFilter::ExponentialDecay ? sensorCount : 0U;
+    m_heldDistanceSquared.assign(heldSize, std::numeric_limits<float>::max());
+    m_heldPosition.assign(heldSize, glm::vec2(0.0F));
+    m_heldWeight.assign(heldSize, 0.0F);
+}
+
+void FreeSpaceAccumulator::update(std::span<uint8_t> valid,
+                                  std::span<float> distanceSquared,
+                                  std::span<glm::vec2> position)
+{
+    if (valid.size() != m_sensorCount)
+    {
+        reset(valid.size());
+    }
+
+    const std::size_t window = m_settings.windowFrames;
+    const uint32_t windowMask = window >= 32U ? ~0U : ((1U << window) - 1U);
+    m_framesSeen = std::min(m_framesSeen + 1U, window);
+    const float inverseFrames = 1.0F / static_cast<float>(m_framesSeen);
+    for (std::size_t i = 0; i < m_sensorCount; ++i)
+    {
+        m_hitHistory[i] = ((m_hitHistory[i] << 1U) | (valid[i] != 0U ? 1U : 0U)) & windowMask;
+        m_confidence[i] = static_cast<float>(std::popcount(m_hitHistory[i])) * inverseFrames;
+    }
+
+    switch (m_settings.filter)
+    {
+    case FreeSpaceFilter::ExponentialDecay:
+        applyDecay(valid, distanceSquared, position);
+        break;
+    case FreeSpaceFilter::MinimumOfFrames:
+        applyMinimum(valid, distanceSquared, position);
+        break;
+    case FreeSpaceFilter::None:
+        break;
+    }
+}
+
+void FreeSpaceAccumulator::compensateMotion(const PlanarMotion& motion, const RekeyFunction& rekey)
+{
+    for (std::size_t i = 0; i < m_heldWeight.size(); ++i)
+    {
+        if (m_heldWeight[i] <= 0.0F)
+        {
+            continue;
+        }
+        m_heldPosition[i] = motion.apply(m_heldPosition[i]);
+        if (!rekey(i, m_heldPosition[i], m_heldDistanceSquared[i]))
+        {
+            m_heldWeight[i] = 0.0F;
+            m_heldDistanceSquared[i] = std::numeric_limits<float>::max();
+        }
+    }
+
+    // Ring slots are frame-major, so the sensor index is the slot index modulo the sensor count.
+    for (std::size_t slot = 0; slot < m_ringDistanceSquared.size(); ++slot)
+    {
+        if (m_ringDistanceSquared[slot] == std::numeric_limits<float>::max())
+        {
+            continue;
+        }
+        m_ringPosition[slot] = motion.apply(m_ringPosition[slot]);
+        if (!rekey(slot % m_sensorCount, m_ringPosition[slot], m_ringDistanceSquared[slot]))
+        {
+            m_ringDistanceSquared[slot] = std::numeric_limits<float>::max();
+        }
+    }
+}
+
+void FreeSpaceAccumulator::applyDecay(std::span<uint8_t> valid,
+                                      std::span<float> distanceSquared,
+                                      std::span<glm::vec2> position)
+{
+    const float decay = m_settings.decay;
+    const float threshold = m_settings.holdThreshold;
+    for (std::size_t i = 0; i < m_sensorCount; ++i)
+    {
+        float weight = m_heldWeight[i] * decay;
+        const bool replace = valid[i] != 0U && (distanceSquared[i] <= m_heldDistanceSquared[i] || weight < threshold);
+        if (replace)
+        {
+            m_heldDistanceSquared[i] = distanceSquared[i];
+            m_heldPosition[i] = position[i];
+            weight = 1.0F;
+        }
+        m_heldWeight[i] = weight;
+
+        const bool held = weight >= threshold && weight > 0.0F;
+        valid[i] = held ? 1U : 0U;
+        distanceSquared[i] = held ? m_heldDistanceSquared[i] : std::numeric_limits<float>::max();
+        position[i] = held ? m_heldPosition[i] : glm::vec2(0.0F);
+    }
+}
+
+void FreeSpaceAccumulator::applyMinimum(std::span<uint8_t> valid,
+                                        std::span<float> distanceSquared,
+                                        std::span<glm::vec2> position)
+{
+    const std::size_t window = m_settings.windowFrames;
+    float* slotDistance = m_ringDistanceSquared.data() + m_head * m_sensorCount;
+    glm::vec2* slotPosition = m_ringPosition.data() + m_head * m_sensorCount;
+    for (std::size_t i = 0; i < m_sensorCount; ++i)
+    {
+        slotDistance[i] = valid[i] != 0U ? distanceSquared[i] : std::numeric_limits<float>::max();
+        slotPosition[i] = position[i];
+    }
+    m_head = (m_head + 1U) % window;
+
+    // Frame-major ring: the inner loop walks one contiguous frame at a time.
+    std::fill(distanceSquared.begin(), distanceSquared.end(), std::numeric_limits<float>::max());
+    for (std::size_t frame = 0; frame < window; ++frame)
+    {
+        const float* frameDistance = m_ringDistanceSquared.data() + frame * m_sensorCount;
+        const glm::vec2* framePosition = m_ringPosition.data() + frame * m_sensorCount;
+        for (std::size_t i = 0; i < m_sensorCount; ++i)
+        {
+            if (frameDistance[i] < distanceSquared[i])
+            {
+                distanceSquared[i] = frameDistance[i];
+                position[i] = framePosition[i];
+            }
+        }
+    }
+    for (std::size_t i = 0; i < m_sensorCount; ++i)
+    {
+        valid[i] = distanceSquared[i] < std::numeric_limits<float>::max() ? 1U : 0U;
+        if (valid[i] == 0U)
+        {
+            position[i] = glm::vec2(0.0F);
+        }
+    }
+}
+
+} // namespace mapping
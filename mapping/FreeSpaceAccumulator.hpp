@@ -0,0 +1,89 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <vector>
+
+namespace mapping
+{
+
+enum class FreeSpaceFilter
+{
+    /// Report the latest frame unchanged.
+    None,
+    /// Hold the nearest obstacle while its weight, multiplied by `decay` every frame, stays above
+    /// `holdThreshold`; nearer hits replace it immediately.
+    ExponentialDecay,
+    /// Nearest obstacle over the last `windowFrames` frames.
+    MinimumOfFrames,
+};
+
+struct FreeSpaceAccumulatorSettings
+{
+    FreeSpaceFilter filter = FreeSpaceFilter::None;
+    /// Frames kept for MinimumOfFrames and for the hit-count confidence.
+    std::size_t windowFrames = 5U;
+    float decay = 0.7F;
+    float holdThreshold = 0.2F;
+};
+
+/// Rigid motion in the ground plane, mapping p to R(yaw) * p + translation.
+struct PlanarMotion
+{
+    float yaw = 0.0F;
+    glm::vec2 translation = glm::vec2(0.0F);
+
+    glm::vec2 apply(const glm::vec2& point) const noexcept;
+};
+
+/// Multi-frame filter over the per-sensor nearest samples. History is a ring of per-sensor
+/// arrays rather than past clouds, so a frame costs O(sensors * windowFrames) with a small
+/// constant window.
+class FreeSpaceAccumulator
+{
+public:
+    static constexpr std::size_t kMaxWindowFrames = 32U;
+
+    void configure(const FreeSpaceAccumulatorSettings& settings);
+    const FreeSpaceAccumulatorSettings& settings() const noexcept { return m_settings; }
+
+    /// Drops all history and sizes the arrays for `sensorCount` sensors.
+    void reset(std::size_t sensorCount);
+
+    /// Folds the latest frame into the history and overwrites the arrays with the filtered result.
+    void update(std::span<uint8_t> valid, std::span<float> distanceSquared, std::span<glm::vec2> position);
+
+    /// Sensor index, a held position in the current frame, and its distance to refresh. Returns
+    /// false once the position has left that sensor.
+    using RekeyFunction = std::function<bool(std::size_t, const glm::vec2&, float&)>;
+    /// Moves the held history into the current vehicle frame after the vehicle moved; `motion`
+    /// maps previous-frame positions to current ones. Samples `rekey` rejects are dropped.
+    void compensateMotion(const PlanarMotion& motion, const RekeyFunction& rekey);
+
+    /// Fraction of the last `windowFrames` frames in which each sensor saw a return.
+    std::span<const float> confidence() const noexcept { return m_confidence; }
+
+private:
+    void applyDecay(std::span<uint8_t> valid, std::span<float> distanceSquared, std::span<glm::vec2> position);
+    void applyMinimum(std::span<uint8_t> valid, std::span<float> distanceSquared, std::span<glm::vec2> position);
+
+    FreeSpaceAccumulatorSettings m_settings;
+    std::size_t m_sensorCount = 0U;
+    std::size_t m_framesSeen = 0U;
+    std::size_t m_head = 0U;
+    std::vector<uint32_t> m_hitHistory;
+    std::vector<float> m_confidence;
+    // MinimumOfFrames ring, frame-major: [frame][sensor].
+    std::vector<float> m_ringDistanceSquared;
+    std::vector<glm::vec2> m_ringPosition;
+    // ExponentialDecay state.
+    std::vector<float> m_heldDistanceSquared;
+    std::vector<glm::vec2> m_heldPosition;
+    std::vector<float> m_heldWeight;
+};
+
+} // namespace mapping
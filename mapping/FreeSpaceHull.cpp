@@ -0,0 +1,456 @@
+#include "mapping/FreeSpaceHull.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+namespace mapping
+{
+
+namespace
+{
+constexpr uint32_t kNoIndex = 0xFFFFFFFFU;
+// Points this close to a hull edge, relative to its length, lie on it.
+constexpr float kCollinearTolerance = 1e-4F;
+
+float cross(const glm::vec2& origin, const glm::vec2& a, const glm::vec2& b) noexcept
+{
+    return (a.x - origin.x) * (b.y - origin.y) - (a.y - origin.y) * (b.x - origin.x);
+}
+
+bool withinBounds(const glm::vec2& a, const glm::vec2& b, const glm::vec2& point) noexcept
+{
+    return point.x >= std::min(a.x, b.x) && point.x <= std::max(a.x, b.x) && point.y >= std::min(a.y, b.y)
+           && point.y <= std::max(a.y, b.y);
+}
+
+// True when the segments share any point, including touching and collinear overlap.
+bool segmentsIntersect(const glm::vec2& p1, const glm::vec2& p2, const glm::vec2& q1, const glm::vec2& q2) noexcept
+{
+    const float d1 = cross(q1, q2, p1);
+    const float d2 = cross(q1, q2, p2);
+    const float d3 = cross(p1, p2, q1);
+    const float d4 = cross(p1, p2, q2);
+    if (((d1 > 0.0F && d2 < 0.0F) || (d1 < 0.0F && d2 > 0.0F)) && ((d3 > 0.0F && d4 < 0.0F) || (d3 < 0.0F && d4 > 0.0F)))
+    {
+        return true;
+    }
+    return (d1 == 0.0F && withinBounds(q1, q2, p1)) || (d2 == 0.0F && withinBounds(q1, q2, p2))
+           || (d3 == 0.0F && withinBounds(p1, p2, q1)) || (d4 == 0.0F && withinBounds(p1, p2, q2));
+}
+
+// Proper crossing only; touching or collinear segments do not count.
+bool segmentsCross(const glm::vec2& p1, const glm::vec2& p2, const glm::vec2& q1, const glm::vec2& q2) noexcept
+{
+    const float d1 = cross(q1, q2, p1);
+    const float d2 = cross(q1, q2, p2);
+    const float d3 = cross(p1, p2, q1);
+    const float d4 = cross(p1, p2, q2);
+    return ((d1 > 0.0F && d2 < 0.0F) || (d1 < 0.0F && d2 > 0.0F)) && ((d3 > 0.0F && d4 < 0.0F) || (d3 < 0.0F && d4 > 0.0F));
+}
+} // namespace
+
+std::size_t binOrderedOutline(std::span<const uint8_t> valid,
+                              std::span<const glm::vec2> positions,
+                              const glm::vec2& center,
+                              std::vector<glm::vec2>& outline)
+{
+    outline.clear();
+    const std::size_t bins = std::min(valid.size(), positions.size());
+    for (std::size_t i = 0; i < bins; ++i)
+    {
+        if (valid[i] != 0U)
+        {
+            outline.push_back(positions[i]);
+        }
+    }
+    const std::size_t count = outline.size();
+    if (count < 4U)
+    {
+        return 0U;
+    }
+
+    // The turns between consecutive vertices around `center` add up to one revolution, so at most
+    // one exceeds pi, and exactly that one has a negative cross product. Without it the outline is
+    // star-shaped from `center` and cannot cross itself.
+    std::size_t gap = count;
+    for (std::size_t i = 0; i < count && gap == count; ++i)
+    {
+        if (cross(center, outline[i], outline[(i + 1U) % count]) < 0.0F)
+        {
+            gap = i;
+        }
+    }
+    if (gap == count)
+    {
+        return 0U;
+    }
+
+    // The other edges sweep less than pi between them, each over its own angles, so they cannot
+    // cross one another; only the gap edge can cross them.
+    const glm::vec2 gapStart = outline[gap];
+    const glm::vec2 gapEnd = outline[(gap + 1U) % count];
+    bool crossed = false;
+    for (std::size_t j = 0; j < count && !crossed; ++j)
+    {
+        const std::size_t next = (j + 1U) % count;
+        if (j != gap && next != gap && j != (gap + 1U) % count)
+        {
+            crossed = segmentsCross(gapStart, gapEnd, outline[j], outline[next]);
+        }
+    }
+
+    // Every move strictly shortens the outline, so this ends; the bound, one move per vertex,
+    // guards against rounding making a move undo an earlier one.
+    const std::size_t maxRepairs = count;
+    std::size_t repairs = 0U;
+    while (crossed && repairs < maxRepairs)
+    {
+        crossed = false;
+        for (std::size_t i = 0; i + 2U < count && repairs < maxRepairs; ++i)
+        {
+            // Edges i -> i+1 and j -> j+1; the last edge closes the ring and touches edge 0.
+            const std::size_t lastJ = i == 0U ? count - 1U : count;
+            for (std::size_t j = i + 2U; j < lastJ; ++j)
+            {
+                if (segmentsCross(outline[i], outline[i + 1U], outline[j], outline[(j + 1U) % count]))
+                {
+                    std::reverse(outline.begin() + static_cast<std::ptrdiff_t>(i + 1U),
+                                 outline.begin() + static_cast<std::ptrdiff_t>(j + 1U));
+                    ++repairs;
+                    crossed = true;
+                    break;
+                }
+            }
+        }
+    }
+    return repairs;
+}
+
+FreeSpaceHull::FreeSpaceHull(const FreeSpaceHullSettings& settings)
+{
+    configure(settings);
+}
+
+void FreeSpaceHull::configure(const FreeSpaceHullSettings& settings)
+{
+    m_settings = settings;
+    m_settings.lengthThreshold = std::max(settings.lengthThreshold, 0.0F);
+    m_settings.concavity = std::max(settings.concavity, 1.0F);
+    m_dirty = true;
+}
+
+void FreeSpaceHull::build(std::span<const glm::vec2> points)
+{
+    m_positions.assign(points.begin(), points.end());
+    m_valid.assign(points.size(), 1U);
+    m_order.resize(points.size());
+    std::iota(m_order.begin(), m_order.end(), 0U);
+    sortOrder();
+    buildConvex();
+    buildConcave();
+    m_changedInputs = points.size();
+    m_rebuilt = true;
+    m_dirty = false;
+}
+
+void FreeSpaceHull::update(std::span<const uint8_t> valid, std::span<const glm::vec2> positions)
+{
+    const std::size_t count = std::min(valid.size(), positions.size());
+    m_rebuilt = true;
+    if (m_dirty || count != m_positions.size())
+    {
+        m_positions.assign(positions.begin(), positions.begin() + static_cast<std::ptrdiff_t>(count));
+        m_valid.assign(valid.begin(), valid.begin() + static_cast<std::ptrdiff_t>(count));
+        m_order.clear();
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            if (m_valid[i] != 0U)
+            {
+                m_order.push_back(static_cast<uint32_t>(i));
+            }
+        }
+        sortOrder();
+        buildConvex();
+        buildConcave();
+        m_changedInputs = count;
+        m_dirty = false;
+        return;
+    }
+
+    std::size_t changed = 0U;
+    bool keepConvex = m_convex.size() >= 3U;
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        const bool isValid = valid[i] != 0U;
+        const bool wasValid = m_valid[i] != 0U;
+        if (isValid == wasValid && (!isValid || positions[i] == m_positions[i]))
+        {
+            continue;
+        }
+        ++changed;
+        // Moving or dropping a hull vertex, or adding a point on or outside the hull, changes it.
+        if ((wasValid && m_onConvex[i] != 0U) || (isValid && keepConvex && !insideConvex(positions[i])))
+        {
+            keepConvex = false;
+        }
+        if (isValid && !wasValid)
+        {
+            m_order.push_back(static_cast<uint32_t>(i));
+        }
+        m_valid[i] = isValid ? 1U : 0U;
+        m_positions[i] = positions[i];
+    }
+
+    m_changedInputs = changed;
+    if (changed == 0U)
+    {
+        m_rebuilt = false;
+        return;
+    }
+
+    repairOrder();
+    if (!keepConvex)
+    {
+        buildConvex();
+    }
+    else if (m_settings.shape == HullShape::Convex)
+    {
+        m_rebuilt = false;
+        return;
+    }
+    buildConcave();
+}
+
+bool FreeSpaceHull::precedes(uint32_t lhs, uint32_t rhs) const noexcept
+{
+    const glm::vec2& a = m_positions[lhs];
+    const glm::vec2& b = m_positions[rhs];
+    if (a.x != b.x)
+    {
+        return a.x < b.x;
+    }
+    if (a.y != b.y)
+    {
+        return a.y < b.y;
+    }
+    return lhs < rhs;
+}
+
+bool FreeSpaceHull::insideConvex(const glm::vec2& point) const noexcept
+{
+    const std::size_t count = m_convex.size();
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        if (cross(m_convex[i], m_convex[(i + 1U) % count], point) <= 0.0F)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+void FreeSpaceHull::sortOrder()
+{
+    std::sort(m_order.begin(), m_order.end(), [this](uint32_t lhs, uint32_t rhs) { return precedes(lhs, rhs); });
+}
+
+void FreeSpaceHull::repairOrder()
+{
+    m_order.erase(std::remove_if(m_order.begin(), m_order.end(), [this](uint32_t index) { return m_valid[index] == 0U; }),
+                  m_order.end());
+    // Insertion sort: linear in the number of entries plus how far the changed ones have to move.
+    for (std::size_t i = 1; i < m_order.size(); ++i)
+    {
+        const uint32_t index = m_order[i];
+        std::size_t slot = i;
+        while (slot > 0U && precedes(index, m_order[slot - 1U]))
+        {
+            m_order[slot] = m_order[slot - 1U];
+            --slot;
+        }
+        m_order[slot] = index;
+    }
+}
+
+void FreeSpaceHull::buildConvex()
+{
+    const std::size_t count = m_order.size();
+    m_onConvex.assign(m_positions.size(), 0U);
+    m_convexIndices.resize(2U * count);
+
+    // Andrew's monotone chain: lower hull left to right, then upper hull right to left. Collinear
+    // and repeated points are dropped.
+    std::size_t size = 0U;
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        const glm::vec2& point = m_positions[m_order[i]];
+        while (size >= 2U
+               && cross(m_positions[m_convexIndices[size - 2U]], m_positions[m_convexIndices[size - 1U]], point) <= 0.0F)
+        {
+            --size;
+        }
+        m_convexIndices[size++] = m_order[i];
+    }
+    const std::size_t lowerSize = size + 1U;
+    for (std::size_t i = count; i-- > 1U;)
+    {
+        const glm::vec2& point = m_positions[m_order[i - 1U]];
+        while (size >= lowerSize
+               && cross(m_positions[m_convexIndices[size - 2U]], m_positions[m_convexIndices[size - 1U]], point) <= 0.0F)
+        {
+            --size;
+        }
+        m_convexIndices[size++] = m_order[i - 1U];
+    }
+    // The upper chain ends on the first point again.
+    m_convexIndices.resize(count > 1U ? size - 1U : count);
+
+    m_convex.clear();
+    for (const uint32_t index : m_convexIndices)
+    {
+        m_onConvex[index] = 1U;
+        m_convex.push_back(m_positions[index]);
+    }
+}
+
+void FreeSpaceHull::buildConcave()
+{
+    const std::size_t hullSize = m_convexIndices.size();
+    if (m_settings.shape == HullShape::Convex || hullSize < 3U)
+    {
+        m_vertices.assign(m_convex.begin(), m_convex.end());
+        return;
+    }
+
+    m_next.resize(m_positions.size());
+    m_onOutline.assign(m_positions.size(), 0U);
+    for (const uint32_t index : m_convexIndices)
+    {
+        m_onOutline[index] = 1U;
+    }
+
+    // The convex hull skips points lying on its edges. Digging into such an edge would leave them
+    // outside, so they become outline vertices first, in order along the edge.
+    m_pendingEdges.clear();
+    for (std::size_t i = 0; i < hullSize; ++i)
+    {
+        const uint32_t from = m_convexIndices[i];
+        const uint32_t to = m_convexIndices[(i + 1U) % hullSize];
+        const glm::vec2 start = m_positions[from];
+        const glm::vec2 edge = m_positions[to] - start;
+        const float lengthSquared = glm::dot(edge, edge);
+        m_edgePoints.clear();
+        for (const uint32_t index : m_order)
+        {
+            const glm::vec2 offset = m_positions[index] - start;
+            const float along = glm::dot(offset, edge);
+            if (m_onOutline[index] == 0U && along > 0.0F && along < lengthSquared
+                && std::fabs(edge.x * offset.y - edge.y * offset.x) <= kCollinearTolerance * lengthSquared)
+            {
+                m_edgePoints.emplace_back(along, index);
+            }
+        }
+        std::sort(m_edgePoints.begin(), m_edgePoints.end());
+
+        uint32_t previous = from;
+        for (const auto& [along, index] : m_edgePoints)
+        {
+            m_next[previous] = index;
+            m_onOutline[index] = 1U;
+            m_pendingEdges.push_back(previous);
+            previous = index;
+        }
+        m_next[previous] = to;
+        m_pendingEdges.push_back(previous);
+    }
+
+    const float minLengthSquared = m_settings.lengthThreshold * m_settings.lengthThreshold;
+    while (!m_pendingEdges.empty())
+    {
+        const uint32_t from = m_pendingEdges.back();
+        m_pendingEdges.pop_back();
+        const uint32_t to = m_next[from];
+        const glm::vec2 start = m_positions[from];
+        const glm::vec2 edge = m_positions[to] - start;
+        const float lengthSquared = glm::dot(edge, edge);
+        if (lengthSquared <= minLengthSquared)
+        {
+            continue;
+        }
+
+        // Nearest point beside the edge on its inner (left) side. Nothing else lies in the triangle
+        // it forms with the edge, so every point stays inside the outline.
+        const float maxDistance = std::sqrt(lengthSquared) / m_settings.concavity;
+        const glm::vec2 boundsMin = glm::min(start, m_positions[to]) - maxDistance;
+        const glm::vec2 boundsMax = glm::max(start, m_positions[to]) + maxDistance;
+        float bestDistanceSquared = maxDistance * maxDistance;
+        uint32_t best = kNoIndex;
+        for (const uint32_t index : m_order)
+        {
+            const glm::vec2& point = m_positions[index];
+            if (m_onOutline[index] != 0U || point.x < boundsMin.x || point.y < boundsMin.y || point.x > boundsMax.x
+                || point.y > boundsMax.y)
+            {
+                continue;
+            }
+            const glm::vec2 offset = point - start;
+            const float side = edge.x * offset.y - edge.y * offset.x;
+            const float along = glm::dot(offset, edge);
+            if (side <= 0.0F || along < 0.0F || along > lengthSquared)
+            {
+                continue;
+            }
+            const float distanceSquared = side * side / lengthSquared;
+            if (distanceSquared < bestDistanceSquared)
+            {
+                bestDistanceSquared = distanceSquared;
+                best = index;
+            }
+        }
+
+        if (best != kNoIndex && !crossesOutline(from, to, best))
+        {
+            m_next[from] = best;
+            m_next[best] = to;
+            m_onOutline[best] = 1U;
+            m_pendingEdges.push_back(from);
+            m_pendingEdges.push_back(best);
+        }
+    }
+
+    m_vertices.clear();
+    const uint32_t first = m_convexIndices.front();
+    uint32_t index = first;
+    do
+    {
+        m_vertices.push_back(m_positions[index]);
+        index = m_next[index];
+    } while (index != first);
+}
+
+bool FreeSpaceHull::crossesOutline(uint32_t from, uint32_t to, uint32_t candidate) const noexcept
+{
+    const glm::vec2& a = m_positions[from];
+    const glm::vec2& b = m_positions[to];
+    const glm::vec2& c = m_positions[candidate];
+    // Every outline edge except from -> to; edges sharing an endpoint with a new edge are only
+    // tested against the other new edge.
+    for (uint32_t u = to; u != from; u = m_next[u])
+    {
+        const uint32_t v = m_next[u];
+        const glm::vec2& p = m_positions[u];
+        const glm::vec2& q = m_positions[v];
+        if (u != from && v != from && segmentsIntersect(a, c, p, q))
+        {
+            return true;
+        }
+        if (u != to && v != to && segmentsIntersect(c, b, p, q))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace mapping
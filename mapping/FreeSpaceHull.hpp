@@ -0,0 +1,107 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace mapping
+{
+
+enum class HullShape
+{
+    Convex,
+    /// Convex hull dug in towards the points along its long edges.
+    Concave,
+};
+
+struct FreeSpaceHullSettings
+{
+    HullShape shape = HullShape::Concave;
+    /// Concave shape: edges up to this long are kept as they are [m].
+    float lengthThreshold = 0.5F;
+    /// Concave shape: a longer edge is dug in only by a point closer to it than its length divided
+    /// by this. Larger values follow the points more loosely.
+    float concavity = 2.0F;
+};
+
+/// Outline through every valid position in bin order, so each bin's nearest return is a vertex
+/// and the polygon covers only what the bins saw as free. Bins must be ordered counterclockwise
+/// around `center`, with each position inside its own bin's sector. The outline is then simple
+/// unless consecutive valid bins leave a gap of more than pi, which one O(n) pass detects. Only
+/// then is each crossing removed by reversing the chain between the two edges (a 2-opt move),
+/// which keeps every vertex. Returns the number of crossings removed.
+std::size_t binOrderedOutline(std::span<const uint8_t> valid,
+                              std::span<const glm::vec2> positions,
+                              const glm::vec2& center,
+                              std::vector<glm::vec2>& outline);
+
+/// Simple polygon enclosing a set of ground-plane points. It is an envelope of the obstacles, not
+/// free space: a close return between far ones ends up inside it. The convex hull comes from
+/// Andrew's monotone chain over an index order sorted by x, then y. The concave shape starts from
+/// it and repeatedly replaces a long edge by two edges through the nearest point beside it. A point
+/// is skipped if its new edges would cross the polygon. The result is therefore always simple and
+/// contains every input point.
+///
+/// update() keeps per-bin inputs between frames. When nothing changed, or for the convex shape
+/// when every change lies inside the hull and no hull vertex moved, the previous hull is kept.
+/// Otherwise the previous sort order is repaired by insertion sort, which costs little when only a
+/// few bins moved, and the hull is rebuilt from it. All buffers are reused across calls.
+class FreeSpaceHull
+{
+public:
+    explicit FreeSpaceHull(const FreeSpaceHullSettings& settings = {});
+
+    /// Takes effect on the next build() or update(), which then rebuilds.
+    void configure(const FreeSpaceHullSettings& settings);
+    const FreeSpaceHullSettings& settings() const noexcept { return m_settings; }
+
+    /// Hull of `points`, built from scratch.
+    void build(std::span<const glm::vec2> points);
+    /// Hull of the positions whose `valid` flag is set, compared bin by bin with the last call.
+    void update(std::span<const uint8_t> valid, std::span<const glm::vec2> positions);
+
+    /// Counter-clockwise outline in the configured shape; the first vertex is not repeated.
+    const std::vector<glm::vec2>& vertices() const noexcept { return m_vertices; }
+    const std::vector<glm::vec2>& convexVertices() const noexcept { return m_convex; }
+    /// Bins that differed from the previous update() call.
+    std::size_t changedInputs() const noexcept { return m_changedInputs; }
+    /// False when the last update() kept the previous outline.
+    bool rebuilt() const noexcept { return m_rebuilt; }
+
+private:
+    bool precedes(uint32_t lhs, uint32_t rhs) const noexcept;
+    bool insideConvex(const glm::vec2& point) const noexcept;
+    void sortOrder();
+    void repairOrder();
+    void buildConvex();
+    void buildConcave();
+    bool crossesOutline(uint32_t from, uint32_t to, uint32_t candidate) const noexcept;
+
+    FreeSpaceHullSettings m_settings;
+    bool m_dirty = true;
+
+    std::vector<glm::vec2> m_positions;
+    std::vector<uint8_t> m_valid;
+    /// Valid input indices sorted by x, then y, then index.
+    std::vector<uint32_t> m_order;
+    std::vector<uint32_t> m_convexIndices;
+    std::vector<uint8_t> m_onConvex;
+
+    /// Concave outline as a ring of input indices.
+    std::vector<uint32_t> m_next;
+    std::vector<uint8_t> m_onOutline;
+    std::vector<uint32_t> m_pendingEdges;
+    /// Points on one convex hull edge, keyed by their position along it.
+    std::vector<std::pair<float, uint32_t>> m_edgePoints;
+
+    std::vector<glm::vec2> m_convex;
+    std::vector<glm::vec2> m_vertices;
+    std::size_t m_changedInputs = 0U;
+    bool m_rebuilt = false;
+};
+
+} // namespace mapping
@@ -0,0 +1,216 @@
+#include "mapping/GroundSegmentation.hpp"
+#include "mapping/SensorBinLookup.hpp"
+
+#include <glm/gtc/constants.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace mapping
+{
+
+namespace
+{
+constexpr double kMinSeedCount = 3.0;
+// Pulls the slope towards flat along directions the seeds barely span, e.g. a single scan ring.
+constexpr double kSlopeRegularization = 0.01;
+
+} // namespace
+
+GroundSegmentation::GroundSegmentation(const GroundSegmentationSettings& settings)
+{
+    configure(settings);
+}
+
+void GroundSegmentation::configure(const GroundSegmentationSettings& settings)
+{
+    m_settings = settings;
+    m_settings.sectorCount = std::clamp<std::size_t>(settings.sectorCount, 1U, kMaxSectors);
+    m_settings.ringCount = std::clamp<std::size_t>(settings.ringCount, 1U, kMaxRings);
+    m_settings.maxRange = std::max(settings.maxRange, 1.0F);
+    m_settings.seedHeightMargin = std::max(settings.seedHeightMargin, 0.0F);
+    m_settings.distanceThreshold = std::max(settings.distanceThreshold, 0.0F);
+    m_settings.maxSlope = std::max(settings.maxSlope, 0.0F);
+    m_settings.maxStep = std::max(settings.maxStep, 0.0F);
+
+    m_sectorsPerRadian = static_cast<float>(m_settings.sectorCount) / glm::two_pi<float>();
+    m_ringsPerMeter = static_cast<float>(m_settings.ringCount) / m_settings.maxRange;
+
+    const std::size_t cellCount = m_settings.sectorCount * m_settings.ringCount;
+    m_cellMinZ.assign(cellCount, std::numeric_limits<float>::max());
+    m_cellSeeds.assign(cellCount, SeedMoments{});
+    m_cellPlanes.assign(cellCount, Plane{});
+    updateReferencePlane();
+}
+
+void GroundSegmentation::setSensorTilt(float roll, float pitch)
+{
+    m_roll = roll;
+    m_pitch = pitch;
+    updateReferencePlane();
+}
+
+void GroundSegmentation::updateReferencePlane()
+{
+    // Gravity's "up" in the point frame is (-sin p, cos p sin r, cos p cos r); the level plane
+    // up . point = heightThreshold solved for z.
+    const float upZ = std::cos(m_pitch) * std::cos(m_roll);
+    m_reference.slopeX = std::sin(m_pitch) / upZ;
+    m_reference.slopeY = -std::cos(m_pitch) * std::sin(m_roll) / upZ;
+    m_reference.offset = m_settings.heightThreshold / upZ;
+}
+
+std::size_t GroundSegmentation::cellIndex(float x, float y) const noexcept
+{
+    const float angle = AngularBinLookup::fastAtan2(y, x) + glm::pi<float>();
+    const auto sector = std::min(static_cast<std::size_t>(angle * m_sectorsPerRadian), m_settings.sectorCount - 1U);
+    const float range = std::sqrt(x * x + y * y);
+    const auto ring = std::min(static_cast<std::size_t>(range * m_ringsPerMeter), m_settings.ringCount - 1U);
+    return ring * m_settings.sectorCount + sector;
+}
+
+void GroundSegmentation::segment(const lidar::BaseLidarSensor::PointCloud& points,
+                                 const glm::vec2& sensorOrigin,
+                                 lidar::BaseLidarSensor::PointCloud& ground,
+                                 lidar::BaseLidarSensor::PointCloud& nonGround)
+{
+    ground.clear();
+    nonGround.clear();
+    ground.reserve(points.size());
+    nonGround.reserve(points.size());
+    m_origin = sensorOrigin;
+
+    if (m_settings.mode == GroundSegmentationMode::HeightThreshold)
+    {
+        for (const auto& point : points)
+        {
+            const float reference = m_reference.heightAt(point.x - m_origin.x, point.y - m_origin.y);
+            (point.z <= reference ? ground : nonGround).push_back(point);
+        }
+        return;
+    }
+
+    std::fill(m_cellMinZ.begin(), m_cellMinZ.end(), std::numeric_limits<float>::max());
+    std::fill(m_cellSeeds.begin(), m_cellSeeds.end(), SeedMoments{});
+    m_pointCells.resize(points.size());
+
+    for (std::size_t i = 0; i < points.size(); ++i)
+    {
+        const auto cell = cellIndex(points[i].x - m_origin.x, points[i].y - m_origin.y);
+        m_pointCells[i] = static_cast<uint32_t>(cell);
+        m_cellMinZ[cell] = std::min(m_cellMinZ[cell], points[i].z);
+    }
+
+    for (std::size_t i = 0; i < points.size(); ++i)
+    {
+        const auto cell = m_pointCells[i];
+        const auto& point = points[i];
+        if (point.z > m_cellMinZ[cell] + m_settings.seedHeightMargin)
+        {
+            continue;
+        }
+        const double x = point.x - m_origin.x;
+        const double y = point.y - m_origin.y;
+        const double z = point.z;
+        SeedMoments& seeds = m_cellSeeds[cell];
+        seeds.count += 1.0;
+        seeds.sumX += x;
+        seeds.sumY += y;
+        seeds.sumZ += z;
+        seeds.sumXX += x * x;
+        seeds.sumXY += x * y;
+        seeds.sumYY += y * y;
+        seeds.sumXZ += x * z;
+        seeds.sumYZ += y * z;
+    }
+
+    fitPlanes();
+
+    const float threshold = m_settings.distanceThreshold;
+    for (std::size_t i = 0; i < points.size(); ++i)
+    {
+        const auto& point = points[i];
+        const Plane& plane = m_cellPlanes[m_pointCells[i]];
+        const float height = point.z - plane.heightAt(point.x - m_origin.x, point.y - m_origin.y);
+        (height <= threshold ? ground : nonGround).push_back(point);
+    }
+}
+
+void GroundSegmentation::fitPlanes()
+{
+    // Level plane that reproduces the threshold mode for cells with no usable fit.
+    const Plane fallback{m_reference.slopeX, m_reference.slopeY, m_reference.offset - m_settings.distanceThreshold};
+    const float ringWidth = 1.0F / m_ringsPerMeter;
+    const float sectorWidth = 1.0F / m_sectorsPerRadian;
+    const std::size_t sectors = m_settings.sectorCount;
+
+    for (std::size_t ring = 0; ring < m_settings.ringCount; ++ring)
+    {
+        const float centerRange = (static_cast<float>(ring) + 0.5F) * ringWidth;
+        for (std::size_t sector = 0; sector < sectors; ++sector)
+        {
+            const std::size_t cell = ring * sectors + sector;
+            const Plane& inner = ring == 0U ? fallback : m_cellPlanes[cell - sectors];
+
+            Plane plane;
+            bool accepted = fitCell(cell, plane);
+            if (accepted)
+            {
+                // Reject planes that rise above the inner ring's plane extended to this cell; they
+                // sit on top of obstacles that hide the ground. Steps down are accepted as ditches.
+                const float angle = (static_cast<float>(sector) + 0.5F) * sectorWidth - glm::pi<float>();
+                const float x = centerRange * std::cos(angle);
+                const float y = centerRange * std::sin(angle);
+                accepted = plane.heightAt(x, y) - inner.heightAt(x, y) <= m_settings.maxStep;
+            }
+            m_cellPlanes[cell] = accepted ? plane : inner;
+        }
+    }
+}
+
+bool GroundSegmentation::fitCell(std::size_t cell, Plane& plane) const
+{
+    const SeedMoments& seeds = m_cellSeeds[cell];
+    if (seeds.count < kMinSeedCount)
+    {
+        return false;
+    }
+
+    const double inverseCount = 1.0 / seeds.count;
+    const double meanX = seeds.sumX * inverseCount;
+    const double meanY = seeds.sumY * inverseCount;
+    const double meanZ = seeds.sumZ * inverseCount;
+    const double covXX = seeds.sumXX * inverseCount - meanX * meanX + kSlopeRegularization;
+    const double covXY = seeds.sumXY * inverseCount - meanX * meanY;
+    const double covYY = seeds.sumYY * inverseCount - meanY * meanY + kSlopeRegularization;
+    const double covXZ = seeds.sumXZ * inverseCount - meanX * meanZ;
+    const double covYZ = seeds.sumYZ * inverseCount - meanY * meanZ;
+
+    // Least squares for z - meanZ = a (x - meanX) + b (y - meanY); Cramer's rule on the 2x2 system.
+    const double determinant = covXX * covYY - covXY * covXY;
+    if (!(determinant > 0.0))
+    {
+        return false;
+    }
+    const double slopeX = (covXZ * covYY - covYZ * covXY) / determinant;
+    const double slopeY = (covYZ * covXX - covXZ * covXY) / determinant;
+    plane.slopeX = static_cast<float>(slopeX);
+    plane.slopeY = static_cast<float>(slopeY);
+    plane.offset = static_cast<float>(meanZ - slopeX * meanX - slopeY * meanY);
+
+    const float maxSlope = m_settings.maxSlope;
+    return plane.slopeX * plane.slopeX + plane.slopeY * plane.slopeY <= maxSlope * maxSlope;
+}
+
+float GroundSegmentation::groundHeight(const glm::vec2& position) const
+{
+    const glm::vec2 relative = position - m_origin;
+    if (m_settings.mode == GroundSegmentationMode::HeightThreshold)
+    {
+        return m_reference.heightAt(relative.x, relative.y) - m_settings.distanceThreshold;
+    }
+    return m_cellPlanes[cellIndex(relative.x, relative.y)].heightAt(relative.x, relative.y);
+}
+
+} // namespace mapping
@@ -0,0 +1,115 @@
+#pragma once
+
+#include "sensors/BaseLidarSensor.hpp"
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace mapping
+{
+
+enum class GroundSegmentationMode
+{
+    /// Ground is everything at or below `heightThreshold`.
+    HeightThreshold,
+    /// Local ground planes fitted per polar grid cell.
+    PolarPlaneFit,
+};
+
+struct GroundSegmentationSettings
+{
+    GroundSegmentationMode mode = GroundSegmentationMode::PolarPlaneFit;
+    /// Threshold mode cut-off, and the flat plane assumed where no local plane can be fitted.
+    float heightThreshold = -1.208F;
+    std::size_t sectorCount = 32U;
+    std::size_t ringCount = 20U;
+    /// Ranges beyond this fall into the outermost ring [m].
+    float maxRange = 60.0F;
+    /// Points up to this far above a cell's lowest point seed its plane fit [m].
+    float seedHeightMargin = 0.25F;
+    /// Points up to this far above the local plane are ground [m].
+    float distanceThreshold = 0.2F;
+    /// Steepest accepted plane, as rise over run.
+    float maxSlope = 0.3F;
+    /// Largest step from the plane of the next ring inward, measured at the cell centre [m].
+    float maxStep = 0.35F;
+};
+
+/// Ground/non-ground split on a polar grid around the sensor. One pass bins the points and
+/// records each cell's lowest point, a second fits z = a*x + b*y + c to the cell's low seeds, and a
+/// third labels every point by its height above the cell's plane. Cells without a usable plane
+/// (too few seeds, too steep, or a jump from the ring inside, e.g. a car roof with no ground
+/// visible) inherit the plane of the next ring inward, ending at the level `heightThreshold` plane.
+/// All per-cell state lives in arrays sized once by configure(), so a frame does not allocate.
+class GroundSegmentation
+{
+public:
+    static constexpr std::size_t kMaxSectors = 360U;
+    static constexpr std::size_t kMaxRings = 100U;
+
+    explicit GroundSegmentation(const GroundSegmentationSettings& settings = {});
+
+    void configure(const GroundSegmentationSettings& settings);
+    const GroundSegmentationSettings& settings() const noexcept { return m_settings; }
+
+    /// Sensor roll (about x) and pitch (about y) relative to gravity [rad], e.g. from its IMU. The
+    /// `heightThreshold` plane is then taken level in the world, which tilts it in the point frame
+    /// when the vehicle brakes or leans in a corner.
+    void setSensorTilt(float roll, float pitch);
+    /// Splits `points` into `ground` and `nonGround`, keeping the input order within each. The
+    /// polar grid is centred on `sensorOrigin`, given in the same frame as the points.
+    void segment(const lidar::BaseLidarSensor::PointCloud& points,
+                 const glm::vec2& sensorOrigin,
+                 lidar::BaseLidarSensor::PointCloud& ground,
+                 lidar::BaseLidarSensor::PointCloud& nonGround);
+
+    /// Ground height of the plane used for the cell containing `position`, from the last segment().
+    float groundHeight(const glm::vec2& position) const;
+
+private:
+    struct Plane
+    {
+        float slopeX = 0.0F;
+        float slopeY = 0.0F;
+        float offset = 0.0F;
+
+        float heightAt(float x, float y) const noexcept { return slopeX * x + slopeY * y + offset; }
+    };
+
+    // Double sums: ranges reach tens of metres, so float moments would cancel badly.
+    struct SeedMoments
+    {
+        double count = 0.0;
+        double sumX = 0.0;
+        double sumY = 0.0;
+        double sumZ = 0.0;
+        double sumXX = 0.0;
+        double sumXY = 0.0;
+        double sumYY = 0.0;
+        double sumXZ = 0.0;
+        double sumYZ = 0.0;
+    };
+
+    std::size_t cellIndex(float x, float y) const noexcept;
+    void updateReferencePlane();
+    void fitPlanes();
+    bool fitCell(std::size_t cell, Plane& plane) const;
+
+    GroundSegmentationSettings m_settings;
+    glm::vec2 m_origin = glm::vec2(0.0F);
+    float m_roll = 0.0F;
+    float m_pitch = 0.0F;
+    /// The `heightThreshold` plane in the point frame, relative to the origin.
+    Plane m_reference;
+    float m_sectorsPerRadian = 0.0F;
+    float m_ringsPerMeter = 0.0F;
+    std::vector<uint32_t> m_pointCells;
+    std::vector<float> m_cellMinZ;
+    std::vector<SeedMoments> m_cellSeeds;
+    std::vector<Plane> m_cellPlanes;
+};
+
+} // namespace mapping
@@ -0,0 +1,229 @@
+#include "mapping/KdTree.hpp"
+
+#include <algorithm>
+
+namespace mapping
+{
+
+namespace
+{
+float distanceSquared(const std::array<float, 3>& a, const std::array<float, 3>& b) noexcept
+{
+    const float dx = a[0] - b[0];
+    const float dy = a[1] - b[1];
+    const float dz = a[2] - b[2];
+    return dx * dx + dy * dy + dz * dz;
+}
+
+std::array<float, 3> toArray(const glm::vec3& point) noexcept
+{
+    return {point.x, point.y, point.z};
+}
+
+bool closer(const KdNeighbour& a, const KdNeighbour& b) noexcept
+{
+    return a.distanceSquared < b.distanceSquared;
+}
+} // namespace
+
+void KdTree::KnnHeap::offer(uint32_t index, float distance) noexcept
+{
+    // Max-heap on distance, so the current k-th neighbour sits at entries[0].
+    if (count < capacity)
+    {
+        entries[count++] = KdNeighbour{index, distance};
+        std::push_heap(entries, entries + count, closer);
+    }
+    else if (distance < entries[0].distanceSquared)
+    {
+        std::pop_heap(entries, entries + count, closer);
+        entries[count - 1U] = KdNeighbour{index, distance};
+        std::push_heap(entries, entries + count, closer);
+    }
+}
+
+void KdTree::build(const lidar::BaseLidarSensor::PointCloud& points)
+{
+    m_nodes.resize(points.size());
+    m_splitAxis.assign(points.size(), 0U);
+    for (std::size_t i = 0; i < points.size(); ++i)
+    {
+        m_nodes[i] = Node{{points[i].x, points[i].y, points[i].z}, static_cast<uint32_t>(i)};
+    }
+    buildRange(0U, m_nodes.size());
+}
+
+void KdTree::buildRange(std::size_t begin, std::size_t end)
+{
+    if (end - begin <= kLeafSize)
+    {
+        return;
+    }
+
+    // Split the widest extent so cells stay compact on flat, elongated scans. Large ranges only
+    // measure a strided sample, which picks the same axis without a full pass per level.
+    const std::size_t stride = std::max<std::size_t>(1U, (end - begin) / kAxisSamples);
+    std::array<float, 3> low{std::numeric_limits<float>::max(),
+                             std::numeric_limits<float>::max(),
+                             std::numeric_limits<float>::max()};
+    std::array<float, 3> high{std::numeric_limits<float>::lowest(),
+                              std::numeric_limits<float>::lowest(),
+                              std::numeric_limits<float>::lowest()};
+    for (std::size_t i = begin; i < end; i += stride)
+    {
+        for (std::size_t axis = 0; axis < 3U; ++axis)
+        {
+            low[axis] = std::min(low[axis], m_nodes[i].position[axis]);
+            high[axis] = std::max(high[axis], m_nodes[i].position[axis]);
+        }
+    }
+    uint8_t axis = 0U;
+    for (uint8_t candidate = 1U; candidate < 3U; ++candidate)
+    {
+        if (high[candidate] - low[candidate] > high[axis] - low[axis])
+        {
+            axis = candidate;
+        }
+    }
+
+    const std::size_t middle = begin + (end - begin) / 2U;
+    std::nth_element(m_nodes.begin() + static_cast<std::ptrdiff_t>(begin),
+                     m_nodes.begin() + static_cast<std::ptrdiff_t>(middle),
+                     m_nodes.begin() + static_cast<std::ptrdiff_t>(end),
+                     [axis](const Node& a, const Node& b) { return a.position[axis] < b.position[axis]; });
+    m_splitAxis[middle] = axis;
+
+    if (m_threadPool && end - begin > kParallelBuildPoints)
+    {
+        m_threadPool->parallelInvoke({[this, begin, middle]() { buildRange(begin, middle); },
+                                      [this, middle, end]() { buildRange(middle + 1U, end); }});
+        return;
+    }
+    buildRange(begin, middle);
+    buildRange(middle + 1U, end);
+}
+
+bool KdTree::nearest(const glm::vec3& query, KdNeighbour& result) const noexcept
+{
+    return nearestK(query, std::span<KdNeighbour>(&result, 1U)) == 1U;
+}
+
+std::size_t KdTree::nearestK(const glm::vec3& query, std::span<KdNeighbour> results) const noexcept
+{
+    KnnHeap heap{results.data(), std::min(results.size(), m_nodes.size()), 0U};
+    if (heap.capacity == 0U)
+    {
+        return 0U;
+    }
+    searchNearestK(0U, m_nodes.size(), toArray(query), heap);
+    std::sort_heap(results.data(), results.data() + heap.count, closer);
+    return heap.count;
+}
+
+void KdTree::searchNearestK(std::size_t begin,
+                            std::size_t end,
+                            const std::array<float, 3>& query,
+                            KnnHeap& heap) const noexcept
+{
+    if (end - begin <= kLeafSize)
+    {
+        for (std::size_t i = begin; i < end; ++i)
+        {
+            heap.offer(m_nodes[i].index, distanceSquared(m_nodes[i].position, query));
+        }
+        return;
+    }
+
+    const std::size_t middle = begin + (end - begin) / 2U;
+    const Node& node = m_nodes[middle];
+    const uint8_t axis = m_splitAxis[middle];
+    const float delta = query[axis] - node.position[axis];
+    heap.offer(node.index, distanceSquared(node.position, query));
+
+    // Near side first; the far side only matters while the split plane is closer than the k-th hit.
+    if (delta < 0.0F)
+    {
+        searchNearestK(begin, middle, query, heap);
+        if (delta * delta < heap.bound())
+        {
+            searchNearestK(middle + 1U, end, query, heap);
+        }
+    }
+    else
+    {
+        searchNearestK(middle + 1U, end, query, heap);
+        if (delta * delta < heap.bound())
+        {
+            searchNearestK(begin, middle, query, heap);
+        }
+    }
+}
+
+void KdTree::radiusSearch(const glm::vec3& query, float radius, std::vector<KdNeighbour>& results) const
+{
+    results.clear();
+    if (m_nodes.empty() || radius < 0.0F)
+    {
+        return;
+    }
+    searchRadius(0U, m_nodes.size(), toArray(query), radius * radius, results);
+}
+
+void KdTree::searchRadius(std::size_t begin,
+                          std::size_t end,
+                          const std::array<float, 3>& query,
+                          float radiusSquared,
+                          std::vector<KdNeighbour>& results) const
+{
+    if (end - begin <= kLeafSize)
+    {
+        for (std::size_t i = begin; i < end; ++i)
+        {
+            const float distance = distanceSquared(m_nodes[i].position, query);
+            if (distance <= radiusSquared)
+            {
+                results.push_back(KdNeighbour{m_nodes[i].index, distance});
+            }
+        }
+        return;
+    }
+
+    const std::size_t middle = begin + (end - begin) / 2U;
+    const Node& node = m_nodes[middle];
+    const uint8_t axis = m_splitAxis[middle];
+    const float delta = query[axis] - node.position[axis];
+    const float distance = distanceSquared(node.position, query);
+    if (distance <= radiusSquared)
+    {
+        results.push_back(KdNeighbour{node.index, distance});
+    }
+
+    if (delta <= 0.0F || delta * delta <= radiusSquared)
+    {
+        searchRadius(begin, middle, query, radiusSquared, results);
+    }
+    if (delta >= 0.0F || delta * delta <= radiusSquared)
+    {
+        searchRadius(middle + 1U, end, query, radiusSquared, results);
+    }
+}
+
+void KdTree::nearestKBatch(const lidar::BaseLidarSensor::PointCloud& queries,
+                           std::size_t k,
+                           std::vector<KdNeighbour>& results) const
+{
+    results.assign(queries.size() * k, KdNeighbour{});
+    if (k == 0U)
+    {
+        return;
+    }
+    lidar::parallelFor(m_threadPool, 0U, queries.size(), kQueriesPerTask, [&](std::size_t first, std::size_t last) {
+        for (std::size_t i = first; i < last; ++i)
+        {
+            const auto& query = queries[i];
+            nearestK(glm::vec3(query.x, query.y, query.z), std::span<KdNeighbour>(results.data() + i * k, k));
+        }
+    });
+}
+
+} // namespace mapping
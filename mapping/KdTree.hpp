@@ -0,0 +1,93 @@
+#pragma once
+
+#include "engine/ThreadPool.hpp"
+#include "sensors/BaseLidarSensor.hpp"
+
+#include <glm/glm.hpp>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <vector>
+
+namespace mapping
+{
+
+struct KdNeighbour
+{
+    /// Index into the cloud passed to KdTree::build().
+    uint32_t index = std::numeric_limits<uint32_t>::max();
+    float distanceSquared = std::numeric_limits<float>::infinity();
+};
+
+/// Static 3D kd-tree, rebuilt once per frame. The tree is implicit. build() reorders a copy of the
+/// points so that every range keeps its splitting point in the middle, with the lower half before it
+/// and the upper half after it. The only per-node data is the split axis of that middle element.
+/// Ranges of at most kLeafSize points are scanned linearly. Queries write into caller-owned
+/// buffers and do not allocate.
+class KdTree
+{
+public:
+    static constexpr uint32_t kInvalidIndex = std::numeric_limits<uint32_t>::max();
+    static constexpr std::size_t kLeafSize = 8U;
+    /// Subtrees with more points than this are built as separate pool tasks.
+    static constexpr std::size_t kParallelBuildPoints = 16384U;
+    static constexpr std::size_t kQueriesPerTask = 256U;
+    /// Points measured per range when choosing the split axis.
+    static constexpr std::size_t kAxisSamples = 256U;
+
+    void setThreadPool(lidar::ThreadPool* pool) noexcept { m_threadPool = pool; }
+
+    void build(const lidar::BaseLidarSensor::PointCloud& points);
+    std::size_t size() const noexcept { return m_nodes.size(); }
+    bool empty() const noexcept { return m_nodes.empty(); }
+
+    /// Closest point to `query`; false when the tree is empty.
+    bool nearest(const glm::vec3& query, KdNeighbour& result) const noexcept;
+    /// Writes the min(results.size(), size()) nearest points in ascending distance and returns
+    /// how many were written.
+    std::size_t nearestK(const glm::vec3& query, std::span<KdNeighbour> results) const noexcept;
+    /// Replaces `results` with every point within `radius`, in no particular order.
+    void radiusSearch(const glm::vec3& query, float radius, std::vector<KdNeighbour>& results) const;
+    /// Runs nearestK for every query, in parallel on the attached pool. Neighbour j of query i
+    /// lands at results[i * k + j]. Slots beyond the tree size keep kInvalidIndex.
+    void nearestKBatch(const lidar::BaseLidarSensor::PointCloud& queries,
+                       std::size_t k,
+                       std::vector<KdNeighbour>& results) const;
+
+private:
+    struct Node
+    {
+        std::array<float, 3> position{};
+        uint32_t index = 0U;
+    };
+
+    struct KnnHeap
+    {
+        KdNeighbour* entries = nullptr;
+        std::size_t capacity = 0U;
+        std::size_t count = 0U;
+
+        float bound() const noexcept
+        {
+            return count < capacity ? std::numeric_limits<float>::infinity() : entries[0].distanceSquared;
+        }
+        void offer(uint32_t index, float distance) noexcept;
+    };
+
+    void buildRange(std::size_t begin, std::size_t end);
+    void searchNearestK(std::size_t begin, std::size_t end, const std::array<float, 3>& query, KnnHeap& heap) const noexcept;
+    void searchRadius(std::size_t begin,
+                      std::size_t end,
+                      const std::array<float, 3>& query,
+                      float radiusSquared,
+                      std::vector<KdNeighbour>& results) const;
+
+    std::vector<Node> m_nodes;
+    std::vector<uint8_t> m_splitAxis;
+    lidar::ThreadPool* m_threadPool = nullptr;
+};
+
+} // namespace mapping
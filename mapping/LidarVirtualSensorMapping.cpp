@@ -1,5 +1,7 @@
 #include "mapping/LidarVirtualSensorMapping.hpp"
 
+#include "engine/ThreadPool.hpp"
+
 #include <glm/gtc/constants.hpp>
 
 #include <algorithm>
@@ -12,8 +14,56 @@ namespace
 constexpr float kSensorTolerance = 1e-5F;
 }
 
-LidarVirtualSensorMapping::LidarVirtualSensorMapping(float floorHeight)
-    : m_floorHeight(floorHeight)
+void LidarVirtualSensorMapping::SensorLayout::resize(std::size_t count)
+{
+    isAngular.assign(count, 0U);
+    lowerAngle.assign(count, 0.0F);
+    upperAngle.assign(count, 0.0F);
+    wrapAround.assign(count, 0U);
+    orthMinLon.assign(count, 0.0F);
+    orthMaxLon.assign(count, 0.0F);
+    orthSideSign.assign(count, 0.0F);
+    orthMinLat.assign(count, 0.0F);
+    orthMaxLat.assign(count, 0.0F);
+}
+
+void LidarVirtualSensorMapping::SampleArrays::reset(std::size_t count)
+{
+    valid.assign(count, 0U);
+    distanceSquared.assign(count, std::numeric_limits<float>::max());
+    position.assign(count, glm::vec2(0.0F));
+}
+
+void LidarVirtualSensorMapping::SampleArrays::mergeFrom(const SampleArrays& other)
+{
+    for (std::size_t i = 0; i < valid.size(); ++i)
+    {
+        if (other.valid[i] != 0U && other.distanceSquared[i] < distanceSquared[i])
+        {
+            valid[i] = 1U;
+            distanceSquared[i] = other.distanceSquared[i];
+            position[i] = other.position[i];
+        }
+    }
+}
+
+void LidarVirtualSensorMapping::SampleSet::reset(std::size_t sensorCount, std::size_t bandCount)
+{
+    nonGround.reset(sensorCount);
+    ground.reset(sensorCount);
+    bands.reset(sensorCount * bandCount);
+}
+
+void LidarVirtualSensorMapping::SampleSet::mergeFrom(const SampleSet& other)
+{
+    nonGround.mergeFrom(other.nonGround);
+    ground.mergeFrom(other.ground);
+    bands.mergeFrom(other.bands);
+}
+
+LidarVirtualSensorMapping::LidarVirtualSensorMapping(float floorHeight, std::size_t angularSensorCount)
+    : m_angularSensorCount(std::clamp(angularSensorCount, kMinAngularSensorCount, kMaxAngularSensorCount))
+    , m_floorHeight(floorHeight)
 {
     rebuild();
 }
@@ -37,13 +87,143 @@ void LidarVirtualSensorMapping::setSensorOffset(const glm::vec2& offset)
     m_sensorOffset = offset;
 }
 
+void LidarVirtualSensorMapping::setAngularSensorCount(std::size_t count)
+{
+    const std::size_t clamped = std::clamp(count, kMinAngularSensorCount, kMaxAngularSensorCount);
+    if (clamped == m_angularSensorCount)
+    {
+        return;
+    }
+    m_angularSensorCount = clamped;
+    rebuild();
+}
+
+void LidarVirtualSensorMapping::setSlotSettings(const SlotSettings& settings)
+{
+    SlotSettings sanitized = settings;
+    sanitized.width = std::max(settings.width, 0.05F);
+    sanitized.distance = std::max(settings.distance, 0.05F);
+    sanitized.range = std::max(settings.range, 0.0F);
+    m_slotSettings = sanitized;
+    rebuild();
+}
+
+void LidarVirtualSensorMapping::setHeightBands(const std::vector<HeightBand>& bands)
+{
+    m_heightBands.clear();
+    for (const auto& band : bands)
+    {
+        if (band.maxHeight > band.minHeight && m_heightBands.size() < kMaxHeightBands)
+        {
+            m_heightBands.push_back(band);
+        }
+    }
+    m_samples.reset(sensorCount(), m_heightBands.size());
+}
+
+void LidarVirtualSensorMapping::compensateEgoMotion(const PlanarMotion& motion)
+{
+    // Samples are stored relative to the sensor offset, so the motion is shifted into that frame.
+    PlanarMotion shifted = motion;
+    shifted.translation = motion.apply(m_sensorOffset) - m_sensorOffset;
+    m_accumulator.compensateMotion(shifted, [this](std::size_t sensor, const glm::vec2& position, float& distanceSquared) {
+        if (!sensorContains(sensor, position) || isInsideVehicleContour(position))
+        {
+            return false;
+        }
+        distanceSquared = sensorDistanceSquared(sensor, position);
+        return true;
+    });
+}
+
+void LidarVirtualSensorMapping::setEnvelopeEnabled(bool enabled)
+{
+    m_envelopeEnabled = enabled;
+    if (!enabled)
+    {
+        m_envelope.clear();
+    }
+}
+
+void LidarVirtualSensorMapping::setEnvelopeSettings(const FreeSpaceHullSettings& settings)
+{
+    m_envelopeBuilder.configure(settings);
+}
+
+void LidarVirtualSensorMapping::setAccumulatorSettings(const FreeSpaceAccumulatorSettings& settings)
+{
+    m_accumulator.configure(settings);
+    m_accumulator.reset(sensorCount());
+}
+
 void LidarVirtualSensorMapping::updatePoints(
     const lidar::BaseLidarSensor::PointCloud& points)
 {
-    resetSamples();
+    const std::size_t count = sensorCount();
+    const std::size_t bandCount = m_heightBands.size();
+    m_samples.reset(count, bandCount);
+
+    if (!m_threadPool || points.size() <= kPointsPerChunk)
+    {
+        accumulatePoints(points, 0U, points.size(), m_samples);
+    }
+    else
+    {
+        // Each chunk keeps its own minima; merging in chunk order keeps the earliest point on
+        // ties, exactly like the sequential pass.
+        const std::size_t chunkCount = (points.size() + kPointsPerChunk - 1U) / kPointsPerChunk;
+        if (m_chunkSamples.size() < chunkCount)
+        {
+            m_chunkSamples.resize(chunkCount);
+        }
+        m_threadPool->parallelFor(0U, chunkCount, 1U, [&](std::size_t firstChunk, std::size_t lastChunk) {
+            for (std::size_t chunk = firstChunk; chunk < lastChunk; ++chunk)
+            {
+                auto& partial = m_chunkSamples[chunk];
+                partial.reset(count, bandCount);
+                const std::size_t first = chunk * kPointsPerChunk;
+                accumulatePoints(points, first, std::min(points.size(), first + kPointsPerChunk), partial);
+            }
+        });
+        for (std::size_t chunk = 0; chunk < chunkCount; ++chunk)
+        {
+            m_samples.mergeFrom(m_chunkSamples[chunk]);
+        }
+    }
+
+    m_accumulator.update(m_samples.nonGround.valid, m_samples.nonGround.distanceSquared, m_samples.nonGround.position);
+
+    collectHull(m_samples.nonGround, m_hullNonGround);
+    collectHull(m_samples.ground, m_hullGround);
+    if (m_envelopeEnabled)
+    {
+        m_envelopeBuilder.update(std::span<const uint8_t>(m_samples.nonGround.valid).first(m_angularSensorCount),
+                                 std::span<const glm::vec2>(m_samples.nonGround.position).first(m_angularSensorCount));
+        m_envelope.assign(m_envelopeBuilder.vertices().begin(), m_envelopeBuilder.vertices().end());
+    }
+    publishFrame();
+}
+
+void LidarVirtualSensorMapping::publishFrame()
+{
+    SensorFrame& frame = m_publisher.beginWrite();
+    frame.version = m_publisher.version() + 1U;
+    fillSnapshots(frame.sensors);
+    frame.hull = m_hullNonGround;
+    frame.groundHull = m_hullGround;
+    m_publisher.publish();
+}
 
-    for (const auto& point : points)
+void LidarVirtualSensorMapping::accumulatePoints(const lidar::BaseLidarSensor::PointCloud& points,
+                                                 std::size_t first,
+                                                 std::size_t last,
+                                                 SampleSet& output) const
+{
+    const std::size_t count = sensorCount();
+    const std::size_t bandCount = m_heightBands.size();
+    for (std::size_t index = first; index < last; ++index)
     {
+        const auto& point = points[index];
         const glm::vec2 rawPosition(point.x, point.y);
         const glm::vec2 position = rawPosition - m_sensorOffset;
         if (isInsideVehicleContour(position))
@@ -53,44 +233,77 @@ void LidarVirtualSensorMapping::updatePoints(
         const bool groundPoint = point.z < m_floorHeight;
         const float distanceSquared = glm::dot(position, position);
 
-        auto& samples = groundPoint ? m_sensorSamplesGround : m_sensorSamples;
-        for (std::size_t sensorIndex = 0; sensorIndex < kVirtualSensorCount; ++sensorIndex)
+        // Resolve band membership once; each band then costs one indexed min per sensor.
+        std::size_t bandOffsets[kMaxHeightBands];
+        std::size_t pointBandCount = 0U;
+        const float height = point.z - m_floorHeight;
+        for (std::size_t band = 0; band < bandCount; ++band)
         {
-            const auto& sensor = m_sensorDefinitions[sensorIndex];
-            if (!sensorContains(sensor, position))
+            if (height >= m_heightBands[band].minHeight && height < m_heightBands[band].maxHeight)
             {
-                continue;
+                bandOffsets[pointBandCount++] = band * count;
             }
+        }
 
-            auto& sample = samples[sensorIndex];
-            if (distanceSquared < sample.distanceSquared)
+        SampleArrays& samples = groundPoint ? output.ground : output.nonGround;
+        SampleArrays& bands = output.bands;
+        const auto updateSample = [&](std::size_t sensorIndex, float key) {
+            if (key < samples.distanceSquared[sensorIndex])
             {
-                sample.distanceSquared = distanceSquared;
-                sample.position = position;
-                sample.valid = true;
+                samples.distanceSquared[sensorIndex] = key;
+                samples.position[sensorIndex] = position;
+                samples.valid[sensorIndex] = 1U;
             }
-        }
-    }
+            for (std::size_t i = 0; i < pointBandCount; ++i)
+            {
+                const std::size_t cell = bandOffsets[i] + sensorIndex;
+                if (key < bands.distanceSquared[cell])
+                {
+                    bands.distanceSquared[cell] = key;
+                    bands.position[cell] = position;
+                    bands.valid[cell] = 1U;
+                }
+            }
+        };
 
-    m_hullNonGround.clear();
-    for (const auto& sample : m_sensorSamples)
-    {
-        if (sample.valid)
+        const AngularBinLookup::Candidates candidates = m_angularLookup.locate(position);
+        if (candidates.allBins)
         {
-            m_hullNonGround.push_back(sample.position);
+            for (std::size_t bin = 0; bin < m_angularLookup.binCount(); ++bin)
+            {
+                updateSample(bin, distanceSquared);
+            }
         }
-    }
-
-    m_hullGround.clear();
-    for (const auto& sample : m_sensorSamplesGround)
-    {
-        if (sample.valid)
+        for (std::size_t i = 0; i < candidates.count; ++i)
         {
-            m_hullGround.push_back(sample.position);
+            const std::size_t bin = candidates.bins[i];
+            if (!candidates.needsExactCheck || sensorContains(bin, position))
+            {
+                updateSample(bin, distanceSquared);
+            }
         }
+
+        const float lateral = position.x - m_vehicleCenter.x;
+        const OrthogonalSlotLookup& slots = m_slotLookups[lateral >= 0.0F ? 0U : 1U];
+        slots.forEachCandidate(position.y, [&](std::size_t sensorIndex) {
+            const float distance = std::fabs(lateral);
+            if (distance >= m_layout.orthMinLat[sensorIndex] && distance <= m_layout.orthMaxLat[sensorIndex])
+            {
+                updateSample(sensorIndex, distance * distance);
+            }
+        });
     }
 }
 
+void LidarVirtualSensorMapping::collectHull(const SampleArrays& samples, std::vector<glm::vec2>& hull) const
+{
+    // Only angular sensors are ordered around the vehicle, so only they form the hull.
+    binOrderedOutline(std::span<const uint8_t>(samples.valid).first(m_angularSensorCount),
+                      std::span<const glm::vec2>(samples.position).first(m_angularSensorCount),
+                      m_vehicleCenter,
+                      hull);
+}
+
 void LidarVirtualSensorMapping::setVehicleContour(const std::vector<glm::vec2>& contour)
 {
     if (contour.empty())
@@ -107,23 +320,34 @@ void LidarVirtualSensorMapping::setVehicleContour(const std::vector<glm::vec2>&
     center /= static_cast<float>(contour.size());
 
     float maxDistanceSquared = 0.0F;
+    glm::vec2 contourMin = contour.front();
+    glm::vec2 contourMax = contour.front();
     for (const auto& point : contour)
     {
         const glm::vec2 offset = point - center;
         maxDistanceSquared = std::max(maxDistanceSquared, glm::dot(offset, offset));
+        contourMin = glm::min(contourMin, point);
+        contourMax = glm::max(contourMax, point);
     }
     const float radius = std::sqrt(maxDistanceSquared);
 
+    // The mask follows every contour change, even when the sensor layout below stays put.
+    m_contourMask.build(m_vehicleContour, center, radius);
+
     const glm::vec2 centerDelta = center - m_vehicleCenter;
     const bool centerChanged = glm::dot(centerDelta, centerDelta) > (kSensorTolerance * kSensorTolerance);
     const bool radiusChanged = std::fabs(radius - m_vehicleRadius) > kSensorTolerance;
-    if (!centerChanged && !radiusChanged)
+    const bool extentChanged = glm::length(contourMin - m_contourMin) > kSensorTolerance
+                               || glm::length(contourMax - m_contourMax) > kSensorTolerance;
+    if (!centerChanged && !radiusChanged && !extentChanged)
     {
         return;
     }
 
     m_vehicleCenter = center;
     m_vehicleRadius = radius;
+    m_contourMin = contourMin;
+    m_contourMax = contourMax;
     rebuild();
 }
 
@@ -142,80 +366,174 @@ const std::vector<glm::vec2>& LidarVirtualSensorMapping::nonGroundHull() const n
     return m_hullNonGround;
 }
 
-std::array<LidarVirtualSensorMapping::SensorSnapshot, LidarVirtualSensorMapping::kVirtualSensorCount>
-LidarVirtualSensorMapping::snapshots() const
+LidarVirtualSensorMapping::SensorArrays LidarVirtualSensorMapping::sensorArrays() const noexcept
 {
-    std::array<SensorSnapshot, kVirtualSensorCount> output{};
-    for (std::size_t i = 0; i < kVirtualSensorCount; ++i)
+    SensorArrays arrays;
+    arrays.reference = m_vehicleCenter;
+    arrays.isAngular = m_layout.isAngular;
+    arrays.lowerAngle = m_layout.lowerAngle;
+    arrays.upperAngle = m_layout.upperAngle;
+    arrays.wrapAround = m_layout.wrapAround;
+    arrays.orthMinLon = m_layout.orthMinLon;
+    arrays.orthMaxLon = m_layout.orthMaxLon;
+    arrays.orthSideSign = m_layout.orthSideSign;
+    arrays.orthMinLat = m_layout.orthMinLat;
+    arrays.orthMaxLat = m_layout.orthMaxLat;
+    arrays.valid = m_samples.nonGround.valid;
+    arrays.distanceSquared = m_samples.nonGround.distanceSquared;
+    arrays.position = m_samples.nonGround.position;
+    arrays.confidence = m_accumulator.confidence();
+    return arrays;
+}
+
+LidarVirtualSensorMapping::BandArrays LidarVirtualSensorMapping::bandArrays(std::size_t band) const noexcept
+{
+    BandArrays arrays;
+    if (band >= m_heightBands.size())
     {
-        const auto& definition = m_sensorDefinitions[i];
-        const auto& sample = m_sensorSamples[i];
-        output[i] = SensorSnapshot{
-            sample.valid,
-            definition.isAngular,
-            definition.reference,
-            definition.lowerAngle,
-            definition.upperAngle,
-            definition.wrapAround,
-            definition.orthMinX,
-            definition.orthMaxX,
-            definition.orthSideSign,
-            definition.orthMinY,
-            definition.orthMaxY,
-            sample.position,
-            sample.distanceSquared};
+        return arrays;
     }
+    const std::size_t count = sensorCount();
+    const std::size_t offset = band * count;
+    arrays.valid = std::span<const uint8_t>(m_samples.bands.valid).subspan(offset, count);
+    arrays.distanceSquared = std::span<const float>(m_samples.bands.distanceSquared).subspan(offset, count);
+    arrays.position = std::span<const glm::vec2>(m_samples.bands.position).subspan(offset, count);
+    return arrays;
+}
+
+std::vector<LidarVirtualSensorMapping::SensorSnapshot> LidarVirtualSensorMapping::snapshots() const
+{
+    std::vector<SensorSnapshot> output;
+    fillSnapshots(output);
     return output;
 }
 
+void LidarVirtualSensorMapping::fillSnapshots(std::vector<SensorSnapshot>& output) const
+{
+    const std::size_t count = sensorCount();
+    output.resize(count);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        output[i] = SensorSnapshot{
+            m_samples.nonGround.valid[i] != 0U,
+            m_layout.isAngular[i] != 0U,
+            m_vehicleCenter,
+            m_layout.lowerAngle[i],
+            m_layout.upperAngle[i],
+            m_layout.wrapAround[i] != 0U,
+            m_layout.orthMinLon[i],
+            m_layout.orthMaxLon[i],
+            m_layout.orthSideSign[i],
+            m_layout.orthMinLat[i],
+            m_layout.orthMaxLat[i],
+            m_samples.nonGround.position[i],
+            m_samples.nonGround.distanceSquared[i],
+            m_accumulator.confidence()[i]};
+    }
+}
+
 void LidarVirtualSensorMapping::rebuild()
 {
-    std::fill(m_sensorDefinitions.begin(), m_sensorDefinitions.end(), SensorDefinition{});
-    std::fill(m_sensorSamples.begin(), m_sensorSamples.end(), SensorSample{});
-    std::fill(m_sensorSamplesGround.begin(), m_sensorSamplesGround.end(), SensorSample{});
+    const std::size_t count = m_angularSensorCount;
+    m_layout.resize(count);
     m_hullNonGround.clear();
     m_hullGround.clear();
+    m_envelope.clear();
 
-    const float delta = glm::two_pi<float>() / static_cast<float>(kNumAngularSensors);
+    const float delta = glm::two_pi<float>() / static_cast<float>(m_angularSensorCount);
     float theta = 0.0F;
 
-    for (std::size_t index = 0; index < kNumAngularSensors; ++index)
+    for (std::size_t index = 0; index < m_angularSensorCount; ++index)
     {
         const float startAngle = normalizeAngle(theta);
         theta += delta;
         const float endAngle = normalizeAngle(theta);
 
-        SensorDefinition definition{};
-        definition.isAngular = true;
-        definition.reference = m_vehicleCenter;
-        definition.lowerAngle = startAngle;
-        definition.upperAngle = endAngle;
-        definition.wrapAround = endAngle < startAngle;
-        m_sensorDefinitions[index] = definition;
+        m_layout.isAngular[index] = 1U;
+        m_layout.lowerAngle[index] = startAngle;
+        m_layout.upperAngle[index] = endAngle;
+        m_layout.wrapAround[index] = endAngle < startAngle ? 1U : 0U;
     }
+
+    appendSlotSensors();
+    m_samples.reset(sensorCount(), m_heightBands.size());
+    m_accumulator.reset(sensorCount());
+    rebuildLookups();
+    publishFrame();
 }
 
-void LidarVirtualSensorMapping::resetSamples()
+void LidarVirtualSensorMapping::appendSlotSensors()
 {
-    for (auto& sample : m_sensorSamples)
+    const float length = m_contourMax.y - m_contourMin.y;
+    if (!m_slotSettings.enabled || length <= 0.0F)
     {
-        sample.valid = false;
-        sample.distanceSquared = std::numeric_limits<float>::max();
-        sample.position = glm::vec2(0.0F);
+        return;
     }
-    for (auto& sample : m_sensorSamplesGround)
+
+    const float width = std::min(m_slotSettings.width, length);
+    const float pitch = m_slotSettings.distance;
+    const std::size_t perSide =
+        std::min(static_cast<std::size_t>(std::ceil((length - width) / pitch - kSensorTolerance)) + 1U, kMaxSlotsPerSide);
+    const float sideExtent[2] = {m_contourMax.x - m_vehicleCenter.x, m_vehicleCenter.x - m_contourMin.x};
+    const float sideSign[2] = {1.0F, -1.0F};
+
+    const std::size_t first = sensorCount();
+    const std::size_t count = first + 2U * perSide;
+    const auto grow = [count](auto& values) { values.resize(count); };
+    grow(m_layout.isAngular);
+    grow(m_layout.lowerAngle);
+    grow(m_layout.upperAngle);
+    grow(m_layout.wrapAround);
+    grow(m_layout.orthMinLon);
+    grow(m_layout.orthMaxLon);
+    grow(m_layout.orthSideSign);
+    grow(m_layout.orthMinLat);
+    grow(m_layout.orthMaxLat);
+
+    for (std::size_t side = 0; side < 2U; ++side)
     {
-        sample.valid = false;
-        sample.distanceSquared = std::numeric_limits<float>::max();
-        sample.position = glm::vec2(0.0F);
+        for (std::size_t slot = 0; slot < perSide; ++slot)
+        {
+            const std::size_t index = first + side * perSide + slot;
+            const float start = std::min(m_contourMin.y + pitch * static_cast<float>(slot), m_contourMax.y - width);
+            m_layout.isAngular[index] = 0U;
+            m_layout.orthMinLon[index] = start;
+            m_layout.orthMaxLon[index] = start + width;
+            m_layout.orthSideSign[index] = sideSign[side];
+            m_layout.orthMinLat[index] = std::max(sideExtent[side], 0.0F);
+            m_layout.orthMaxLat[index] = std::max(sideExtent[side], 0.0F) + m_slotSettings.range;
+        }
+    }
+}
+
+void LidarVirtualSensorMapping::rebuildLookups()
+{
+    const float binWidth = glm::two_pi<float>() / static_cast<float>(m_angularSensorCount);
+    float edgeDrift = 0.0F;
+    std::vector<OrthogonalSlotLookup::Slot> slots[2];
+    for (std::size_t index = 0; index < sensorCount(); ++index)
+    {
+        if (m_layout.isAngular[index] == 0U)
+        {
+            const std::size_t side = m_layout.orthSideSign[index] > 0.0F ? 0U : 1U;
+            slots[side].push_back({m_layout.orthMinLon[index], m_layout.orthMaxLon[index], index});
+            continue;
+        }
+        const float idealEdge = binWidth * static_cast<float>(index);
+        edgeDrift = std::max(edgeDrift, std::fabs(m_layout.lowerAngle[index] - idealEdge));
     }
+
+    m_angularLookup.build(m_vehicleCenter, m_angularSensorCount, edgeDrift, kSensorTolerance);
+    const float cellSize = 0.5F * std::min(m_slotSettings.distance, m_slotSettings.width);
+    m_slotLookups[0].build(slots[0], cellSize);
+    m_slotLookups[1].build(slots[1], cellSize);
 }
 
-bool LidarVirtualSensorMapping::sensorContains(const SensorDefinition& sensor, const glm::vec2& point) const
+bool LidarVirtualSensorMapping::sensorContains(std::size_t sensorIndex, const glm::vec2& point) const
 {
-    if (sensor.isAngular)
+    if (m_layout.isAngular[sensorIndex] != 0U)
     {
-        const glm::vec2 relative = point - sensor.reference;
+        const glm::vec2 relative = point - m_vehicleCenter;
         const float radiusSquared = glm::dot(relative, relative);
         if (radiusSquared < kSensorTolerance)
         {
@@ -228,56 +546,36 @@ bool LidarVirtualSensorMapping::sensorContains(const SensorDefinition& sensor, c
             angle += glm::two_pi<float>();
         }
 
-        if (sensor.wrapAround)
+        const float lower = m_layout.lowerAngle[sensorIndex];
+        const float upper = m_layout.upperAngle[sensorIndex];
+        if (m_layout.wrapAround[sensorIndex] != 0U)
         {
-            return angle >= sensor.lowerAngle || angle <= sensor.upperAngle;
+            return angle >= lower || angle <= upper;
         }
-        return angle >= sensor.lowerAngle && angle <= sensor.upperAngle;
+        return angle >= lower && angle <= upper;
     }
 
-    if (sensor.orthSideSign > 0.0F && point.y < 0.0F)
-    {
-        return false;
-    }
-    if (sensor.orthSideSign < 0.0F && point.y > 0.0F)
+    const float lateral = (point.x - m_vehicleCenter.x) * m_layout.orthSideSign[sensorIndex];
+    if (lateral < m_layout.orthMinLat[sensorIndex] || lateral > m_layout.orthMaxLat[sensorIndex])
     {
         return false;
     }
+    return point.y >= m_layout.orthMinLon[sensorIndex] && point.y <= m_layout.orthMaxLon[sensorIndex];
+}
 
-    const float minY = std::min(sensor.orthMinY, sensor.orthMaxY);
-    const float maxY = std::max(sensor.orthMinY, sensor.orthMaxY);
-    if (point.y < minY || point.y > maxY)
+float LidarVirtualSensorMapping::sensorDistanceSquared(std::size_t sensorIndex, const glm::vec2& point) const
+{
+    if (m_layout.isAngular[sensorIndex] != 0U)
     {
-        return false;
+        return glm::dot(point, point);
     }
-
-    return point.x >= sensor.orthMinX && point.x <= sensor.orthMaxX;
+    const float lateral = point.x - m_vehicleCenter.x;
+    return lateral * lateral;
 }
 
 bool LidarVirtualSensorMapping::isInsideVehicleContour(const glm::vec2& point) const
 {
-    if (m_vehicleContour.size() < 3)
-    {
-        return false;
-    }
-
-    bool inside = false;
-    size_t count = m_vehicleContour.size();
-    size_t j = count - 1;
-    for (size_t i = 0; i < count; ++i)
-    {
-        const auto& a = m_vehicleContour[i];
-        const auto& b = m_vehicleContour[j];
-        const bool intersects = ((a.y > point.y) != (b.y > point.y)) &&
-            (point.x <
-             (b.x - a.x) * (point.y - a.y) / ((b.y - a.y) != 0.0F ? (b.y - a.y) : std::numeric_limits<float>::epsilon()) + a.x);
-        if (intersects)
-        {
-            inside = !inside;
-        }
-        j = i;
-    }
-    return inside;
+    return m_contourMask.contains(point);
 }
 
 float LidarVirtualSensorMapping::normalizeAngle(float angle)
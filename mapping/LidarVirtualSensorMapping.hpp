@@ -1,33 +1,100 @@
 #pragma once
 
+#include "mapping/ContourMask.hpp"
+#include "mapping/FreeSpaceAccumulator.hpp"
+#include "mapping/FreeSpaceHull.hpp"
+#include "mapping/SensorBinLookup.hpp"
+#include "mapping/SnapshotPublisher.hpp"
 #include "sensors/BaseLidarSensor.hpp"
 
 #include <glm/glm.hpp>
 #include <glm/gtc/constants.hpp>
 
-#include <array>
 #include <cstddef>
+#include <cstdint>
 #include <limits>
+#include <memory>
+#include <span>
 #include <vector>
 
+namespace lidar
+{
+class ThreadPool;
+}
+
 namespace mapping
 {
 class LidarVirtualSensorMapping
 {
 public:
-    static constexpr std::size_t kNumAngularSensors = 72U;
-    static constexpr std::size_t kVirtualSensorCount = kNumAngularSensors;
+    static constexpr std::size_t kDefaultAngularSensorCount = 72U;
+    static constexpr std::size_t kMinAngularSensorCount = 4U;
+    static constexpr std::size_t kMaxAngularSensorCount = 3600U;
+    /// Points per parallel mapping chunk. Chunk bounds are fixed, so results do not depend on
+    /// the number of workers.
+    static constexpr std::size_t kPointsPerChunk = 8192U;
+    static constexpr std::size_t kMaxSlotsPerSide = 512U;
+    static constexpr std::size_t kMaxHeightBands = 8U;
 
-    explicit LidarVirtualSensorMapping(float floorHeight = -1.8F);
+    /// Height band [minHeight, maxHeight) above the floor, e.g. curb, bumper or overhead
+    /// clearance. Bands may overlap.
+    struct HeightBand
+    {
+        float minHeight = 0.0F;
+        float maxHeight = 0.0F;
+    };
+
+    /// Orthogonal parking-slot sensors along both vehicle sides ([Fusion] section of the profile).
+    /// Slots are `width` long along the vehicle, start every `distance` metres from the rear of
+    /// the contour and measure lateral clearance up to `range` metres beyond the contour.
+    struct SlotSettings
+    {
+        bool enabled = false;
+        float distance = 0.5F;
+        float width = 0.9F;
+        float range = 10.0F;
+    };
+
+    explicit LidarVirtualSensorMapping(float floorHeight = -1.8F,
+                                       std::size_t angularSensorCount = kDefaultAngularSensorCount);
 
     void setFloorHeight(float floorHeight);
     void setSensorOffset(const glm::vec2& offset);
+    /// Number of uniform angular bins around the vehicle centre; clamped to the supported range.
+    void setAngularSensorCount(std::size_t count);
+    void setSlotSettings(const SlotSettings& settings);
+    /// At most kMaxHeightBands bands; empty bands are dropped.
+    void setHeightBands(const std::vector<HeightBand>& bands);
+    /// Optional multi-frame filtering of the non-ground samples; history resets on layout changes.
+    void setAccumulatorSettings(const FreeSpaceAccumulatorSettings& settings);
+    const FreeSpaceAccumulatorSettings& accumulatorSettings() const noexcept { return m_accumulator.settings(); }
+    /// Optional convex or concave envelope of the angular sensors' nearest obstacles, built on each
+    /// update while enabled. It encloses every return, so unlike hull() it is not free space.
+    void setEnvelopeEnabled(bool enabled);
+    bool envelopeEnabled() const noexcept { return m_envelopeEnabled; }
+    void setEnvelopeSettings(const FreeSpaceHullSettings& settings);
+    const FreeSpaceHullSettings& envelopeSettings() const noexcept { return m_envelopeBuilder.settings(); }
+    /// Moves the accumulator's history by the vehicle's motion since the last update. `motion` maps
+    /// previous positions to current ones, in the frame of the points passed to updatePoints.
+    /// Call it before the next updatePoints.
+    void compensateEgoMotion(const PlanarMotion& motion);
     void updatePoints(const lidar::BaseLidarSensor::PointCloud& points);
+    /// Large clouds are binned in parallel chunks when a pool is attached.
+    void setThreadPool(lidar::ThreadPool* pool) noexcept { m_threadPool = pool; }
     void setVehicleContour(const std::vector<glm::vec2>& contour);
 
+    std::size_t angularSensorCount() const noexcept { return m_angularSensorCount; }
+    std::size_t sensorCount() const noexcept { return m_layout.lowerAngle.size(); }
+    /// Slot sensors follow the angular sensors, starting at index angularSensorCount().
+    std::size_t slotSensorCount() const noexcept { return sensorCount() - m_angularSensorCount; }
+    const std::vector<HeightBand>& heightBands() const noexcept { return m_heightBands; }
+
+    /// Angular sensors' nearest returns in bin order, each one a vertex (see binOrderedOutline).
     const std::vector<glm::vec2>& hull() const noexcept;
     const std::vector<glm::vec2>& groundHull() const noexcept;
     const std::vector<glm::vec2>& nonGroundHull() const noexcept;
+    /// Empty while the envelope is disabled.
+    const std::vector<glm::vec2>& envelope() const noexcept { return m_envelope; }
 
     struct SensorSnapshot
     {
@@ -37,53 +104,145 @@ public:
         float lowerAngle = 0.0F;
         float upperAngle = 0.0F;
         bool wrapAround = false;
-        float orthMinX = 0.0F;
-        float orthMaxX = 0.0F;
+        // Orthogonal slots: longitudinal (y) extent, side of the centre line (sign of x - reference.x)
+        // and lateral distance band from the centre line.
+        float orthMinLon = 0.0F;
+        float orthMaxLon = 0.0F;
         float orthSideSign = 0.0F;
-        float orthMinY = 0.0F;
-        float orthMaxY = 0.0F;
+        float orthMinLat = 0.0F;
+        float orthMaxLat = 0.0F;
         glm::vec2 position = glm::vec2(0.0F);
+        /// Squared range for angular sensors, squared lateral distance for slots.
         float distanceSquared = std::numeric_limits<float>::max();
+        /// Share of recent frames with a return in this sensor (FreeSpaceAccumulator window).
+        float confidence = 0.0F;
+    };
+
+    /// Zero-copy view of the per-sensor arrays, indexed by sensor. Valid until the next
+    /// updatePoints or layout change.
+    struct SensorArrays
+    {
+        glm::vec2 reference = glm::vec2(0.0F);
+        std::span<const uint8_t> isAngular;
+        std::span<const float> lowerAngle;
+        std::span<const float> upperAngle;
+        std::span<const uint8_t> wrapAround;
+        std::span<const float> orthMinLon;
+        std::span<const float> orthMaxLon;
+        std::span<const float> orthSideSign;
+        std::span<const float> orthMinLat;
+        std::span<const float> orthMaxLat;
+        std::span<const uint8_t> valid;
+        std::span<const float> distanceSquared;
+        std::span<const glm::vec2> position;
+        std::span<const float> confidence;
+    };
+
+    /// Nearest obstacle per sensor within one height band, indexed like sensorArrays().
+    struct BandArrays
+    {
+        std::span<const uint8_t> valid;
+        std::span<const float> distanceSquared;
+        std::span<const glm::vec2> position;
+    };
+
+    /// Immutable result of one update, published once per updatePoints and layout change.
+    struct SensorFrame
+    {
+        uint64_t version = 0U;
+        std::vector<SensorSnapshot> sensors;
+        std::vector<glm::vec2> hull;
+        std::vector<glm::vec2> groundHull;
     };
+    using SharedSensorFrame = std::shared_ptr<const SensorFrame>;
 
-    std::array<SensorSnapshot, kVirtualSensorCount> snapshots() const;
+    SensorArrays sensorArrays() const noexcept;
+    BandArrays bandArrays(std::size_t band) const noexcept;
+    /// Copies every sensor into a snapshot; prefer latestFrame() for per-frame consumers.
+    std::vector<SensorSnapshot> snapshots() const;
+    /// Cheap handle to the latest published frame; safe to call and hold from any thread.
+    SharedSensorFrame latestFrame() const { return m_publisher.latest(); }
+    /// Changes whenever a new frame is published, so consumers can skip unchanged frames.
+    uint64_t frameVersion() const noexcept { return m_publisher.version(); }
 
 private:
-    struct SensorDefinition
+    // Structure-of-arrays sensor layout; angular sensor i covers bin i of m_angularLookup.
+    struct SensorLayout
     {
-        bool isAngular = false;
-        glm::vec2 reference = glm::vec2(0.0F);
-        float lowerAngle = 0.0F;
-        float upperAngle = 0.0F;
-        bool wrapAround = false;
-        float orthMinX = 0.0F;
-        float orthMaxX = 0.0F;
-        float orthSideSign = 0.0F;
-        float orthMinY = 0.0F;
-        float orthMaxY = 0.0F;
+        std::vector<uint8_t> isAngular;
+        std::vector<float> lowerAngle;
+        std::vector<float> upperAngle;
+        std::vector<uint8_t> wrapAround;
+        std::vector<float> orthMinLon;
+        std::vector<float> orthMaxLon;
+        std::vector<float> orthSideSign;
+        std::vector<float> orthMinLat;
+        std::vector<float> orthMaxLat;
+
+        void resize(std::size_t count);
     };
 
-    struct SensorSample
+    struct SampleArrays
     {
-        bool valid = false;
-        float distanceSquared = std::numeric_limits<float>::max();
-        glm::vec2 position = glm::vec2(0.0F);
+        std::vector<uint8_t> valid;
+        std::vector<float> distanceSquared;
+        std::vector<glm::vec2> position;
+
+        void reset(std::size_t count);
+        /// Keeps the nearer sample per sensor; ties keep the existing one.
+        void mergeFrom(const SampleArrays& other);
+    };
+
+    struct SampleSet
+    {
+        SampleArrays nonGround;
+        SampleArrays ground;
+        /// [band][sensor] table, band-major.
+        SampleArrays bands;
+
+        void reset(std::size_t sensorCount, std::size_t bandCount);
+        void mergeFrom(const SampleSet& other);
     };
 
     void rebuild();
-    void resetSamples();
+    void appendSlotSensors();
+    void rebuildLookups();
+    void accumulatePoints(const lidar::BaseLidarSensor::PointCloud& points,
+                          std::size_t first,
+                          std::size_t last,
+                          SampleSet& samples) const;
     float normalizeAngle(float angle);
-    bool sensorContains(const SensorDefinition& sensor, const glm::vec2& point) const;
+    bool sensorContains(std::size_t sensorIndex, const glm::vec2& point) const;
+    /// Range key of `point` for the sensor: squared range, or squared lateral distance for slots.
+    float sensorDistanceSquared(std::size_t sensorIndex, const glm::vec2& point) const;
     bool isInsideVehicleContour(const glm::vec2& point) const;
+    void collectHull(const SampleArrays& samples, std::vector<glm::vec2>& hull) const;
+    void fillSnapshots(std::vector<SensorSnapshot>& output) const;
+    void publishFrame();
 
-    std::array<SensorDefinition, kVirtualSensorCount> m_sensorDefinitions{};
-    std::array<SensorSample, kVirtualSensorCount> m_sensorSamples{};
-    std::array<SensorSample, kVirtualSensorCount> m_sensorSamplesGround{};
+    std::size_t m_angularSensorCount;
+    SensorLayout m_layout;
+    std::vector<HeightBand> m_heightBands;
+    SampleSet m_samples;
+    std::vector<SampleSet> m_chunkSamples;
+    FreeSpaceAccumulator m_accumulator;
+    SnapshotPublisher<SensorFrame> m_publisher;
+    lidar::ThreadPool* m_threadPool = nullptr;
+    AngularBinLookup m_angularLookup;
+    // Per side of the centre line: index 0 for x above it, 1 for x below.
+    OrthogonalSlotLookup m_slotLookups[2];
+    SlotSettings m_slotSettings;
+    bool m_envelopeEnabled = false;
+    FreeSpaceHull m_envelopeBuilder;
+    std::vector<glm::vec2> m_envelope;
     std::vector<glm::vec2> m_hullNonGround;
     std::vector<glm::vec2> m_hullGround;
     std::vector<glm::vec2> m_vehicleContour;
+    ContourMask m_contourMask;
     glm::vec2 m_vehicleCenter = glm::vec2(0.0F);
     float m_vehicleRadius = 0.0F;
+    glm::vec2 m_contourMin = glm::vec2(0.0F);
+    glm::vec2 m_contourMax = glm::vec2(0.0F);
     float m_floorHeight;
     glm::vec2 m_sensorOffset = glm::vec2(0.0F);
 };
@@ -0,0 +1,264 @@
+#include "mapping/OccupancyGrid.hpp"
+#include "mapping/SensorBinLookup.hpp"
+
+#include <glm/gtc/constants.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+
+namespace mapping
+{
+
+namespace
+{
+constexpr int kMaxCellsPerSide = 4096;
+
+int floorToCell(float value, float inverseResolution)
+{
+    return static_cast<int>(std::floor(value * inverseResolution));
+}
+
+} // namespace
+
+OccupancyGrid::OccupancyGrid(const OccupancyGridSettings& settings)
+{
+    configure(settings);
+}
+
+void OccupancyGrid::configure(const OccupancyGridSettings& settings)
+{
+    m_settings = settings;
+    m_settings.resolution = std::max(settings.resolution, 0.01F);
+    m_settings.extent = std::max(settings.extent, m_settings.resolution);
+    m_settings.minLogOdds = std::min(settings.minLogOdds, 0.0F);
+    m_settings.maxLogOdds = std::max(settings.maxLogOdds, 0.0F);
+    m_inverseResolution = 1.0F / m_settings.resolution;
+
+    // A power-of-two side turns the modular addressing into masks.
+    const int requested = static_cast<int>(std::ceil(m_settings.extent * m_inverseResolution));
+    m_cellsPerSide = kTileSize;
+    while (m_cellsPerSide < requested && m_cellsPerSide < kMaxCellsPerSide)
+    {
+        m_cellsPerSide *= 2;
+    }
+    m_tilesPerSide = m_cellsPerSide / kTileSize;
+    // Neighbouring miss rays stay within one cell of each other out to the window corner.
+    const float windowRadius = static_cast<float>(m_cellsPerSide) * 0.70710678F;
+    m_rayBinCount = static_cast<std::size_t>(std::ceil(glm::two_pi<float>() * windowRadius));
+
+    const auto cellCount = static_cast<std::size_t>(m_cellsPerSide) * static_cast<std::size_t>(m_cellsPerSide);
+    m_logOdds.assign(cellCount, 0.0F);
+    m_updates.assign(cellCount, kNoUpdate);
+    m_originCell = glm::ivec2(-m_cellsPerSide / 2);
+}
+
+void OccupancyGrid::clear()
+{
+    std::fill(m_logOdds.begin(), m_logOdds.end(), 0.0F);
+}
+
+glm::vec2 OccupancyGrid::windowOrigin() const
+{
+    return glm::vec2(static_cast<float>(m_originCell.x), static_cast<float>(m_originCell.y)) * m_settings.resolution;
+}
+
+std::size_t OccupancyGrid::storageIndex(int cellX, int cellY) const noexcept
+{
+    const int column = cellX & (m_cellsPerSide - 1);
+    const int row = cellY & (m_cellsPerSide - 1);
+    const int tile = (row >> kTileShift) * m_tilesPerSide + (column >> kTileShift);
+    const int inner = ((row & (kTileSize - 1)) << kTileShift) | (column & (kTileSize - 1));
+    return static_cast<std::size_t>(tile) * (kTileSize * kTileSize) + static_cast<std::size_t>(inner);
+}
+
+bool OccupancyGrid::inWindow(int cellX, int cellY) const noexcept
+{
+    const int column = cellX - m_originCell.x;
+    const int row = cellY - m_originCell.y;
+    return column >= 0 && column < m_cellsPerSide && row >= 0 && row < m_cellsPerSide;
+}
+
+void OccupancyGrid::recenter(const glm::vec2& center)
+{
+    const glm::ivec2 origin(floorToCell(center.x, m_inverseResolution) - m_cellsPerSide / 2,
+                            floorToCell(center.y, m_inverseResolution) - m_cellsPerSide / 2);
+    const glm::ivec2 shift = origin - m_originCell;
+    if (shift == glm::ivec2(0))
+    {
+        return;
+    }
+
+    if (std::abs(shift.x) >= m_cellsPerSide || std::abs(shift.y) >= m_cellsPerSide)
+    {
+        clear();
+        m_originCell = origin;
+        return;
+    }
+
+    // Cells that scroll out share storage with the ones scrolling in; reset those to unknown.
+    const int firstColumn = shift.x > 0 ? m_originCell.x + m_cellsPerSide : origin.x;
+    for (int column = 0; column < std::abs(shift.x); ++column)
+    {
+        clearColumn(firstColumn + column);
+    }
+    const int firstRow = shift.y > 0 ? m_originCell.y + m_cellsPerSide : origin.y;
+    for (int row = 0; row < std::abs(shift.y); ++row)
+    {
+        clearRow(firstRow + row);
+    }
+    m_originCell = origin;
+}
+
+void OccupancyGrid::clearColumn(int cellX)
+{
+    for (int row = 0; row < m_cellsPerSide; ++row)
+    {
+        m_logOdds[storageIndex(cellX, row)] = 0.0F;
+    }
+}
+
+void OccupancyGrid::clearRow(int cellY)
+{
+    for (int column = 0; column < m_cellsPerSide; ++column)
+    {
+        m_logOdds[storageIndex(column, cellY)] = 0.0F;
+    }
+}
+
+void OccupancyGrid::integrate(const lidar::BaseLidarSensor::PointCloud& points, const glm::vec2& sensorOrigin)
+{
+    // Hits are marked per return. Misses are cast once per azimuth bin, to the bin's farthest
+    // return, which covers the shorter rays in that bin.
+    m_rayEnds.assign(m_rayBinCount, RayEnd{});
+    const float binsPerRadian = static_cast<float>(m_rayBinCount) / glm::two_pi<float>();
+    for (const auto& point : points)
+    {
+        const glm::vec2 end(point.x, point.y);
+        const int cellX = floorToCell(end.x, m_inverseResolution);
+        const int cellY = floorToCell(end.y, m_inverseResolution);
+        if (inWindow(cellX, cellY))
+        {
+            m_updates[storageIndex(cellX, cellY)] |= kHit;
+        }
+
+        const glm::vec2 relative = end - sensorOrigin;
+        const float angle = AngularBinLookup::fastAtan2(relative.y, relative.x) + glm::pi<float>();
+        const auto bin = std::min(static_cast<std::size_t>(angle * binsPerRadian), m_rayBinCount - 1U);
+        const float distanceSquared = glm::dot(relative, relative);
+        if (distanceSquared > m_rayEnds[bin].distanceSquared)
+        {
+            m_rayEnds[bin] = RayEnd{distanceSquared, end};
+        }
+    }
+    for (const auto& rayEnd : m_rayEnds)
+    {
+        if (rayEnd.distanceSquared >= 0.0F)
+        {
+            castRay(sensorOrigin, rayEnd.end);
+        }
+    }
+
+    const float hit = m_settings.hitLogOdds;
+    const float miss = m_settings.missLogOdds;
+    const float lower = m_settings.minLogOdds;
+    const float upper = m_settings.maxLogOdds;
+    float* values = m_logOdds.data();
+    const uint8_t* updates = m_updates.data();
+    const std::size_t count = m_logOdds.size();
+    // Selects and min/max only, so the compiler can vectorize the whole pass.
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        const float delta = (updates[i] & kHit) != 0U ? hit : ((updates[i] & kMiss) != 0U ? miss : 0.0F);
+        values[i] = std::min(std::max(values[i] + delta, lower), upper);
+    }
+    std::fill(m_updates.begin(), m_updates.end(), kNoUpdate);
+}
+
+void OccupancyGrid::castRay(const glm::vec2& from, const glm::vec2& to)
+{
+    // Clip the segment to the window (Liang-Barsky) so traversal never leaves it.
+    const glm::vec2 windowMin = windowOrigin();
+    const glm::vec2 windowMax = windowMin + glm::vec2(static_cast<float>(m_cellsPerSide) * m_settings.resolution);
+    const glm::vec2 delta = to - from;
+    float enter = 0.0F;
+    float exit = 1.0F;
+    for (int axis = 0; axis < 2; ++axis)
+    {
+        const float start = axis == 0 ? from.x : from.y;
+        const float direction = axis == 0 ? delta.x : delta.y;
+        const float low = axis == 0 ? windowMin.x : windowMin.y;
+        const float high = axis == 0 ? windowMax.x : windowMax.y;
+        if (std::fabs(direction) < 1e-9F)
+        {
+            if (start < low || start >= high)
+            {
+                return;
+            }
+            continue;
+        }
+        float t0 = (low - start) / direction;
+        float t1 = (high - start) / direction;
+        if (t0 > t1)
+        {
+            std::swap(t0, t1);
+        }
+        enter = std::max(enter, t0);
+        exit = std::min(exit, t1);
+        if (enter > exit)
+        {
+            return;
+        }
+    }
+
+    const bool endsInside = exit >= 1.0F;
+    const glm::vec2 start = from + delta * enter;
+    const glm::vec2 end = from + delta * exit;
+    const int lastColumn = m_originCell.x + m_cellsPerSide - 1;
+    const int lastRow = m_originCell.y + m_cellsPerSide - 1;
+    int cellX = std::clamp(floorToCell(start.x, m_inverseResolution), m_originCell.x, lastColumn);
+    int cellY = std::clamp(floorToCell(start.y, m_inverseResolution), m_originCell.y, lastRow);
+    const int endX = std::clamp(floorToCell(end.x, m_inverseResolution), m_originCell.x, lastColumn);
+    const int endY = std::clamp(floorToCell(end.y, m_inverseResolution), m_originCell.y, lastRow);
+
+    // Amanatides-Woo traversal; the step budget guards against float drift at cell corners.
+    const int stepX = delta.x > 0.0F ? 1 : -1;
+    const int stepY = delta.y > 0.0F ? 1 : -1;
+    constexpr float kInfinity = std::numeric_limits<float>::max();
+    const float resolution = m_settings.resolution;
+    const float deltaTX = delta.x != 0.0F ? resolution / std::fabs(delta.x) : kInfinity;
+    const float deltaTY = delta.y != 0.0F ? resolution / std::fabs(delta.y) : kInfinity;
+    const float boundaryX = static_cast<float>(stepX > 0 ? cellX + 1 : cellX) * resolution;
+    const float boundaryY = static_cast<float>(stepY > 0 ? cellY + 1 : cellY) * resolution;
+    float maxTX = delta.x != 0.0F ? (boundaryX - start.x) / delta.x : kInfinity;
+    float maxTY = delta.y != 0.0F ? (boundaryY - start.y) / delta.y : kInfinity;
+
+    int steps = std::abs(endX - cellX) + std::abs(endY - cellY);
+    uint8_t* updates = m_updates.data();
+    while (steps-- > 0 && (cellX != endX || cellY != endY))
+    {
+        updates[storageIndex(cellX, cellY)] |= kMiss;
+        // Branch-free step: the axis choice is close to random across rays.
+        const bool alongX = maxTX < maxTY;
+        maxTX += alongX ? deltaTX : 0.0F;
+        maxTY += alongX ? 0.0F : deltaTY;
+        cellX += alongX ? stepX : 0;
+        cellY += alongX ? 0 : stepY;
+    }
+
+    updates[storageIndex(endX, endY)] |= endsInside ? kHit : kMiss;
+}
+
+float OccupancyGrid::logOdds(const glm::vec2& position) const
+{
+    const int cellX = floorToCell(position.x, m_inverseResolution);
+    const int cellY = floorToCell(position.y, m_inverseResolution);
+    if (!inWindow(cellX, cellY))
+    {
+        return 0.0F;
+    }
+    return m_logOdds[storageIndex(cellX, cellY)];
+}
+
+} // namespace mapping
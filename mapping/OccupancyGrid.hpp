@@ -0,0 +1,112 @@
+#pragma once
+
+#include "sensors/BaseLidarSensor.hpp"
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace mapping
+{
+
+struct OccupancyGridSettings
+{
+    float resolution = 0.1F;
+    /// Minimum side length of the square window centred on the vehicle [m].
+    float extent = 40.0F;
+    float hitLogOdds = 0.85F;
+    float missLogOdds = -0.4F;
+    float minLogOdds = -2.0F;
+    float maxLogOdds = 3.5F;
+    float occupiedLogOdds = 0.85F;
+};
+
+/// Ego-centred rolling occupancy grid with log-odds updates. The window side is rounded up to a
+/// power of two cells. Cells are stored in 8x8 tiles and addressed modulo the window size, so
+/// recentring only clears the rows and columns that scroll in. Each frame marks returns as hits
+/// and ray-casts misses from the sensor origin into a hit/miss mask (a hit wins over misses).
+/// Misses are cast once per azimuth bin, to the farthest return in that bin, with bins narrow
+/// enough that this stays within a cell of per-return casting. The mask is then applied to the
+/// whole grid in one branch-free add-and-clamp pass. A cell therefore changes at most once per
+/// frame, however many rays cross it.
+class OccupancyGrid
+{
+public:
+    static constexpr int kTileShift = 3;
+    static constexpr int kTileSize = 1 << kTileShift;
+
+    explicit OccupancyGrid(const OccupancyGridSettings& settings = {});
+
+    void configure(const OccupancyGridSettings& settings);
+    const OccupancyGridSettings& settings() const noexcept { return m_settings; }
+    void clear();
+
+    /// Scrolls the window so it stays centred on `center` (world frame).
+    void recenter(const glm::vec2& center);
+    /// Integrates one scan of obstacle returns seen from `sensorOrigin`.
+    void integrate(const lidar::BaseLidarSensor::PointCloud& points, const glm::vec2& sensorOrigin);
+
+    /// Log-odds at `position`; 0 (unknown) outside the window.
+    float logOdds(const glm::vec2& position) const;
+    bool occupied(const glm::vec2& position) const { return logOdds(position) >= m_settings.occupiedLogOdds; }
+
+    int cellsPerSide() const noexcept { return m_cellsPerSide; }
+    /// World position of the window's lower-left corner.
+    glm::vec2 windowOrigin() const;
+    /// Calls `visit(cellCenter, logOdds)` for every cell at or above the occupied threshold.
+    template <typename Visitor>
+    void forEachOccupied(Visitor&& visit) const
+    {
+        for (int row = 0; row < m_cellsPerSide; ++row)
+        {
+            for (int column = 0; column < m_cellsPerSide; ++column)
+            {
+                const int cellX = m_originCell.x + column;
+                const int cellY = m_originCell.y + row;
+                const float value = m_logOdds[storageIndex(cellX, cellY)];
+                if (value >= m_settings.occupiedLogOdds)
+                {
+                    visit((glm::vec2(static_cast<float>(cellX), static_cast<float>(cellY)) + 0.5F)
+                              * m_settings.resolution,
+                          value);
+                }
+            }
+        }
+    }
+
+private:
+    // Bit flags, so rays can OR their marks without reading them first.
+    enum CellUpdate : uint8_t
+    {
+        kNoUpdate = 0,
+        kMiss = 1,
+        kHit = 2,
+    };
+
+    struct RayEnd
+    {
+        float distanceSquared = -1.0F;
+        glm::vec2 end = glm::vec2(0.0F);
+    };
+
+    std::size_t storageIndex(int cellX, int cellY) const noexcept;
+    bool inWindow(int cellX, int cellY) const noexcept;
+    void castRay(const glm::vec2& from, const glm::vec2& to);
+    void clearColumn(int cellX);
+    void clearRow(int cellY);
+
+    OccupancyGridSettings m_settings;
+    int m_cellsPerSide = 0;
+    int m_tilesPerSide = 0;
+    float m_inverseResolution = 0.0F;
+    /// World cell index of the window's lower-left cell.
+    glm::ivec2 m_originCell = glm::ivec2(0);
+    std::vector<float> m_logOdds;
+    std::vector<uint8_t> m_updates;
+    std::size_t m_rayBinCount = 1U;
+    std::vector<RayEnd> m_rayEnds;
+};
+
+} // namespace mapping
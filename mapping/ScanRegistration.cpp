@@ -0,0 +1,209 @@
+#include "mapping/ScanRegistration.hpp"
+
+#include <Eigen/Cholesky>
+#include <Eigen/Eigenvalues>
+
+#include <algorithm>
+#include <cmath>
+
+namespace mapping
+{
+
+namespace
+{
+Eigen::Vector3f toVector(const lidar::LidarPoint& point)
+{
+    return {point.x, point.y, point.z};
+}
+} // namespace
+
+ScanRegistration::ScanRegistration(const ScanRegistrationSettings& settings)
+{
+    configure(settings);
+}
+
+void ScanRegistration::configure(const ScanRegistrationSettings& settings)
+{
+    m_settings = settings;
+    m_settings.normalNeighbours = std::max<std::size_t>(settings.normalNeighbours, 3U);
+    m_settings.maxIterations = std::max<std::size_t>(settings.maxIterations, 1U);
+    m_targetFilter.configure({settings.targetLeafSize, VoxelReduction::Centroid, VoxelGridMethod::Hash});
+    m_sourceFilter.configure({settings.sourceLeafSize, VoxelReduction::Centroid, VoxelGridMethod::Hash});
+    reset();
+}
+
+void ScanRegistration::setThreadPool(lidar::ThreadPool* pool) noexcept
+{
+    m_threadPool = pool;
+    m_targetIndex.setThreadPool(pool);
+}
+
+void ScanRegistration::reset()
+{
+    m_pose = Eigen::Isometry3f::Identity();
+    m_lastMotion = Eigen::Isometry3f::Identity();
+    m_hasTarget = false;
+}
+
+bool ScanRegistration::registerScan(const lidar::BaseLidarSensor::PointCloud& scan, RegistrationResult& result)
+{
+    result = RegistrationResult{};
+    m_targetFilter.filter(scan, m_nextTarget);
+    if (!m_hasTarget)
+    {
+        m_target.swap(m_nextTarget);
+        prepareTarget();
+        m_hasTarget = true;
+        return false;
+    }
+
+    m_sourceFilter.filter(scan, m_source);
+    // Constant-velocity guess: the vehicle rarely changes its motion much within one revolution.
+    Eigen::Isometry3f transform = m_lastMotion;
+    NormalEquations equations;
+    for (std::size_t iteration = 0; iteration < m_settings.maxIterations; ++iteration)
+    {
+        equations = lidar::parallelReduce(
+            m_threadPool,
+            0U,
+            m_source.size(),
+            kCorrespondenceGrain,
+            NormalEquations{},
+            [&](std::size_t begin, std::size_t end) { return accumulate(transform, begin, end); },
+            [](NormalEquations sum, NormalEquations part) {
+                sum.hessian += part.hessian;
+                sum.gradient += part.gradient;
+                sum.squaredError += part.squaredError;
+                sum.count += part.count;
+                return sum;
+            });
+        result.iterations = iteration + 1U;
+        if (equations.count < kMinCorrespondences)
+        {
+            break;
+        }
+
+        // A little damping keeps directions the scene does not constrain (a long corridor) at zero.
+        const Eigen::Matrix<double, 6, 6> damped =
+            equations.hessian + Eigen::Matrix<double, 6, 6>::Identity() * (1e-6 * equations.hessian.trace());
+        const Eigen::Matrix<double, 6, 1> step = damped.ldlt().solve(-equations.gradient);
+        const Eigen::Vector3f rotation = step.head<3>().cast<float>();
+        const Eigen::Vector3f translation = step.tail<3>().cast<float>();
+
+        Eigen::Isometry3f update = Eigen::Isometry3f::Identity();
+        const float angle = rotation.norm();
+        if (angle > 0.0F)
+        {
+            update.linear() = Eigen::AngleAxisf(angle, rotation / angle).toRotationMatrix();
+        }
+        update.translation() = translation;
+        transform = update * transform;
+
+        if (angle < m_settings.rotationEpsilon && translation.norm() < m_settings.translationEpsilon)
+        {
+            result.converged = true;
+            break;
+        }
+    }
+
+    result.correspondences = equations.count;
+    const bool registered = equations.count >= kMinCorrespondences;
+    if (registered)
+    {
+        result.rmse = static_cast<float>(std::sqrt(equations.squaredError / static_cast<double>(equations.count)));
+        // Keep the rotation orthonormal after many small updates.
+        transform.linear() = Eigen::Quaternionf(transform.rotation()).normalized().toRotationMatrix();
+    }
+    else
+    {
+        transform = m_lastMotion;
+        result.converged = false;
+    }
+    result.motion = transform;
+    m_lastMotion = transform;
+    m_pose = m_pose * transform;
+
+    m_target.swap(m_nextTarget);
+    prepareTarget();
+    return registered;
+}
+
+ScanRegistration::NormalEquations ScanRegistration::accumulate(const Eigen::Isometry3f& transform,
+                                                               std::size_t begin,
+                                                               std::size_t end) const
+{
+    const float maxDistanceSquared = m_settings.maxCorrespondenceDistance * m_settings.maxCorrespondenceDistance;
+    NormalEquations equations;
+    for (std::size_t i = begin; i < end; ++i)
+    {
+        const Eigen::Vector3f moved = transform * toVector(m_source[i]);
+        KdNeighbour match;
+        if (!m_targetIndex.nearest(glm::vec3(moved.x(), moved.y(), moved.z()), match)
+            || match.distanceSquared > maxDistanceSquared)
+        {
+            continue;
+        }
+        const Eigen::Vector3f& normal = m_targetNormals[match.index];
+        if (normal.isZero())
+        {
+            continue;
+        }
+
+        const float residual = normal.dot(moved - toVector(m_target[match.index]));
+        const float magnitude = std::fabs(residual);
+        const double weight = magnitude <= m_settings.huberThreshold ? 1.0 : m_settings.huberThreshold / magnitude;
+        // Derivative of the residual for a small rotation and translation applied after `transform`.
+        Eigen::Matrix<double, 6, 1> jacobian;
+        jacobian.head<3>() = moved.cross(normal).cast<double>();
+        jacobian.tail<3>() = normal.cast<double>();
+        equations.hessian.noalias() += weight * jacobian * jacobian.transpose();
+        equations.gradient.noalias() += weight * static_cast<double>(residual) * jacobian;
+        equations.squaredError += static_cast<double>(residual) * residual;
+        ++equations.count;
+    }
+    return equations;
+}
+
+void ScanRegistration::prepareTarget()
+{
+    m_targetIndex.build(m_target);
+    const std::size_t k = m_settings.normalNeighbours;
+    m_targetIndex.nearestKBatch(m_target, k, m_neighbours);
+    m_targetNormals.resize(m_target.size());
+
+    lidar::parallelFor(m_threadPool, 0U, m_target.size(), kNormalGrain, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i)
+        {
+            const KdNeighbour* neighbours = m_neighbours.data() + i * k;
+            Eigen::Vector3f mean = Eigen::Vector3f::Zero();
+            std::size_t count = 0U;
+            for (; count < k && neighbours[count].index != KdTree::kInvalidIndex; ++count)
+            {
+                mean += toVector(m_target[neighbours[count].index]);
+            }
+            m_targetNormals[i].setZero();
+            if (count < 3U)
+            {
+                continue;
+            }
+            mean /= static_cast<float>(count);
+
+            Eigen::Matrix3f covariance = Eigen::Matrix3f::Zero();
+            for (std::size_t j = 0; j < count; ++j)
+            {
+                const Eigen::Vector3f offset = toVector(m_target[neighbours[j].index]) - mean;
+                covariance.noalias() += offset * offset.transpose();
+            }
+            Eigen::SelfAdjointEigenSolver<Eigen::Matrix3f> solver;
+            solver.computeDirect(covariance);
+            const Eigen::Vector3f& eigenvalues = solver.eigenvalues();
+            const float total = eigenvalues.sum();
+            if (total > 0.0F && eigenvalues(0) <= m_settings.maxPlaneVariation * total)
+            {
+                m_targetNormals[i] = solver.eigenvectors().col(0);
+            }
+        }
+    });
+}
+
+} // namespace mapping
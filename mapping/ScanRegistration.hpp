@@ -0,0 +1,116 @@
+#pragma once
+
+#include "engine/ThreadPool.hpp"
+#include "mapping/KdTree.hpp"
+#include "mapping/VoxelGridFilter.hpp"
+#include "sensors/BaseLidarSensor.hpp"
+
+#include <Eigen/Geometry>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace mapping
+{
+
+struct ScanRegistrationSettings
+{
+    /// Voxel size of the previous scan, which the next scan is matched against [m].
+    float targetLeafSize = 0.4F;
+    /// Voxel size of the scan being registered; coarser than the target to keep iterations cheap [m].
+    float sourceLeafSize = 1.0F;
+    /// Neighbours used to fit the target's local planes.
+    std::size_t normalNeighbours = 8U;
+    /// Neighbourhoods whose smallest eigenvalue exceeds this share of the sum have no usable plane.
+    float maxPlaneVariation = 0.05F;
+    float maxCorrespondenceDistance = 1.0F;
+    /// Residuals beyond this are down-weighted (Huber) [m].
+    float huberThreshold = 0.1F;
+    std::size_t maxIterations = 30U;
+    /// Registration stops once an update moves less than both thresholds [m], [rad].
+    float translationEpsilon = 1e-3F;
+    float rotationEpsilon = 1e-4F;
+};
+
+struct RegistrationResult
+{
+    /// Maps the registered scan into the frame of the previous scan.
+    Eigen::Isometry3f motion = Eigen::Isometry3f::Identity();
+    std::size_t iterations = 0U;
+    std::size_t correspondences = 0U;
+    /// Root mean square point-to-plane distance over the final correspondences [m].
+    float rmse = 0.0F;
+    bool converged = false;
+};
+
+/// Odometry of one scan, as handed to the consumers of the registration.
+struct OdometryPose
+{
+    /// Timestamp of the registered scan.
+    uint64_t timestamp_us = 0U;
+    /// Maps the scan's frame into the odometry frame, which is the frame of the first scan.
+    Eigen::Isometry3f scanToOdometry = Eigen::Isometry3f::Identity();
+    /// False while odometry is off or has just been reset.
+    bool valid = false;
+};
+
+/// Scan-to-scan lidar odometry with point-to-plane ICP. Every scan is voxel-downsampled. The
+/// previous scan stays indexed in a KdTree, with a plane normal fitted per point. Each iteration
+/// pairs the source points with their nearest target points and sums the Gauss-Newton normal
+/// equations in fixed chunks on the pool. The sums are combined in chunk order, so the result does
+/// not depend on the worker count. Eigen solves the 6x6 system.
+class ScanRegistration
+{
+public:
+    static constexpr std::size_t kCorrespondenceGrain = 512U;
+    static constexpr std::size_t kNormalGrain = 1024U;
+    /// Fewer correspondences than this leave the motion at the constant-velocity guess.
+    static constexpr std::size_t kMinCorrespondences = 50U;
+
+    explicit ScanRegistration(const ScanRegistrationSettings& settings = {});
+
+    void configure(const ScanRegistrationSettings& settings);
+    const ScanRegistrationSettings& settings() const noexcept { return m_settings; }
+    void setThreadPool(lidar::ThreadPool* pool) noexcept;
+
+    /// Registers `scan` against the previous scan, starting from the last motion, and keeps it as
+    /// the next target. Returns false for the first scan after a reset, and when too few
+    /// correspondences were found; the pose then advances by the guess.
+    bool registerScan(const lidar::BaseLidarSensor::PointCloud& scan, RegistrationResult& result);
+
+    /// Pose of the latest scan in the frame of the first one.
+    const Eigen::Isometry3f& pose() const noexcept { return m_pose; }
+    void reset();
+
+private:
+    struct NormalEquations
+    {
+        Eigen::Matrix<double, 6, 6> hessian = Eigen::Matrix<double, 6, 6>::Zero();
+        Eigen::Matrix<double, 6, 1> gradient = Eigen::Matrix<double, 6, 1>::Zero();
+        double squaredError = 0.0;
+        std::size_t count = 0U;
+    };
+
+    NormalEquations accumulate(const Eigen::Isometry3f& transform, std::size_t begin, std::size_t end) const;
+    void prepareTarget();
+
+    ScanRegistrationSettings m_settings;
+    lidar::ThreadPool* m_threadPool = nullptr;
+    VoxelGridFilter m_targetFilter;
+    VoxelGridFilter m_sourceFilter;
+
+    lidar::BaseLidarSensor::PointCloud m_source;
+    lidar::BaseLidarSensor::PointCloud m_target;
+    lidar::BaseLidarSensor::PointCloud m_nextTarget;
+    KdTree m_targetIndex;
+    /// Unit plane normal per target point; zero where the neighbourhood is not planar.
+    std::vector<Eigen::Vector3f> m_targetNormals;
+    std::vector<KdNeighbour> m_neighbours;
+
+    Eigen::Isometry3f m_pose = Eigen::Isometry3f::Identity();
+    Eigen::Isometry3f m_lastMotion = Eigen::Isometry3f::Identity();
+    bool m_hasTarget = false;
+};
+
+} // namespace mapping
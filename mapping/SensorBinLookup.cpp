@@ -0,0 +1,147 @@
+#include "mapping/SensorBinLookup.hpp"
+
+#include <glm/gtc/constants.hpp>
+
+#include <cmath>
+#include <limits>
+
+namespace mapping
+{
+
+namespace
+{
+// Covers float rounding of the scaled angle and of the 2*pi wrap in the exact test.
+constexpr float kGuardBandMargin = 1.0e-5F;
+} // namespace
+
+void AngularBinLookup::build(const glm::vec2& reference, std::size_t binCount, float edgeDrift, float allBinsRadiusSquared)
+{
+    m_reference = reference;
+    m_binCount = binCount;
+    m_binWidth = binCount > 0U ? glm::two_pi<float>() / static_cast<float>(binCount) : 0.0F;
+    m_inverseBinWidth = binCount > 0U ? 1.0F / m_binWidth : 0.0F;
+    m_guardBand = kFastAtan2MaxError + edgeDrift + kGuardBandMargin;
+    m_allBinsRadiusSquared = allBinsRadiusSquared;
+}
+
+AngularBinLookup::Candidates AngularBinLookup::locate(const glm::vec2& point) const
+{
+    Candidates candidates;
+    if (m_binCount == 0U)
+    {
+        return candidates;
+    }
+
+    const glm::vec2 relative = point - m_reference;
+    if (glm::dot(relative, relative) < m_allBinsRadiusSquared)
+    {
+        candidates.allBins = true;
+        return candidates;
+    }
+
+    float angle = fastAtan2(relative.y, relative.x);
+    if (angle < 0.0F)
+    {
+        angle += glm::two_pi<float>();
+    }
+
+    const float scaled = angle * m_inverseBinWidth;
+    const std::size_t bin = std::min(static_cast<std::size_t>(scaled), m_binCount - 1U);
+    const float offset = (scaled - static_cast<float>(bin)) * m_binWidth;
+
+    candidates.bins[0] = bin;
+    candidates.count = 1U;
+    if (offset < m_guardBand)
+    {
+        candidates.bins[1] = (bin + m_binCount - 1U) % m_binCount;
+        candidates.count = 2U;
+        candidates.needsExactCheck = true;
+    }
+    else if (m_binWidth - offset < m_guardBand)
+    {
+        candidates.bins[1] = (bin + 1U) % m_binCount;
+        candidates.count = 2U;
+        candidates.needsExactCheck = true;
+    }
+    return candidates;
+}
+
+float AngularBinLookup::fastAtan2(float y, float x)
+{
+    const float absX = std::fabs(x);
+    const float absY = std::fabs(y);
+    const float maxComponent = std::max(absX, absY);
+    if (maxComponent == 0.0F)
+    {
+        return 0.0F;
+    }
+
+    const float t = std::min(absX, absY) / maxComponent;
+    const float t2 = t * t;
+    float angle = t * (0.9998660F + t2 * (-0.3302995F + t2 * (0.1801410F + t2 * (-0.0851330F + t2 * 0.0208351F))));
+    if (absY > absX)
+    {
+        angle = glm::half_pi<float>() - angle;
+    }
+    if (x < 0.0F)
+    {
+        angle = glm::pi<float>() - angle;
+    }
+    return y < 0.0F ? -angle : angle;
+}
+
+void OrthogonalSlotLookup::build(const std::vector<Slot>& slots, float cellSize)
+{
+    m_slots = slots;
+    m_cellStart.clear();
+    m_cellSlots.clear();
+    m_cellCount = 0U;
+    if (m_slots.empty())
+    {
+        return;
+    }
+
+    m_minKey = std::numeric_limits<float>::max();
+    m_maxKey = -std::numeric_limits<float>::max();
+    for (const auto& slot : m_slots)
+    {
+        m_minKey = std::min(m_minKey, slot.minKey);
+        m_maxKey = std::max(m_maxKey, slot.maxKey);
+    }
+
+    const float span = std::max(m_maxKey - m_minKey, 1e-6F);
+    cellSize = std::max(cellSize, span / static_cast<float>(kMaxCells));
+    m_cellCount = std::clamp<std::size_t>(static_cast<std::size_t>(std::ceil(span / cellSize)), 1U, kMaxCells);
+    m_inverseCellSize = static_cast<float>(m_cellCount) / span;
+
+    const auto cellOf = [&](float key) {
+        const float offset = std::max(key - m_minKey, 0.0F);
+        return std::min(static_cast<std::size_t>(offset * m_inverseCellSize), m_cellCount - 1U);
+    };
+
+    // Counting pass, then fill, so every cell's slots are contiguous.
+    m_cellStart.assign(m_cellCount + 1U, 0U);
+    for (const auto& slot : m_slots)
+    {
+        for (std::size_t cell = cellOf(slot.minKey); cell <= cellOf(slot.maxKey); ++cell)
+        {
+            ++m_cellStart[cell + 1U];
+        }
+    }
+    for (std::size_t cell = 0; cell < m_cellCount; ++cell)
+    {
+        m_cellStart[cell + 1U] += m_cellStart[cell];
+    }
+    m_cellSlots.resize(m_cellStart.back());
+    std::vector<std::size_t> cursor(m_cellStart.begin(), m_cellStart.end() - 1);
+    for (std::size_t slotIndex = 0; slotIndex < m_slots.size(); ++slotIndex)
+    {
+        const Slot& slot = m_slots[slotIndex];
+        for (std::size_t cell = cellOf(slot.minKey); cell <= cellOf(slot.maxKey); ++cell)
+        {
+            m_cellSlots[cursor[cell]++] = slotIndex;
+        }
+    }
+}
+
+} // namespace mapping
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+namespace mapping
+{
+
+/// Maps a point to its angular virtual sensor with a single approximate atan2. Points whose
+/// approximate angle lies within the guard band of a bin edge are reported as ambiguous so the
+/// caller can settle them with the exact containment test, which keeps edge semantics unchanged.
+class AngularBinLookup
+{
+public:
+    struct Candidates
+    {
+        std::size_t bins[2] = {0U, 0U};
+        std::size_t count = 0U;
+        /// Point sits on the reference; every angular bin contains it.
+        bool allBins = false;
+        /// Both candidate bins must be confirmed with the exact test.
+        bool needsExactCheck = false;
+    };
+
+    /// Bins are `binCount` uniform sectors starting at angle 0 around `reference`.
+    /// `edgeDrift` is the largest deviation of the real bin edges from that uniform grid.
+    void build(const glm::vec2& reference, std::size_t binCount, float edgeDrift, float allBinsRadiusSquared);
+
+    Candidates locate(const glm::vec2& point) const;
+    std::size_t binCount() const noexcept { return m_binCount; }
+
+    /// Polynomial atan2 (Abramowitz & Stegun 4.4.49), result in [-pi, pi]. The bound below covers
+    /// the polynomial error (1e-5) plus float evaluation.
+    static float fastAtan2(float y, float x);
+    static constexpr float kFastAtan2MaxError = 2.0e-5F;
+
+private:
+    glm::vec2 m_reference = glm::vec2(0.0F);
+    std::size_t m_binCount = 0U;
+    float m_binWidth = 0.0F;
+    float m_inverseBinWidth = 0.0F;
+    float m_guardBand = 0.0F;
+    float m_allBinsRadiusSquared = 0.0F;
+};
+
+/// Uniform cell table over one axis for orthogonal slot sensors. Each cell lists the slots that
+/// overlap it, so a lookup costs one division plus the few slots sharing the cell, however many
+/// slots are configured. Candidates still need the exact test for the lateral extent.
+class OrthogonalSlotLookup
+{
+public:
+    struct Slot
+    {
+        float minKey = 0.0F;
+        float maxKey = 0.0F;
+        std::size_t sensorIndex = 0U;
+    };
+
+    static constexpr std::size_t kMaxCells = 4096U;
+
+    /// `cellSize` should not exceed the smallest slot pitch; it is enlarged when the slots would
+    /// need more than kMaxCells cells.
+    void build(const std::vector<Slot>& slots, float cellSize);
+    bool empty() const noexcept { return m_slots.empty(); }
+
+    template <typename Visitor>
+    void forEachCandidate(float key, Visitor&& visit) const
+    {
+        if (m_slots.empty() || !(key >= m_minKey && key <= m_maxKey))
+        {
+            return;
+        }
+        const auto cell = std::min(static_cast<std::size_t>((key - m_minKey) * m_inverseCellSize), m_cellCount - 1U);
+        for (std::size_t i = m_cellStart[cell]; i < m_cellStart[cell + 1U]; ++i)
+        {
+            const Slot& slot = m_slots[m_cellSlots[i]];
+            if (key >= slot.minKey && key <= slot.maxKey)
+            {
+                visit(slot.sensorIndex);
+            }
+        }
+    }
+
+private:
+    std::vector<Slot> m_slots;
+    std::vector<std::size_t> m_cellStart;
+    std::vector<std::size_t> m_cellSlots;
+    std::size_t m_cellCount = 0U;
+    float m_minKey = 0.0F;
+    float m_maxKey = 0.0F;
+    float m_inverseCellSize = 0.0F;
+};
+
+} // namespace mapping
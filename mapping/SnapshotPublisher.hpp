@@ -0,0 +1,99 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+namespace mapping
+{
+
+/// Triple-buffered publication of immutable values from one writer to any number of readers.
+/// The writer fills a buffer no reader can see, then publishes it with a new version. Readers
+/// take a shared handle to the latest buffer and can hold it as long as they like. The writer
+/// only reuses a buffer once no handle to it remains, and allocates a replacement otherwise.
+template <typename T>
+class SnapshotPublisher
+{
+public:
+    SnapshotPublisher()
+    {
+        for (auto& slot : m_slots)
+        {
+            slot = std::make_shared<Slot>();
+        }
+    }
+
+    /// Writer thread only. The returned buffer still holds whatever it carried when it was last
+    /// published, so callers can refill it without reallocating.
+    T& beginWrite()
+    {
+        for (std::size_t i = 0; i < m_slots.size(); ++i)
+        {
+            // The acquire pairs with the release in Lease, so every read through a dropped handle
+            // happens before we write. Only publish() leases a slot, so a zero cannot grow here.
+            if (i != m_publishedSlot && m_slots[i]->leases.load(std::memory_order_acquire) == 0U)
+            {
+                m_writeSlot = i;
+                return m_slots[i]->value;
+            }
+        }
+        // Readers of the abandoned buffer keep it alive through their lease.
+        m_writeSlot = m_publishedSlot == 0U ? 1U : 0U;
+        m_slots[m_writeSlot] = std::make_shared<Slot>();
+        return m_slots[m_writeSlot]->value;
+    }
+
+    /// Publishes the buffer from the last beginWrite() and returns its version.
+    uint64_t publish()
+    {
+        const std::shared_ptr<Slot>& slot = m_slots[m_writeSlot];
+        // Ordered before any reader sees the handle by the mutex below.
+        slot->leases.fetch_add(1U, std::memory_order_relaxed);
+        std::shared_ptr<const T> published(&slot->value, Lease{slot});
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_latest.swap(published);
+        }
+        m_publishedSlot = m_writeSlot;
+        return m_version.fetch_add(1U, std::memory_order_acq_rel) + 1U;
+    }
+
+    std::shared_ptr<const T> latest() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_latest;
+    }
+
+    /// Number of publications so far; cheap enough to poll every frame.
+    uint64_t version() const noexcept { return m_version.load(std::memory_order_acquire); }
+
+private:
+    static constexpr std::size_t kNoSlot = static_cast<std::size_t>(-1);
+
+    struct Slot
+    {
+        T value{};
+        /// Published handles to `value` that still have holders.
+        std::atomic<uint32_t> leases{0U};
+    };
+
+    /// Deleter of a published handle: runs once its last holder lets go, and releases the slot.
+    struct Lease
+    {
+        std::shared_ptr<Slot> slot;
+
+        void operator()(const T* /*value*/) const noexcept { slot->leases.fetch_sub(1U, std::memory_order_release); }
+    };
+
+    std::array<std::shared_ptr<Slot>, 3> m_slots;
+    std::size_t m_writeSlot = 0U;
+    std::size_t m_publishedSlot = kNoSlot;
+    mutable std::mutex m_mutex;
+    std::shared_ptr<const T> m_latest;
+    std::atomic<uint64_t> m_version{0U};
+};
+
+} // namespace mapping
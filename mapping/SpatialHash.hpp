@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace mapping
+{
+
+/// Index of the cell of side 1 / `inverseCellSize` that holds `value`, rounding towards minus
+/// infinity. Truncates and corrects negatives; std::floor is a library call without SSE4.1.
+inline int64_t floorToCell(float value, float inverseCellSize) noexcept
+{
+    const float scaled = value * inverseCellSize;
+    auto cell = static_cast<int64_t>(scaled);
+    return cell - static_cast<int64_t>(scaled < static_cast<float>(cell));
+}
+
+/// Slot of a packed cell key in an open-addressing table of `mask` + 1 slots, a power of two.
+inline std::size_t hashSlot(uint64_t key, std::size_t mask) noexcept
+{
+    // Full 64-bit finalizer (MurmurHash3): neighbouring cells differ in a few bits of each packed
+    // coordinate, and a single multiply maps them onto runs of slots that defeat linear probing.
+    key ^= key >> 33U;
+    key *= 0xFF51AFD7ED558CCDULL;
+    key ^= key >> 33U;
+    key *= 0xC4CEB9FE1A85EC53ULL;
+    key ^= key >> 33U;
+    return static_cast<std::size_t>(key & mask);
+}
+
+} // namespace mapping
@@ -0,0 +1,260 @@
+#include "mapping/VoxelGridFilter.hpp"
+#include "mapping/SpatialHash.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+
+namespace mapping
+{
+
+namespace
+{
+constexpr int kAxisBits = 21;
+constexpr int64_t kAxisOffset = int64_t{1} << (kAxisBits - 1);
+constexpr int64_t kAxisMax = (int64_t{1} << kAxisBits) - 1;
+constexpr std::size_t kRadixBits = 11U;
+constexpr std::size_t kRadixBuckets = std::size_t{1} << kRadixBits;
+constexpr std::size_t kMaxRadixPasses = (3U * kAxisBits + kRadixBits - 1U) / kRadixBits;
+
+uint64_t quantize(float value, float inverseLeafSize)
+{
+    const int64_t cell = floorToCell(value, inverseLeafSize) + kAxisOffset;
+    return static_cast<uint64_t>(std::clamp<int64_t>(cell, 0, kAxisMax));
+}
+
+} // namespace
+
+VoxelGridFilter::VoxelGridFilter(const VoxelGridSettings& settings)
+{
+    configure(settings);
+}
+
+void VoxelGridFilter::configure(const VoxelGridSettings& settings)
+{
+    m_settings = settings;
+    m_settings.leafSize = std::max(settings.leafSize, 0.001F);
+    m_inverseLeafSize = 1.0F / m_settings.leafSize;
+}
+
+uint64_t VoxelGridFilter::voxelKey(const lidar::LidarPoint& point) const noexcept
+{
+    return quantize(point.x, m_inverseLeafSize) | (quantize(point.y, m_inverseLeafSize) << kAxisBits)
+           | (quantize(point.z, m_inverseLeafSize) << (2 * kAxisBits));
+}
+
+void VoxelGridFilter::accumulate(Voxel& voxel, const lidar::LidarPoint& point, uint32_t index, bool first) const noexcept
+{
+    switch (m_settings.reduction)
+    {
+    case VoxelReduction::Centroid:
+        voxel.sumX += point.x;
+        voxel.sumY += point.y;
+        voxel.sumZ += point.z;
+        voxel.sumIntensity += point.intensity;
+        ++voxel.count;
+        break;
+    case VoxelReduction::MinZ:
+        if (first || point.z < voxel.sumZ)
+        {
+            voxel.sumZ = point.z;
+            voxel.representative = index;
+        }
+        break;
+    case VoxelReduction::FirstPoint:
+        if (first)
+        {
+            voxel.representative = index;
+        }
+        break;
+    }
+}
+
+void VoxelGridFilter::emit(const Voxel& voxel,
+                           const lidar::BaseLidarSensor::PointCloud& input,
+                           lidar::BaseLidarSensor::PointCloud& output) const
+{
+    if (m_settings.reduction != VoxelReduction::Centroid)
+    {
+        output.push_back(input[voxel.representative]);
+        return;
+    }
+    const float inverseCount = 1.0F / static_cast<float>(voxel.count);
+    output.push_back(lidar::LidarPoint{voxel.sumX * inverseCount,
+                                       voxel.sumY * inverseCount,
+                                       voxel.sumZ * inverseCount,
+                                       voxel.sumIntensity * inverseCount});
+}
+
+void VoxelGridFilter::filter(const lidar::BaseLidarSensor::PointCloud& input, lidar::BaseLidarSensor::PointCloud& output)
+{
+    output.clear();
+    if (input.empty())
+    {
+        return;
+    }
+
+    m_lastMethod = m_settings.method;
+    if (m_lastMethod == VoxelGridMethod::Auto)
+    {
+        m_lastMethod = m_lastVoxelCount > kRadixSortVoxelThreshold ? VoxelGridMethod::RadixSort : VoxelGridMethod::Hash;
+    }
+
+    if (m_lastMethod == VoxelGridMethod::RadixSort)
+    {
+        filterRadix(input, output);
+    }
+    else
+    {
+        filterHash(input, output);
+    }
+    m_lastVoxelCount = output.size();
+}
+
+void VoxelGridFilter::filterHash(const lidar::BaseLidarSensor::PointCloud& input, lidar::BaseLidarSensor::PointCloud& output)
+{
+    // At most one voxel per point, so a table of twice the input keeps the load factor <= 0.5.
+    std::size_t capacity = 16U;
+    while (capacity < input.size() * 2U)
+    {
+        capacity *= 2U;
+    }
+    if (m_table.size() < capacity)
+    {
+        m_table.assign(capacity, HashEntry{});
+        m_generation = 0U;
+    }
+    if (++m_generation == 0U)
+    {
+        std::fill(m_table.begin(), m_table.end(), HashEntry{});
+        m_generation = 1U;
+    }
+
+    const std::size_t mask = m_table.size() - 1U;
+    m_voxels.clear();
+    uint64_t previousKey = ~uint64_t{0};
+    uint32_t previousVoxel = 0U;
+    for (std::size_t i = 0; i < input.size(); ++i)
+    {
+        const uint64_t key = voxelKey(input[i]);
+        // Consecutive returns of a sweep often share a voxel; skip the probe for those.
+        if (key == previousKey)
+        {
+            accumulate(m_voxels[previousVoxel], input[i], static_cast<uint32_t>(i), false);
+            continue;
+        }
+        std::size_t slot = hashSlot(key, mask);
+        while (m_table[slot].generation == m_generation && m_table[slot].key != key)
+        {
+            slot = (slot + 1U) & mask;
+        }
+
+        HashEntry& entry = m_table[slot];
+        const bool first = entry.generation != m_generation;
+        if (first)
+        {
+            entry = HashEntry{key, m_generation, static_cast<uint32_t>(m_voxels.size())};
+            m_voxels.emplace_back();
+        }
+        accumulate(m_voxels[entry.voxel], input[i], static_cast<uint32_t>(i), first);
+        previousKey = key;
+        previousVoxel = entry.voxel;
+    }
+
+    output.reserve(m_voxels.size());
+    for (const auto& voxel : m_voxels)
+    {
+        emit(voxel, input, output);
+    }
+}
+
+void VoxelGridFilter::filterRadix(const lidar::BaseLidarSensor::PointCloud& input, lidar::BaseLidarSensor::PointCloud& output)
+{
+    const std::size_t count = input.size();
+    m_sortKeys.resize(count);
+    m_sortIndices.resize(count);
+    m_sortKeysScratch.resize(count);
+    m_sortIndicesScratch.resize(count);
+
+    // Re-pack the keys relative to the scan's bounding box so only the bits that vary get sorted.
+    constexpr uint64_t kAxisMask = static_cast<uint64_t>(kAxisMax);
+    std::array<uint64_t, 3> low{kAxisMask, kAxisMask, kAxisMask};
+    std::array<uint64_t, 3> high{0U, 0U, 0U};
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        const uint64_t key = voxelKey(input[i]);
+        m_sortKeys[i] = key;
+        for (std::size_t axis = 0; axis < 3U; ++axis)
+        {
+            const uint64_t cell = (key >> (axis * kAxisBits)) & kAxisMask;
+            low[axis] = std::min(low[axis], cell);
+            high[axis] = std::max(high[axis], cell);
+        }
+    }
+    std::array<int, 3> shift{};
+    int keyBits = 0;
+    for (std::size_t axis = 0; axis < 3U; ++axis)
+    {
+        shift[axis] = keyBits;
+        keyBits += std::bit_width(high[axis] - low[axis]);
+    }
+    const std::size_t passes = (static_cast<std::size_t>(keyBits) + kRadixBits - 1U) / kRadixBits;
+
+    std::array<std::array<uint32_t, kRadixBuckets>, kMaxRadixPasses> histograms{};
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        const uint64_t key = m_sortKeys[i];
+        uint64_t dense = 0U;
+        for (std::size_t axis = 0; axis < 3U; ++axis)
+        {
+            dense |= (((key >> (axis * kAxisBits)) & kAxisMask) - low[axis]) << shift[axis];
+        }
+        m_sortKeys[i] = dense;
+        m_sortIndices[i] = static_cast<uint32_t>(i);
+        for (std::size_t pass = 0; pass < passes; ++pass)
+        {
+            ++histograms[pass][(dense >> (pass * kRadixBits)) & (kRadixBuckets - 1U)];
+        }
+    }
+
+    // LSD passes are stable, so equal keys keep input order and FirstPoint stays well defined.
+    for (std::size_t pass = 0; pass < passes; ++pass)
+    {
+        auto& histogram = histograms[pass];
+        uint32_t offset = 0U;
+        for (auto& bucket : histogram)
+        {
+            const uint32_t size = bucket;
+            bucket = offset;
+            offset += size;
+        }
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            const uint64_t key = m_sortKeys[i];
+            const uint32_t target = histogram[(key >> (pass * kRadixBits)) & (kRadixBuckets - 1U)]++;
+            m_sortKeysScratch[target] = key;
+            m_sortIndicesScratch[target] = m_sortIndices[i];
+        }
+        m_sortKeys.swap(m_sortKeysScratch);
+        m_sortIndices.swap(m_sortIndicesScratch);
+    }
+
+    Voxel voxel;
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        const bool first = i == 0U || m_sortKeys[i] != m_sortKeys[i - 1U];
+        if (first && i > 0U)
+        {
+            emit(voxel, input, output);
+        }
+        if (first)
+        {
+            voxel = Voxel{};
+        }
+        const uint32_t index = m_sortIndices[i];
+        accumulate(voxel, input[index], index, first);
+    }
+    emit(voxel, input, output);
+}
+
+} // namespace mapping
@@ -0,0 +1,103 @@
+#pragma once
+
+#include "sensors/BaseLidarSensor.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace mapping
+{
+
+enum class VoxelReduction
+{
+    /// Mean position and intensity of the voxel's points.
+    Centroid,
+    /// The voxel's lowest point.
+    MinZ,
+    /// The voxel's first point in input order.
+    FirstPoint,
+};
+
+enum class VoxelGridMethod
+{
+    /// Hash for small voxel counts, radix sort once the previous frame produced many voxels.
+    Auto,
+    /// Open-addressing hash table; output keeps first-appearance order.
+    Hash,
+    /// LSD radix sort of the voxel keys; output is in key order.
+    RadixSort,
+};
+
+struct VoxelGridSettings
+{
+    float leafSize = 0.2F;
+    VoxelReduction reduction = VoxelReduction::Centroid;
+    VoxelGridMethod method = VoxelGridMethod::Auto;
+};
+
+/// Voxel-grid downsampling over a point cloud. Coordinates are quantized to 21 bits per axis and
+/// packed into one 64-bit key. All working storage is kept between calls, so once the arrays
+/// have grown to the largest scan seen, a frame does not allocate. The hash table stamps entries
+/// with a generation counter instead of being cleared every frame.
+class VoxelGridFilter
+{
+public:
+    /// Auto switches to radix sort above this many voxels (accumulated multi-scan clouds). There
+    /// the hash table falls out of cache and the sequential sort passes win over random probes;
+    /// for a single scan the hash is faster at every leaf size.
+    static constexpr std::size_t kRadixSortVoxelThreshold = 262144U;
+
+    explicit VoxelGridFilter(const VoxelGridSettings& settings = {});
+
+    void configure(const VoxelGridSettings& settings);
+    const VoxelGridSettings& settings() const noexcept { return m_settings; }
+
+    /// Replaces `output` with one point per occupied voxel of `input`.
+    void filter(const lidar::BaseLidarSensor::PointCloud& input, lidar::BaseLidarSensor::PointCloud& output);
+
+    /// Method used by the last filter() call; Auto resolved to the concrete method.
+    VoxelGridMethod lastMethod() const noexcept { return m_lastMethod; }
+
+private:
+    struct Voxel
+    {
+        float sumX = 0.0F;
+        float sumY = 0.0F;
+        float sumZ = 0.0F;
+        float sumIntensity = 0.0F;
+        uint32_t count = 0U;
+        uint32_t representative = 0U;
+    };
+
+    struct HashEntry
+    {
+        uint64_t key = 0U;
+        uint32_t generation = 0U;
+        uint32_t voxel = 0U;
+    };
+
+    uint64_t voxelKey(const lidar::LidarPoint& point) const noexcept;
+    void accumulate(Voxel& voxel, const lidar::LidarPoint& point, uint32_t index, bool first) const noexcept;
+    void emit(const Voxel& voxel,
+              const lidar::BaseLidarSensor::PointCloud& input,
+              lidar::BaseLidarSensor::PointCloud& output) const;
+    void filterHash(const lidar::BaseLidarSensor::PointCloud& input, lidar::BaseLidarSensor::PointCloud& output);
+    void filterRadix(const lidar::BaseLidarSensor::PointCloud& input, lidar::BaseLidarSensor::PointCloud& output);
+
+    VoxelGridSettings m_settings;
+    float m_inverseLeafSize = 0.0F;
+    VoxelGridMethod m_lastMethod = VoxelGridMethod::Hash;
+    std::size_t m_lastVoxelCount = 0U;
+
+    // Arena reused across frames.
+    std::vector<HashEntry> m_table;
+    uint32_t m_generation = 0U;
+    std::vector<Voxel> m_voxels;
+    std::vector<uint64_t> m_sortKeys;
+    std::vector<uint32_t> m_sortIndices;
+    std::vector<uint64_t> m_sortKeysScratch;
+    std::vector<uint32_t> m_sortIndicesScratch;
+};
+
+} // namespace mapping
@@ -29,6 +29,8 @@ const size_t kHDLNumBeamsPerBlock = 32 * 12; // or 16 * 24 for VLP16, but they a
 const size_t maxkHDLFiringSequencesPerBlock = 24;
 const size_t maxkHDLNumBeams                = 32;
 const size_t maxkHDLMaxBlocksPerScan        = 181;
+// Positioning packets arrive far less often than data packets; further ones in a scan are dropped.
+const size_t maxkImuSamplesPerScan = 64;
 
 #pragma pack(push, 1)
 
@@ -87,6 +89,15 @@ struct data_block_t
     data_point_t v_laser[maxkHDLNumBeams];
 };
 
+// Gyro and accelerometer readings of one positioning (GPS/IMU) packet. The HDL-32E carries three
+// boards, each with one gyro and a two-axis accelerometer; the VLP16 leaves these fields zero.
+struct ImuSample_t
+{
+    uint64_t timestamp_us; // "CAN Time" of the positioning packet
+    float    gyro_dps[3];
+    float    accel_g[3][2]; // X and Y axis of each board
+};
+
 struct LiDARScan_t
 {
     LiDARHardware_t lidarHardware;
@@ -96,6 +107,10 @@ struct LiDARScan_t
 
     /* Decoded Velodyne laser firing data */
     data_block_t firings[maxkHDLFiringSequencesPerBlock * maxkHDLMaxBlocksPerScan];
+
+    /* Positioning packets read between this scan's data packets */
+    size_t      imuSampleCount;
+    ImuSample_t imuSamples[maxkImuSamplesPerScan];
 };
 
 struct velodyne_data_packet_t
@@ -47,6 +47,30 @@ extern "C"
     void
     EndLidarEnumeration();
 
+// Random access into an open enumeration. Scans span a fixed number of data packets, so the
+// stream offset at which a scan starts is enough to decode it again later.
+// @return the offset of the scan the next GetNextLidarScan call reads, or -1 if no file is open.
+#if defined(__cplusplus)
+extern "C"
+#endif
+    long long
+    GetLidarScanPosition();
+
+// @return the offset of the scan returned by GetFirstLidarScan, or -1 if no file is open.
+#if defined(__cplusplus)
+extern "C"
+#endif
+    long long
+    GetFirstLidarScanPosition();
+
+// Moves the stream to an offset previously returned by GetLidarScanPosition/GetFirstLidarScanPosition.
+// @return GLSE_SUCCESS, or GLSE_FILEIOERR if no file is open or the seek failed.
+#if defined(__cplusplus)
+extern "C"
+#endif
+    int
+    SeekLidarScan(long long position);
+
 // Computes the correct LiDAR timestamps, depending on the version of the .pcap file.
 // @param phdr_ts_sec the raw seconds timestamp from the .pcap file.
 // @param phdr_ts_usec the raw microseconds timestamp from the .pcap file.
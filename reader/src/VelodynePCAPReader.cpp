@@ -17,6 +17,7 @@ static FILE*                    fpLiDAR                   = NULL;
 static PCAPLiDARTimeScalingType gPcapLidarTimeScalingType = PCAPLiDARTimeScalingType::Corrected;
 static unsigned int             dataPacketLength          = 1206 + 42;
 static unsigned int             gpsPacketLength           = 512 + 42;
+static long long                gFirstScanPosition        = -1;
 
 #pragma pack(push, 1)
 struct pcap_hdr_t
@@ -84,7 +85,36 @@ struct VelodynePositioningPacket
 };
 #pragma pack(pop)
 
-static bool readNextDataPacket(data_packet_t* pkt, uint64_t* timestamp_us)
+// Scale factors from the HDL-32E user manual; IMU fields are 12-bit two's complement values.
+static const float kGyroDegreesPerSecondPerLsb = 0.09766F;
+static const float kAccelGPerLsb               = 0.001221F;
+
+static float decodeImuField(uint16_t raw, float scale)
+{
+    const int value = static_cast<int>(raw & 0x0FFFU);
+    return static_cast<float>(value >= 0x0800 ? value - 0x1000 : value) * scale;
+}
+
+static void appendImuSample(const VelodynePositioningPacket& pkt, uint64_t timestamp_us, VDYNE::LiDARScan_t* scan)
+{
+    if (scan->imuSampleCount >= VDYNE::maxkImuSamplesPerScan)
+    {
+        return;
+    }
+
+    const uint16_t gyro[3]     = {pkt.Gyro1, pkt.Gyro2, pkt.Gyro3};
+    const uint16_t accel[3][2] = {{pkt.Accel1X, pkt.Accel1Y}, {pkt.Accel2X, pkt.Accel2Y}, {pkt.Accel3X, pkt.Accel3Y}};
+    VDYNE::ImuSample_t& sample = scan->imuSamples[scan->imuSampleCount++];
+    sample.timestamp_us        = timestamp_us;
+    for (size_t board = 0; board < 3; board++)
+    {
+        sample.gyro_dps[board]   = decodeImuField(gyro[board], kGyroDegreesPerSecondPerLsb);
+        sample.accel_g[board][0] = decodeImuField(accel[board][0], kAccelGPerLsb);
+        sample.accel_g[board][1] = decodeImuField(accel[board][1], kAccelGPerLsb);
+    }
+}
+
+static bool readNextDataPacket(data_packet_t* pkt, uint64_t* timestamp_us, VDYNE::LiDARScan_t* scan)
 {
     // Initialize the return value
     bool validDataPacket = false;
@@ -102,11 +132,24 @@ static bool readNextDataPacket(data_packet_t* pkt, uint64_t* timestamp_us)
             // Read packet data
             validDataPacket = fread(pkt, sizeof(data_packet_t), 1, fpLiDAR) == 1;
         }
+        else if (phdr.orig_len == gpsPacketLength)
+        {
+            // Positioning packets are decoded in the same pass and attached to the scan being read.
+            VelodynePositioningPacket positioning;
+            const uint64_t            positioningTimestamp_us =
+                getPCAPVersionDependentLiDARTimestamp(phdr.ts_sec, phdr.ts_usec, gPcapLidarTimeScalingType);
+            validDataPacket = fread(&positioning, sizeof(positioning), 1, fpLiDAR) == 1;
+            if (validDataPacket)
+            {
+                appendImuSample(positioning, positioningTimestamp_us, scan);
+                validDataPacket = readNextDataPacket(pkt, timestamp_us, scan);
+            }
+        }
         else // Skip other packets
         {
             // Advance the file pointer to the next PCAP header, ignoring the data in the unknown packet
             validDataPacket =
-                fseek(fpLiDAR, phdr.orig_len, SEEK_CUR) == 0 ? readNextDataPacket(pkt, timestamp_us) : false;
+                fseek(fpLiDAR, phdr.orig_len, SEEK_CUR) == 0 ? readNextDataPacket(pkt, timestamp_us, scan) : false;
         }
     }
 
@@ -120,9 +163,10 @@ int ImplGetNextLidarScan(VDYNE::LiDARScan_t* scan, FILE* fp)
     data_packet_t   pkt;
     size_t          kHDLMaxBlocksPerScan = 181;
     static uint16_t azimuthChange        = 0;
+    scan->imuSampleCount                 = 0;
     for (size_t iBlock = 0; iBlock < kHDLMaxBlocksPerScan; iBlock++)
     {
-        bool bOK = readNextDataPacket(&pkt, &scan->block_timestamp_us[iBlock]);
+        bool bOK = readNextDataPacket(&pkt, &scan->block_timestamp_us[iBlock], scan);
         if (bOK)
         {
             if (iBlock == 0)
@@ -214,6 +258,15 @@ int ImplGetNextLidarScan(VDYNE::LiDARScan_t* scan, FILE* fp)
     return rc;
 }
 
+static long long tellLidarStream()
+{
+#if defined(WIN32)
+    return _ftelli64(fpLiDAR);
+#else
+    return static_cast<long long>(ftello(fpLiDAR));
+#endif
+}
+
 static bool isValidMagicNumber(uint32_t magic)
 {
     return ((magic == 0xa1b23c4d) || (magic == 0x4d3cb2a1) || (magic == 0xa1b2c3d4) || (magic == 0xd4c3b2a1));
@@ -249,6 +302,7 @@ extern "C" int GetFirstLidarScan(const char* filename, VDYNE::LiDARScan_t* scan)
             // Reset the file stream to where it was prior to determining the LiDAR time scaling type.
             fsetpos(fpLiDAR, &dataStartPos);
 
+            gFirstScanPosition = tellLidarStream();
             rc = ImplGetNextLidarScan(scan, fpLiDAR);
         }
         if (numread != 1)
@@ -283,10 +337,37 @@ extern "C" void EndLidarEnumeration()
     if (fpLiDAR != NULL)
     {
         fclose(fpLiDAR);
+        fpLiDAR = NULL;
     }
+    gFirstScanPosition = -1;
     // TODO Free any other resources that were allocated here
 }
 
+extern "C" long long GetLidarScanPosition()
+{
+    return fpLiDAR != NULL ? tellLidarStream() : -1;
+}
+
+extern "C" long long GetFirstLidarScanPosition()
+{
+    return fpLiDAR != NULL ? gFirstScanPosition : -1;
+}
+
+extern "C" int SeekLidarScan(long long position)
+{
+    if (fpLiDAR == NULL || position < 0)
+    {
+        return GLSE_FILEIOERR;
+    }
+
+#if defined(WIN32)
+    const int result = _fseeki64(fpLiDAR, position, SEEK_SET);
+#else
+    const int result = fseeko(fpLiDAR, static_cast<off_t>(position), SEEK_SET);
+#endif
+    return result == 0 ? GLSE_SUCCESS : GLSE_FILEIOERR;
+}
+
 static unsigned long long convertSecondsToMicroSeconds(unsigned int timestamp_s)
 {
     return static_cast<unsigned long long>(timestamp_s) * 1000000ULL;
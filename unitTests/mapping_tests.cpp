@@ -1,8 +1,28 @@
 #include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <tuple>
+#include <vector>
 
 #include <gtest/gtest.h>
 
+#include "engine/ThreadPool.hpp"
+#include "mapping/BoundarySimplifier.hpp"
+#include "mapping/ContourClearance.hpp"
+#include "mapping/ContourMask.hpp"
+#include "mapping/EuclideanClustering.hpp"
+#include "mapping/FreeSpaceAccumulator.hpp"
+#include "mapping/FreeSpaceHull.hpp"
+#include "mapping/GroundSegmentation.hpp"
+#include "mapping/KdTree.hpp"
 #include "mapping/LidarVirtualSensorMapping.hpp"
+#include "mapping/OccupancyGrid.hpp"
+#include "mapping/ScanRegistration.hpp"
+#include "mapping/SensorBinLookup.hpp"
+#include "mapping/SnapshotPublisher.hpp"
+#include "mapping/VoxelGridFilter.hpp"
 #include "sensors/BaseLidarSensor.hpp"
 
 namespace
@@ -11,6 +31,108 @@ lidar::LidarPoint make_point(float x, float y, float z)
 {
     return {x, y, z, 1.0F};
 }
+
+float polygonArea(const std::vector<glm::vec2>& polygon)
+{
+    float area = 0.0F;
+    for (std::size_t i = 0; i < polygon.size(); ++i)
+    {
+        const glm::vec2& a = polygon[i];
+        const glm::vec2& b = polygon[(i + 1U) % polygon.size()];
+        area += a.x * b.y - a.y * b.x;
+    }
+    return 0.5F * area;
+}
+
+// Inside or on the boundary of a simple polygon.
+bool polygonContains(const std::vector<glm::vec2>& polygon, const glm::vec2& point)
+{
+    bool inside = false;
+    for (std::size_t i = 0, j = polygon.size() - 1U; i < polygon.size(); j = i++)
+    {
+        const glm::vec2& a = polygon[i];
+        const glm::vec2& b = polygon[j];
+        const float side = (b.x - a.x) * (point.y - a.y) - (b.y - a.y) * (point.x - a.x);
+        if (std::fabs(side) < 1e-5F && glm::dot(point - a, point - b) <= 0.0F)
+        {
+            return true;
+        }
+        if ((a.y > point.y) != (b.y > point.y) && point.x < (b.x - a.x) * (point.y - a.y) / (b.y - a.y) + a.x)
+        {
+            inside = !inside;
+        }
+    }
+    return inside;
+}
+
+bool edgesCross(const glm::vec2& p1, const glm::vec2& p2, const glm::vec2& q1, const glm::vec2& q2)
+{
+    const auto side = [](const glm::vec2& o, const glm::vec2& a, const glm::vec2& b) {
+        return (a.x - o.x) * (b.y - o.y) - (a.y - o.y) * (b.x - o.x);
+    };
+    return side(q1, q2, p1) * side(q1, q2, p2) < 0.0F && side(p1, p2, q1) * side(p1, p2, q2) < 0.0F;
+}
+
+bool isSimplePolygon(const std::vector<glm::vec2>& polygon)
+{
+    const std::size_t count = polygon.size();
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        for (std::size_t j = i + 2U; j < count; ++j)
+        {
+            if ((j + 1U) % count == i)
+            {
+                continue;
+            }
+            if (edgesCross(polygon[i], polygon[(i + 1U) % count], polygon[j], polygon[(j + 1U) % count]))
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// Distance from `point` to the closed outline of `polygon`.
+float outlineDistance(const std::vector<glm::vec2>& polygon, const glm::vec2& point)
+{
+    float best = std::numeric_limits<float>::max();
+    for (std::size_t i = 0; i < polygon.size(); ++i)
+    {
+        const glm::vec2& a = polygon[i];
+        const glm::vec2 edge = polygon[(i + 1U) % polygon.size()] - a;
+        const float t = std::clamp(glm::dot(point - a, edge) / glm::dot(edge, edge), 0.0F, 1.0F);
+        const glm::vec2 offset = point - (a + edge * t);
+        best = std::min(best, std::sqrt(glm::dot(offset, offset)));
+    }
+    return best;
+}
+
+// Reference containment matching the original per-sensor atan2 scan.
+bool bruteForceContains(const mapping::LidarVirtualSensorMapping::SensorSnapshot& sensor, const glm::vec2& point)
+{
+    if (!sensor.isAngular)
+    {
+        const float lateral = (point.x - sensor.reference.x) * sensor.orthSideSign;
+        return lateral >= sensor.orthMinLat && lateral <= sensor.orthMaxLat && point.y >= sensor.orthMinLon
+               && point.y <= sensor.orthMaxLon;
+    }
+    const glm::vec2 relative = point - sensor.reference;
+    if (glm::dot(relative, relative) < 1e-5F)
+    {
+        return true;
+    }
+    float angle = std::atan2(relative.y, relative.x);
+    if (angle < 0.0F)
+    {
+        angle += glm::two_pi<float>();
+    }
+    if (sensor.wrapAround)
+    {
+        return angle >= sensor.lowerAngle || angle <= sensor.upperAngle;
+    }
+    return angle >= sensor.lowerAngle && angle <= sensor.upperAngle;
+}
 } // namespace
 
 TEST(LidarVirtualSensorMappingTest, NonGroundPointsPopulateHull)
@@ -48,3 +170,1362 @@ TEST(LidarVirtualSensorMappingTest, PointsInsideContourAreIgnored)
 
     EXPECT_TRUE(mapper.nonGroundHull().empty());
 }
+
+TEST(SensorBinLookupTest, FastAtan2StaysWithinErrorBound)
+{
+    float maxError = 0.0F;
+    for (int i = 0; i < 100000; ++i)
+    {
+        const float angle = -glm::pi<float>() + glm::two_pi<float>() * static_cast<float>(i) / 100000.0F;
+        const float x = 3.0F * std::cos(angle);
+        const float y = 3.0F * std::sin(angle);
+        maxError = std::max(maxError, std::fabs(mapping::AngularBinLookup::fastAtan2(y, x) - std::atan2(y, x)));
+    }
+    EXPECT_LE(maxError, mapping::AngularBinLookup::kFastAtan2MaxError);
+}
+
+TEST(LidarVirtualSensorMappingTest, BinLookupMatchesBruteForceAtBoundaries)
+{
+    mapping::LidarVirtualSensorMapping mapper;
+    mapper.setVehicleContour({{-0.9F, -2.4F}, {-0.9F, 2.1F}, {0.9F, 2.1F}, {0.9F, -2.4F}});
+
+    const auto definitions = mapper.snapshots();
+    const glm::vec2 center = definitions[0].reference;
+    std::vector<glm::vec2> positions;
+    for (const auto& definition : definitions)
+    {
+        // Exactly on each bin edge and one float step to either side.
+        for (const float angle : {definition.lowerAngle,
+                                  std::nextafter(definition.lowerAngle, 0.0F),
+                                  std::nextafter(definition.lowerAngle, 7.0F)})
+        {
+            positions.push_back(center + 7.5F * glm::vec2(std::cos(angle), std::sin(angle)));
+        }
+    }
+    positions.push_back(center);
+    std::mt19937 generator(7U);
+    std::uniform_real_distribution<float> coordinate(-30.0F, 30.0F);
+    for (int i = 0; i < 20000; ++i)
+    {
+        positions.emplace_back(coordinate(generator), coordinate(generator));
+    }
+
+    // Map each position alone so every point's bin membership is observable.
+    for (const auto& position : positions)
+    {
+        mapper.updatePoints({make_point(position.x, position.y, 0.5F)});
+        const auto snapshots = mapper.snapshots();
+        const bool insideBody = std::fabs(position.x) < 0.9F && position.y > -2.4F && position.y < 2.1F;
+        for (const auto& snapshot : snapshots)
+        {
+            const bool expected = !insideBody && bruteForceContains(snapshot, position);
+            ASSERT_EQ(snapshot.valid, expected) << position.x << ", " << position.y;
+        }
+    }
+}
+
+TEST(LidarVirtualSensorMappingTest, AngularSensorCountIsConfigurable)
+{
+    mapping::LidarVirtualSensorMapping mapper(-1.8F, 360U);
+    mapper.setVehicleContour({{-0.9F, -2.4F}, {-0.9F, 2.1F}, {0.9F, 2.1F}, {0.9F, -2.4F}});
+    EXPECT_EQ(mapper.sensorCount(), 360U);
+
+    mapper.setAngularSensorCount(7U);
+    ASSERT_EQ(mapper.sensorCount(), 7U);
+
+    std::mt19937 generator(11U);
+    std::uniform_real_distribution<float> coordinate(-30.0F, 30.0F);
+    for (int i = 0; i < 2000; ++i)
+    {
+        const glm::vec2 position(coordinate(generator), coordinate(generator));
+        mapper.updatePoints({make_point(position.x, position.y, 0.5F)});
+        const auto arrays = mapper.sensorArrays();
+        ASSERT_EQ(arrays.valid.size(), 7U);
+        const bool insideBody = std::fabs(position.x) < 0.9F && position.y > -2.4F && position.y < 2.1F;
+        const auto snapshots = mapper.snapshots();
+        for (std::size_t sensor = 0; sensor < snapshots.size(); ++sensor)
+        {
+            const bool expected = !insideBody && bruteForceContains(snapshots[sensor], position);
+            ASSERT_EQ(arrays.valid[sensor] != 0U, expected) << position.x << ", " << position.y;
+        }
+    }
+
+    mapper.setAngularSensorCount(1U);
+    EXPECT_EQ(mapper.angularSensorCount(), mapping::LidarVirtualSensorMapping::kMinAngularSensorCount);
+}
+
+TEST(LidarVirtualSensorMappingTest, ParallelUpdateMatchesSequential)
+{
+    std::mt19937 generator(5U);
+    std::uniform_real_distribution<float> coordinate(-25.0F, 25.0F);
+    std::uniform_real_distribution<float> height(-2.5F, 1.0F);
+    lidar::BaseLidarSensor::PointCloud cloud;
+    for (int i = 0; i < 50000; ++i)
+    {
+        const float x = std::round(coordinate(generator) * 4.0F) / 4.0F;
+        const float y = std::round(coordinate(generator) * 4.0F) / 4.0F;
+        // Coarse coordinates give many equal distances, so tie-breaking is exercised.
+        cloud.push_back(make_point(x, y, height(generator)));
+    }
+
+    const std::vector<glm::vec2> contour{{-0.9F, -2.4F}, {-0.9F, 2.1F}, {0.9F, 2.1F}, {0.9F, -2.4F}};
+    mapping::LidarVirtualSensorMapping sequential;
+    sequential.setVehicleContour(contour);
+    sequential.updatePoints(cloud);
+    const auto expected = sequential.snapshots();
+
+    for (const std::size_t workers : {1U, 3U, 7U})
+    {
+        lidar::ThreadPool pool(workers);
+        mapping::LidarVirtualSensorMapping parallel;
+        parallel.setVehicleContour(contour);
+        parallel.setThreadPool(&pool);
+        parallel.updatePoints(cloud);
+        const auto actual = parallel.snapshots();
+        ASSERT_EQ(actual.size(), expected.size());
+        for (std::size_t sensor = 0; sensor < actual.size(); ++sensor)
+        {
+            EXPECT_EQ(actual[sensor].valid, expected[sensor].valid);
+            EXPECT_EQ(actual[sensor].distanceSquared, expected[sensor].distanceSquared);
+            EXPECT_EQ(actual[sensor].position, expected[sensor].position) << "sensor " << sensor;
+        }
+        EXPECT_EQ(parallel.groundHull(), sequential.groundHull());
+        EXPECT_EQ(parallel.nonGroundHull(), sequential.nonGroundHull());
+    }
+}
+
+TEST(LidarVirtualSensorMappingTest, SlotSensorsCoverBothSides)
+{
+    mapping::LidarVirtualSensorMapping mapper;
+    mapper.setVehicleContour({{-0.9F, -1.0F}, {-0.9F, 3.8F}, {0.9F, 3.8F}, {0.9F, -1.0F}});
+    mapping::LidarVirtualSensorMapping::SlotSettings slots;
+    slots.enabled = true;
+    slots.distance = 0.05F;
+    slots.width = 0.1F;
+    slots.range = 4.0F;
+    mapper.setSlotSettings(slots);
+
+    // (4.8 - 0.1) / 0.05 -> 94 pitches, 95 slots per side.
+    ASSERT_EQ(mapper.slotSensorCount(), 190U);
+    ASSERT_EQ(mapper.sensorCount(), mapper.angularSensorCount() + 190U);
+
+    std::mt19937 generator(3U);
+    std::uniform_real_distribution<float> lateral(-6.0F, 6.0F);
+    std::uniform_real_distribution<float> longitudinal(-2.0F, 5.0F);
+    for (int i = 0; i < 3000; ++i)
+    {
+        const glm::vec2 position(lateral(generator), longitudinal(generator));
+        mapper.updatePoints({make_point(position.x, position.y, 0.5F)});
+        const bool insideBody = std::fabs(position.x) < 0.9F && position.y > -1.0F && position.y < 3.8F;
+        const auto snapshots = mapper.snapshots();
+        for (std::size_t sensor = mapper.angularSensorCount(); sensor < snapshots.size(); ++sensor)
+        {
+            const auto& snapshot = snapshots[sensor];
+            const bool expected = !insideBody && bruteForceContains(snapshot, position);
+            ASSERT_EQ(snapshot.valid, expected) << position.x << ", " << position.y;
+            if (expected)
+            {
+                EXPECT_FLOAT_EQ(snapshot.distanceSquared, position.x * position.x);
+            }
+        }
+    }
+
+    // Slot samples stay out of the angular hull.
+    mapper.updatePoints({make_point(2.0F, 1.0F, 0.5F)});
+    EXPECT_EQ(mapper.hull().size(), 1U);
+}
+
+TEST(SensorBinLookupTest, SlotLookupMatchesLinearScan)
+{
+    std::vector<mapping::OrthogonalSlotLookup::Slot> slots;
+    for (std::size_t i = 0; i < 150U; ++i)
+    {
+        const float start = 0.3F * static_cast<float>(i);
+        slots.push_back({start, start + 0.7F, i});
+    }
+    mapping::OrthogonalSlotLookup lookup;
+    lookup.build(slots, 0.15F);
+
+    for (float key = -1.0F; key < 47.0F; key += 0.01F)
+    {
+        std::vector<std::size_t> expected;
+        for (const auto& slot : slots)
+        {
+            if (key >= slot.minKey && key <= slot.maxKey)
+            {
+                expected.push_back(slot.sensorIndex);
+            }
+        }
+        std::vector<std::size_t> actual;
+        lookup.forEachCandidate(key, [&](std::size_t index) { actual.push_back(index); });
+        std::sort(actual.begin(), actual.end());
+        ASSERT_EQ(actual, expected) << key;
+    }
+}
+
+TEST(LidarVirtualSensorMappingTest, HeightBandsMatchFilteredClouds)
+{
+    const std::vector<mapping::LidarVirtualSensorMapping::HeightBand> bands{
+        {0.05F, 0.25F}, {0.25F, 0.7F}, {0.6F, 1.2F}, {1.2F, 2.5F}};
+    const std::vector<glm::vec2> contour{{-0.9F, -2.4F}, {-0.9F, 2.1F}, {0.9F, 2.1F}, {0.9F, -2.4F}};
+
+    std::mt19937 generator(9U);
+    std::uniform_real_distribution<float> coordinate(-20.0F, 20.0F);
+    std::uniform_real_distribution<float> height(-1.8F, 1.0F);
+    lidar::BaseLidarSensor::PointCloud cloud;
+    for (int i = 0; i < 30000; ++i)
+    {
+        cloud.push_back(make_point(coordinate(generator), coordinate(generator), height(generator)));
+    }
+
+    lidar::ThreadPool pool(3U);
+    mapping::LidarVirtualSensorMapping mapper;
+    mapper.setVehicleContour(contour);
+    mapper.setHeightBands(bands);
+    mapper.setThreadPool(&pool);
+    mapper.updatePoints(cloud);
+    ASSERT_EQ(mapper.heightBands().size(), bands.size());
+
+    for (std::size_t band = 0; band < bands.size(); ++band)
+    {
+        lidar::BaseLidarSensor::PointCloud filtered;
+        for (const auto& point : cloud)
+        {
+            const float aboveFloor = point.z + 1.8F;
+            if (aboveFloor >= bands[band].minHeight && aboveFloor < bands[band].maxHeight)
+            {
+                filtered.push_back(point);
+            }
+        }
+        mapping::LidarVirtualSensorMapping reference;
+        reference.setVehicleContour(contour);
+        reference.updatePoints(filtered);
+
+        const auto expected = reference.sensorArrays();
+        const auto actual = mapper.bandArrays(band);
+        ASSERT_EQ(actual.valid.size(), expected.valid.size());
+        for (std::size_t sensor = 0; sensor < actual.valid.size(); ++sensor)
+        {
+            EXPECT_EQ(actual.valid[sensor], expected.valid[sensor]);
+            EXPECT_EQ(actual.distanceSquared[sensor], expected.distanceSquared[sensor]);
+        }
+    }
+    EXPECT_TRUE(mapper.bandArrays(bands.size()).valid.empty());
+}
+
+TEST(FreeSpaceAccumulatorTest, MinimumOfFramesHoldsNearestWithinWindow)
+{
+    mapping::FreeSpaceAccumulator accumulator;
+    accumulator.configure({mapping::FreeSpaceFilter::MinimumOfFrames, 3U});
+    accumulator.reset(2U);
+
+    const auto frame = [&](bool hit, float distanceSquared) {
+        std::vector<uint8_t> valid{static_cast<uint8_t>(hit ? 1U : 0U), 0U};
+        std::vector<float> distance{distanceSquared, std::numeric_limits<float>::max()};
+        std::vector<glm::vec2> position{glm::vec2(std::sqrt(distanceSquared), 0.0F), glm::vec2(0.0F)};
+        accumulator.update(valid, distance, position);
+        return std::make_pair(valid[0] != 0U, distance[0]);
+    };
+
+    EXPECT_EQ(frame(true, 16.0F), std::make_pair(true, 16.0F));
+    EXPECT_EQ(frame(true, 25.0F), std::make_pair(true, 16.0F));
+    EXPECT_EQ(frame(false, 0.0F), std::make_pair(true, 16.0F));
+    EXPECT_FLOAT_EQ(accumulator.confidence()[0], 2.0F / 3.0F);
+    EXPECT_FLOAT_EQ(accumulator.confidence()[1], 0.0F);
+    // The 16 m^2 hit leaves the three-frame window; the 25 m^2 one is still inside.
+    EXPECT_EQ(frame(false, 0.0F), std::make_pair(true, 25.0F));
+    EXPECT_EQ(frame(false, 0.0F).first, false);
+    EXPECT_FLOAT_EQ(accumulator.confidence()[0], 0.0F);
+}
+
+TEST(FreeSpaceAccumulatorTest, ExponentialDecayReleasesStaleObstacles)
+{
+    mapping::FreeSpaceAccumulatorSettings settings;
+    settings.filter = mapping::FreeSpaceFilter::ExponentialDecay;
+    settings.decay = 0.5F;
+    settings.holdThreshold = 0.2F;
+    mapping::FreeSpaceAccumulator accumulator;
+    accumulator.configure(settings);
+
+    const auto frame = [&](bool hit, float distanceSquared) {
+        std::vector<uint8_t> valid{static_cast<uint8_t>(hit ? 1U : 0U)};
+        std::vector<float> distance{hit ? distanceSquared : std::numeric_limits<float>::max()};
+        std::vector<glm::vec2> position{glm::vec2(0.0F)};
+        accumulator.update(valid, distance, position);
+        return std::make_pair(valid[0] != 0U, distance[0]);
+    };
+
+    EXPECT_EQ(frame(true, 9.0F), std::make_pair(true, 9.0F));
+    // A farther return does not override a fresh obstacle; a nearer one does.
+    EXPECT_EQ(frame(true, 20.0F), std::make_pair(true, 9.0F));
+    EXPECT_EQ(frame(true, 4.0F), std::make_pair(true, 4.0F));
+    EXPECT_EQ(frame(false, 0.0F), std::make_pair(true, 4.0F));   // weight 0.5
+    EXPECT_EQ(frame(false, 0.0F), std::make_pair(true, 4.0F));   // weight 0.25
+    EXPECT_EQ(frame(false, 0.0F).first, false);                  // weight 0.125
+    EXPECT_EQ(frame(true, 30.0F), std::make_pair(true, 30.0F));
+}
+
+TEST(LidarVirtualSensorMappingTest, AccumulatorSmoothsEmptyFrames)
+{
+    mapping::LidarVirtualSensorMapping mapper;
+    mapper.setAccumulatorSettings({mapping::FreeSpaceFilter::MinimumOfFrames, 4U});
+    mapper.updatePoints({make_point(6.0F, 0.5F, 0.5F)});
+    mapper.updatePoints({});
+
+    const auto snapshots = mapper.snapshots();
+    const auto hit = std::find_if(snapshots.begin(), snapshots.end(), [](const auto& snapshot) { return snapshot.valid; });
+    ASSERT_NE(hit, snapshots.end());
+    EXPECT_FLOAT_EQ(hit->confidence, 0.5F);
+    EXPECT_EQ(mapper.hull().size(), 1U);
+}
+
+TEST(LidarVirtualSensorMappingTest, EgoMotionMovesHeldObstacles)
+{
+    for (const auto filter : {mapping::FreeSpaceFilter::MinimumOfFrames, mapping::FreeSpaceFilter::ExponentialDecay})
+    {
+        mapping::LidarVirtualSensorMapping mapper;
+        mapper.setAccumulatorSettings({filter, 4U});
+        const glm::vec2 obstacle(10.0F, 0.4F);
+        mapper.updatePoints({make_point(obstacle.x, obstacle.y, 0.5F)});
+        const auto hitSensor = [&mapper]() {
+            const auto arrays = mapper.sensorArrays();
+            return static_cast<std::size_t>(std::find(arrays.valid.begin(), arrays.valid.end(), 1U) - arrays.valid.begin());
+        };
+        const std::size_t sensor = hitSensor();
+        ASSERT_LT(sensor, mapper.angularSensorCount());
+
+        // Driving 2 m forward brings the held obstacle 2 m closer.
+        mapper.compensateEgoMotion({0.0F, glm::vec2(-2.0F, 0.0F)});
+        mapper.updatePoints({});
+        auto arrays = mapper.sensorArrays();
+        ASSERT_EQ(hitSensor(), sensor);
+        EXPECT_NEAR(arrays.position[sensor].x, 8.0F, 1e-4F);
+        EXPECT_NEAR(arrays.distanceSquared[sensor], 64.0F + 0.16F, 1e-3F);
+
+        // Sliding sideways moves it out of its bin, where it is dropped rather than smeared.
+        mapper.compensateEgoMotion({0.0F, glm::vec2(0.0F, -1.0F)});
+        mapper.updatePoints({});
+        arrays = mapper.sensorArrays();
+        EXPECT_EQ(arrays.valid[sensor], 0U);
+    }
+}
+
+TEST(LidarVirtualSensorMappingTest, PublishesOneFramePerUpdate)
+{
+    mapping::LidarVirtualSensorMapping mapper;
+    const uint64_t initialVersion = mapper.frameVersion();
+    const auto before = mapper.latestFrame();
+    ASSERT_TRUE(before);
+
+    mapper.updatePoints({make_point(6.0F, 0.5F, 0.5F)});
+    const auto frame = mapper.latestFrame();
+    EXPECT_EQ(frame->version, initialVersion + 1U);
+    EXPECT_EQ(mapper.frameVersion(), frame->version);
+
+    const auto snapshots = mapper.snapshots();
+    ASSERT_EQ(frame->sensors.size(), snapshots.size());
+    for (std::size_t i = 0; i < snapshots.size(); ++i)
+    {
+        EXPECT_EQ(frame->sensors[i].valid, snapshots[i].valid);
+        EXPECT_EQ(frame->sensors[i].position, snapshots[i].position);
+    }
+    EXPECT_EQ(frame->hull.size(), 1U);
+
+    // Handles stay valid and unchanged while the mapper keeps publishing.
+    mapper.updatePoints({});
+    mapper.updatePoints({});
+    EXPECT_EQ(frame->hull.size(), 1U);
+    EXPECT_EQ(mapper.latestFrame()->version, initialVersion + 3U);
+    EXPECT_TRUE(mapper.latestFrame()->hull.empty());
+}
+
+TEST(SnapshotPublisherTest, ReusesBuffersNotHeldByReaders)
+{
+    mapping::SnapshotPublisher<std::vector<int>> publisher;
+    EXPECT_FALSE(publisher.latest());
+
+    std::vector<const std::vector<int>*> buffers;
+    for (int i = 1; i <= 6; ++i)
+    {
+        auto& buffer = publisher.beginWrite();
+        buffer.assign(1U, i);
+        EXPECT_EQ(publisher.publish(), static_cast<uint64_t>(i));
+        buffers.push_back(publisher.latest().get());
+    }
+    std::sort(buffers.begin(), buffers.end());
+    EXPECT_LE(std::unique(buffers.begin(), buffers.end()) - buffers.begin(), 3);
+
+    // Every held buffer is skipped, so the writer falls back to a fresh one.
+    const auto first = publisher.latest();
+    publisher.beginWrite().assign(1U, 7);
+    publisher.publish();
+    const auto second = publisher.latest();
+    publisher.beginWrite().assign(1U, 8);
+    publisher.publish();
+    const auto third = publisher.latest();
+    publisher.beginWrite().assign(1U, 9);
+    publisher.publish();
+    EXPECT_EQ(first->front(), 6);
+    EXPECT_EQ(second->front(), 7);
+    EXPECT_EQ(third->front(), 8);
+    EXPECT_EQ(publisher.latest()->front(), 9);
+    EXPECT_EQ(publisher.version(), 9U);
+}
+
+TEST(SnapshotPublisherTest, HandlesOutliveThePublisher)
+{
+    std::shared_ptr<const std::vector<int>> held;
+    {
+        mapping::SnapshotPublisher<std::vector<int>> publisher;
+        publisher.beginWrite().assign(4U, 1);
+        publisher.publish();
+        held = publisher.latest();
+        // The held buffer is neither published nor free, so the next writes skip it.
+        for (int i = 2; i <= 4; ++i)
+        {
+            auto& buffer = publisher.beginWrite();
+            EXPECT_NE(&buffer, held.get());
+            buffer.assign(4U, i);
+            publisher.publish();
+        }
+    }
+    EXPECT_EQ(*held, std::vector<int>(4U, 1));
+}
+
+TEST(ContourMaskTest, MatchesExactCrossingTest)
+{
+    // Concave outline with a notch, similar to a vehicle with mirrors.
+    const std::vector<glm::vec2> contour{
+        {-1.0F, -2.5F}, {1.0F, -2.5F}, {1.0F, 0.8F}, {1.2F, 0.9F}, {1.2F, 1.1F},
+        {1.0F, 1.2F}, {0.9F, 2.3F}, {0.0F, 1.7F}, {-0.9F, 2.3F}, {-1.0F, 1.2F}};
+    glm::vec2 center(0.0F);
+    for (const auto& vertex : contour)
+    {
+        center += vertex;
+    }
+    center /= static_cast<float>(contour.size());
+    float radius = 0.0F;
+    for (const auto& vertex : contour)
+    {
+        radius = std::max(radius, glm::length(vertex - center));
+    }
+
+    mapping::ContourMask mask;
+    mask.build(contour, center, radius);
+
+    std::vector<glm::vec2> positions;
+    for (std::size_t i = 0; i < contour.size(); ++i)
+    {
+        const glm::vec2& a = contour[i];
+        const glm::vec2& b = contour[(i + 1U) % contour.size()];
+        for (int step = 0; step <= 16; ++step)
+        {
+            positions.push_back(glm::mix(a, b, static_cast<float>(step) / 16.0F));
+        }
+    }
+    std::mt19937 generator(11U);
+    std::uniform_real_distribution<float> coordinate(-3.0F, 3.0F);
+    for (int i = 0; i < 50000; ++i)
+    {
+        positions.emplace_back(coordinate(generator), coordinate(generator));
+    }
+
+    std::size_t rasterAnswers = 0U;
+    for (const auto& position : positions)
+    {
+        ASSERT_EQ(mask.contains(position), mapping::ContourMask::crossingTest(contour, position))
+            << position.x << ", " << position.y;
+        rasterAnswers += mask.region(position) != mapping::ContourMask::Region::Boundary ? 1U : 0U;
+    }
+    EXPECT_GT(rasterAnswers, positions.size() * 9U / 10U);
+
+    EXPECT_EQ(mask.region({80.0F, 0.0F}), mapping::ContourMask::Region::Outside);
+    EXPECT_EQ(mask.region({0.0F, 0.0F}), mapping::ContourMask::Region::Inside);
+}
+
+TEST(LidarVirtualSensorMappingTest, ContourMaskFollowsSameSizedContour)
+{
+    mapping::LidarVirtualSensorMapping mapper;
+    mapper.setVehicleContour({{-1.0F, -1.0F}, {-1.0F, 1.0F}, {1.0F, 1.0F}, {1.0F, -1.0F}});
+    // Same centroid and radius, rotated by 45 degrees: only the mask changes.
+    const float diagonal = std::sqrt(2.0F);
+    mapper.setVehicleContour({{0.0F, -diagonal}, {-diagonal, 0.0F}, {0.0F, diagonal}, {diagonal, 0.0F}});
+
+    mapper.updatePoints({make_point(0.9F, 0.9F, 0.5F)});
+
+    EXPECT_FALSE(mapper.nonGroundHull().empty());
+}
+
+TEST(ContourClearanceTest, DistanceStaysWithinInterpolationError)
+{
+    mapping::ContourClearance clearance;
+    clearance.setContour({{-1.0F, -2.5F}, {1.0F, -2.5F}, {1.0F, 2.0F}, {0.0F, 2.6F}, {-1.0F, 2.0F}});
+
+    std::mt19937 generator(3U);
+    std::uniform_real_distribution<float> coordinate(-6.0F, 6.0F);
+    for (int i = 0; i < 20000; ++i)
+    {
+        const glm::vec2 point(coordinate(generator), coordinate(generator));
+        const float exact = clearance.exactDistance(point);
+        ASSERT_NEAR(clearance.distance(point), exact, clearance.interpolationError() + 1e-5F);
+        if (exact < 0.05F)
+        {
+            ASSERT_FLOAT_EQ(clearance.distance(point), exact);
+        }
+    }
+
+    EXPECT_LT(clearance.signedDistance({0.0F, 0.0F}), 0.0F);
+    EXPECT_NEAR(clearance.signedDistance({3.0F, 0.0F}), 2.0F, 1e-5F);
+}
+
+TEST(ContourClearanceTest, ClosestPointsMatchBruteForce)
+{
+    mapping::ContourClearance clearance;
+    clearance.setContour({{-1.0F, -2.5F}, {1.0F, -2.5F}, {1.0F, 2.0F}, {-1.0F, 2.0F}});
+
+    lidar::BaseLidarSensor::PointCloud points;
+    std::mt19937 generator(5U);
+    std::uniform_real_distribution<float> coordinate(-40.0F, 40.0F);
+    for (int i = 0; i < 5000; ++i)
+    {
+        points.push_back(make_point(coordinate(generator), coordinate(generator), 0.0F));
+    }
+
+    std::vector<float> expected;
+    for (const auto& point : points)
+    {
+        expected.push_back(clearance.exactDistance({point.x, point.y}));
+    }
+    std::sort(expected.begin(), expected.end());
+
+    std::vector<mapping::ContourClearance::ClearancePoint> closest;
+    clearance.closestPoints(points, 8U, closest);
+    ASSERT_EQ(closest.size(), 8U);
+    for (std::size_t i = 0; i < closest.size(); ++i)
+    {
+        EXPECT_FLOAT_EQ(closest[i].distance, expected[i]);
+        EXPECT_FLOAT_EQ(clearance.exactDistance(closest[i].position), closest[i].distance);
+    }
+}
+
+TEST(GroundSegmentationTest, ThresholdModeMatchesHeightCut)
+{
+    mapping::GroundSegmentationSettings settings;
+    settings.mode = mapping::GroundSegmentationMode::HeightThreshold;
+    settings.heightThreshold = -1.0F;
+    mapping::GroundSegmentation segmentation(settings);
+
+    const lidar::BaseLidarSensor::PointCloud points{
+        make_point(1.0F, 2.0F, -1.5F), make_point(3.0F, 1.0F, -1.0F), make_point(-2.0F, 4.0F, 0.2F)};
+    lidar::BaseLidarSensor::PointCloud ground;
+    lidar::BaseLidarSensor::PointCloud nonGround;
+    segmentation.segment(points, glm::vec2(0.0F), ground, nonGround);
+    ASSERT_EQ(ground.size(), 2U);
+    ASSERT_EQ(nonGround.size(), 1U);
+    EXPECT_FLOAT_EQ(nonGround.front().z, 0.2F);
+}
+
+TEST(GroundSegmentationTest, SensorTiltLevelsTheThresholdPlane)
+{
+    mapping::GroundSegmentationSettings settings;
+    settings.mode = mapping::GroundSegmentationMode::HeightThreshold;
+    settings.heightThreshold = -1.0F;
+    mapping::GroundSegmentation segmentation(settings);
+
+    // Road 20 m ahead and behind, seen by a sensor pitched by 0.05 rad.
+    const lidar::BaseLidarSensor::PointCloud points{make_point(20.0F, 0.0F, -0.2F), make_point(-20.0F, 0.0F, -1.5F)};
+    lidar::BaseLidarSensor::PointCloud ground;
+    lidar::BaseLidarSensor::PointCloud nonGround;
+    segmentation.segment(points, glm::vec2(0.0F), ground, nonGround);
+    ASSERT_EQ(ground.size(), 1U);
+    EXPECT_FLOAT_EQ(ground.front().x, -20.0F);
+
+    segmentation.setSensorTilt(0.0F, 0.05F);
+    segmentation.segment(points, glm::vec2(0.0F), ground, nonGround);
+    ASSERT_EQ(ground.size(), 1U);
+    EXPECT_FLOAT_EQ(ground.front().x, 20.0F);
+    EXPECT_NEAR(segmentation.groundHeight(glm::vec2(20.0F, 0.0F)) + settings.distanceThreshold, 0.0F, 2e-3F);
+
+    // Rolled left side up, the road on the right rises in the point frame.
+    segmentation.setSensorTilt(0.05F, 0.0F);
+    EXPECT_GT(segmentation.groundHeight(glm::vec2(0.0F, -20.0F)), segmentation.groundHeight(glm::vec2(0.0F, 20.0F)));
+}
+
+TEST(GroundSegmentationTest, PlaneFitFollowsSlopeAndRejectsRoofs)
+{
+    // Road climbing at 10 % ahead of the sensor, a low box on it and a wide roof hiding the ground.
+    const auto groundZ = [](float y) { return -1.8F + 0.1F * y; };
+    const auto underRoof = [](float x, float y) { return x > 8.0F && x < 16.0F && y > -4.0F && y < 4.0F; };
+    lidar::BaseLidarSensor::PointCloud points;
+    std::size_t groundCount = 0U;
+    for (int step = 0; step < 360; ++step)
+    {
+        const float angle = glm::two_pi<float>() * static_cast<float>(step) / 360.0F;
+        for (float range = 2.0F; range < 40.0F; range += 0.3F)
+        {
+            const float x = range * std::cos(angle);
+            const float y = range * std::sin(angle);
+            if (!underRoof(x, y))
+            {
+                points.push_back(make_point(x, y, groundZ(y)));
+                ++groundCount;
+            }
+        }
+    }
+    for (float x = -0.5F; x <= 0.5F; x += 0.1F)
+    {
+        for (float dz = 0.4F; dz <= 1.0F; dz += 0.1F)
+        {
+            points.push_back(make_point(x, 20.0F, groundZ(20.0F) + dz));
+        }
+    }
+    for (float x = 8.2F; x < 16.0F; x += 0.2F)
+    {
+        for (float y = -3.8F; y < 4.0F; y += 0.2F)
+        {
+            points.push_back(make_point(x, y, groundZ(y) + 1.4F));
+        }
+    }
+
+    mapping::GroundSegmentationSettings settings;
+    settings.heightThreshold = -1.5F;
+    mapping::GroundSegmentation segmentation(settings);
+    lidar::BaseLidarSensor::PointCloud ground;
+    lidar::BaseLidarSensor::PointCloud nonGround;
+    segmentation.segment(points, glm::vec2(0.0F), ground, nonGround);
+
+    EXPECT_EQ(ground.size(), groundCount);
+    EXPECT_EQ(ground.size() + nonGround.size(), points.size());
+    for (const auto& point : ground)
+    {
+        EXPECT_NEAR(point.z, groundZ(point.y), 1e-4F);
+    }
+    EXPECT_NEAR(segmentation.groundHeight(glm::vec2(0.0F, 30.0F)), groundZ(30.0F), 0.05F);
+
+    // A flat cut cannot follow the slope.
+    settings.mode = mapping::GroundSegmentationMode::HeightThreshold;
+    segmentation.configure(settings);
+    segmentation.segment(points, glm::vec2(0.0F), ground, nonGround);
+    EXPECT_LT(ground.size(), groundCount);
+}
+
+TEST(VoxelGridFilterTest, ReducesEachVoxel)
+{
+    // Two points straddle zero, so they must land in different voxels.
+    const lidar::BaseLidarSensor::PointCloud points{{0.02F, 0.02F, 0.03F, 1.0F},
+                                                    {0.06F, 0.04F, 0.01F, 3.0F},
+                                                    {-0.02F, 0.02F, 0.0F, 5.0F}};
+    lidar::BaseLidarSensor::PointCloud output;
+
+    mapping::VoxelGridFilter filter({0.1F, mapping::VoxelReduction::Centroid, mapping::VoxelGridMethod::Hash});
+    filter.filter(points, output);
+    ASSERT_EQ(output.size(), 2U);
+    EXPECT_FLOAT_EQ(output[0].x, 0.04F);
+    EXPECT_FLOAT_EQ(output[0].z, 0.02F);
+    EXPECT_FLOAT_EQ(output[0].intensity, 2.0F);
+    EXPECT_FLOAT_EQ(output[1].x, -0.02F);
+
+    filter.configure({0.1F, mapping::VoxelReduction::MinZ, mapping::VoxelGridMethod::Hash});
+    filter.filter(points, output);
+    ASSERT_EQ(output.size(), 2U);
+    EXPECT_FLOAT_EQ(output[0].z, 0.01F);
+
+    filter.configure({0.1F, mapping::VoxelReduction::FirstPoint, mapping::VoxelGridMethod::RadixSort});
+    filter.filter(points, output);
+    ASSERT_EQ(output.size(), 2U);
+    const auto first = std::find_if(output.begin(), output.end(), [](const auto& point) { return point.x > 0.0F; });
+    ASSERT_NE(first, output.end());
+    EXPECT_FLOAT_EQ(first->z, 0.03F);
+}
+
+TEST(VoxelGridFilterTest, RadixSortMatchesHash)
+{
+    std::mt19937 rng(7U);
+    std::uniform_real_distribution<float> coordinate(-20.0F, 20.0F);
+    lidar::BaseLidarSensor::PointCloud points(20000U);
+    for (auto& point : points)
+    {
+        point = {coordinate(rng), coordinate(rng), coordinate(rng) * 0.1F, coordinate(rng)};
+    }
+    const auto byPosition = [](const lidar::LidarPoint& a, const lidar::LidarPoint& b)
+    { return std::tie(a.x, a.y, a.z) < std::tie(b.x, b.y, b.z); };
+
+    for (const auto reduction :
+         {mapping::VoxelReduction::Centroid, mapping::VoxelReduction::MinZ, mapping::VoxelReduction::FirstPoint})
+    {
+        mapping::VoxelGridFilter hash({0.5F, reduction, mapping::VoxelGridMethod::Hash});
+        mapping::VoxelGridFilter radix({0.5F, reduction, mapping::VoxelGridMethod::RadixSort});
+        lidar::BaseLidarSensor::PointCloud hashed;
+        lidar::BaseLidarSensor::PointCloud sorted;
+        hash.filter(points, hashed);
+        // A second frame exercises the reused arena.
+        hash.filter(points, hashed);
+        radix.filter(points, sorted);
+        ASSERT_EQ(hashed.size(), sorted.size());
+        EXPECT_LT(hashed.size(), points.size());
+
+        std::sort(hashed.begin(), hashed.end(), byPosition);
+        std::sort(sorted.begin(), sorted.end(), byPosition);
+        for (std::size_t i = 0; i < hashed.size(); ++i)
+        {
+            EXPECT_NEAR(hashed[i].x, sorted[i].x, 1e-4F);
+            EXPECT_NEAR(hashed[i].y, sorted[i].y, 1e-4F);
+            EXPECT_NEAR(hashed[i].z, sorted[i].z, 1e-4F);
+        }
+    }
+}
+
+TEST(EuclideanClusteringTest, SeparatesObjectsAndFitsOrientedBoxes)
+{
+    lidar::BaseLidarSensor::PointCloud points;
+    // A 4 m x 1 m wall turned 30 degrees, sampled every 0.2 m.
+    const float angle = 0.5235988F;
+    const glm::vec2 axis(std::cos(angle), std::sin(angle));
+    const glm::vec2 normal(-axis.y, axis.x);
+    for (int i = 0; i <= 20; ++i)
+    {
+        for (int j = 0; j <= 5; ++j)
+        {
+            const glm::vec2 position = glm::vec2(10.0F, 5.0F) + axis * (-2.0F + 0.2F * static_cast<float>(i))
+                                       + normal * (-0.5F + 0.2F * static_cast<float>(j));
+            points.push_back(make_point(position.x, position.y, 0.5F + 0.05F * static_cast<float>(j)));
+        }
+    }
+    // A small post 3 m away and a stray return too small to count.
+    for (int i = 0; i < 6; ++i)
+    {
+        points.push_back(make_point(-3.0F + 0.1F * static_cast<float>(i % 2), 0.1F * static_cast<float>(i / 2), 1.0F));
+    }
+    points.push_back(make_point(0.0F, -8.0F, 0.2F));
+
+    mapping::EuclideanClustering clustering({0.5F, 5U});
+    clustering.cluster(points);
+    ASSERT_EQ(clustering.clusters().size(), 2U);
+    EXPECT_EQ(clustering.labels().back(), mapping::EuclideanClustering::kNoCluster);
+
+    const auto& wall = clustering.clusters()[clustering.labels().front()];
+    EXPECT_EQ(wall.pointCount, 126U);
+    EXPECT_NEAR(wall.centroid.x, 10.0F, 1e-3F);
+    EXPECT_NEAR(wall.centroid.y, 5.0F, 1e-3F);
+    EXPECT_FLOAT_EQ(wall.minZ, 0.5F);
+    EXPECT_FLOAT_EQ(wall.maxZ, 0.75F);
+    // The principal axis is only defined up to a half turn.
+    EXPECT_NEAR(std::sin(wall.orientation - angle), 0.0F, 1e-3F);
+    EXPECT_NEAR(wall.orientedHalfExtents.x, 2.0F, 1e-3F);
+    EXPECT_NEAR(wall.orientedHalfExtents.y, 0.5F, 1e-3F);
+    for (const auto& corner : wall.orientedCorners())
+    {
+        EXPECT_NEAR(glm::length(corner - glm::vec2(10.0F, 5.0F)), std::sqrt(4.25F), 1e-3F);
+    }
+
+    const auto& post = clustering.clusters()[clustering.labels()[points.size() - 2U]];
+    EXPECT_EQ(post.pointCount, 6U);
+    EXPECT_NEAR(post.boundsMin.x, -3.0F, 1e-5F);
+    EXPECT_NEAR(post.boundsMax.x, -2.9F, 1e-5F);
+    EXPECT_NEAR(post.boundsMax.y, 0.2F, 1e-5F);
+
+    // A larger cap turns the wall into noise.
+    clustering.configure({0.5F, 5U, 100U});
+    clustering.cluster(points);
+    ASSERT_EQ(clustering.clusters().size(), 1U);
+    EXPECT_EQ(clustering.labels().front(), mapping::EuclideanClustering::kNoCluster);
+}
+
+TEST(EuclideanClusteringTest, MatchesBruteForceComponents)
+{
+    std::mt19937 rng(11U);
+    std::uniform_real_distribution<float> coordinate(-15.0F, 15.0F);
+    lidar::BaseLidarSensor::PointCloud points(1500U);
+    for (auto& point : points)
+    {
+        point = make_point(coordinate(rng), coordinate(rng), 0.0F);
+    }
+
+    constexpr float kTolerance = 0.6F;
+    std::vector<std::size_t> component(points.size());
+    for (std::size_t i = 0; i < points.size(); ++i)
+    {
+        component[i] = i;
+    }
+    const auto root = [&component](std::size_t i) {
+        while (component[i] != i)
+        {
+            i = component[i];
+        }
+        return i;
+    };
+    for (std::size_t i = 0; i < points.size(); ++i)
+    {
+        for (std::size_t j = i + 1U; j < points.size(); ++j)
+        {
+            const float dx = points[i].x - points[j].x;
+            const float dy = points[i].y - points[j].y;
+            if (dx * dx + dy * dy <= kTolerance * kTolerance)
+            {
+                component[root(i)] = root(j);
+            }
+        }
+    }
+
+    mapping::EuclideanClustering clustering({kTolerance, 1U});
+    // A second frame exercises the reused buffers.
+    clustering.cluster(points);
+    clustering.cluster(points);
+    const auto& labels = clustering.labels();
+    for (std::size_t i = 0; i < points.size(); ++i)
+    {
+        ASSERT_NE(labels[i], mapping::EuclideanClustering::kNoCluster);
+        for (std::size_t j = i + 1U; j < points.size(); ++j)
+        {
+            ASSERT_EQ(root(i) == root(j), labels[i] == labels[j]) << i << " " << j;
+        }
+    }
+}
+
+TEST(KdTreeTest, QueriesMatchBruteForce)
+{
+    std::mt19937 rng(5U);
+    std::uniform_real_distribution<float> coordinate(-10.0F, 10.0F);
+    // Large enough that the top of the tree is built as pool tasks.
+    lidar::BaseLidarSensor::PointCloud points(40000U);
+    for (auto& point : points)
+    {
+        point = make_point(coordinate(rng), coordinate(rng), coordinate(rng) * 0.2F);
+    }
+    lidar::BaseLidarSensor::PointCloud queries(100U);
+    for (auto& query : queries)
+    {
+        query = make_point(coordinate(rng), coordinate(rng), coordinate(rng) * 0.2F);
+    }
+
+    lidar::ThreadPool pool(3U);
+    mapping::KdTree tree;
+    tree.setThreadPool(&pool);
+    tree.build(points);
+    ASSERT_EQ(tree.size(), points.size());
+
+    constexpr std::size_t kNeighbours = 6U;
+    std::vector<mapping::KdNeighbour> batch;
+    tree.nearestKBatch(queries, kNeighbours, batch);
+    ASSERT_EQ(batch.size(), queries.size() * kNeighbours);
+
+    std::vector<float> expected(points.size());
+    std::vector<mapping::KdNeighbour> inRadius;
+    for (std::size_t q = 0; q < queries.size(); ++q)
+    {
+        const glm::vec3 query(queries[q].x, queries[q].y, queries[q].z);
+        for (std::size_t i = 0; i < points.size(); ++i)
+        {
+            const glm::vec3 delta = glm::vec3(points[i].x, points[i].y, points[i].z) - query;
+            expected[i] = delta.x * delta.x + delta.y * delta.y + delta.z * delta.z;
+        }
+        std::vector<float> sorted = expected;
+        std::partial_sort(sorted.begin(), sorted.begin() + kNeighbours, sorted.end());
+
+        mapping::KdNeighbour closest;
+        ASSERT_TRUE(tree.nearest(query, closest));
+        EXPECT_FLOAT_EQ(expected[closest.index], sorted[0]);
+
+        std::array<mapping::KdNeighbour, kNeighbours> neighbours;
+        ASSERT_EQ(tree.nearestK(query, neighbours), kNeighbours);
+        for (std::size_t j = 0; j < kNeighbours; ++j)
+        {
+            EXPECT_FLOAT_EQ(neighbours[j].distanceSquared, sorted[j]);
+            EXPECT_FLOAT_EQ(expected[neighbours[j].index], sorted[j]);
+            EXPECT_EQ(batch[q * kNeighbours + j].index, neighbours[j].index);
+        }
+
+        tree.radiusSearch(query, 0.5F, inRadius);
+        const auto inside = std::count_if(expected.begin(), expected.end(), [](float d) { return d <= 0.25F; });
+        EXPECT_EQ(static_cast<std::ptrdiff_t>(inRadius.size()), inside);
+        for (const auto& neighbour : inRadius)
+        {
+            EXPECT_LE(expected[neighbour.index], 0.25F);
+        }
+    }
+}
+
+TEST(KdTreeTest, HandlesTreesSmallerThanK)
+{
+    mapping::KdTree tree;
+    mapping::KdNeighbour closest;
+    EXPECT_FALSE(tree.nearest(glm::vec3(0.0F), closest));
+
+    tree.build({make_point(1.0F, 0.0F, 0.0F), make_point(3.0F, 0.0F, 0.0F)});
+    std::array<mapping::KdNeighbour, 4> neighbours;
+    ASSERT_EQ(tree.nearestK(glm::vec3(0.0F), neighbours), 2U);
+    EXPECT_EQ(neighbours[0].index, 0U);
+    EXPECT_FLOAT_EQ(neighbours[1].distanceSquared, 9.0F);
+
+    std::vector<mapping::KdNeighbour> batch;
+    tree.nearestKBatch({make_point(4.0F, 0.0F, 0.0F)}, 3U, batch);
+    ASSERT_EQ(batch.size(), 3U);
+    EXPECT_EQ(batch[0].index, 1U);
+    EXPECT_EQ(batch[2].index, mapping::KdTree::kInvalidIndex);
+}
+
+TEST(ScanRegistrationTest, RecoversMotionBetweenScans)
+{
+    // Ground with three walls constrains all six degrees of freedom.
+    lidar::BaseLidarSensor::PointCloud world;
+    for (float u = -15.0F; u <= 15.0F; u += 0.2F)
+    {
+        for (float v = -15.0F; v <= 15.0F; v += 0.2F)
+        {
+            world.push_back(make_point(u, v, -1.8F));
+        }
+        for (float z = -1.8F; z <= 3.0F; z += 0.2F)
+        {
+            world.push_back(make_point(12.0F, u, z));
+            world.push_back(make_point(u, 10.0F, z));
+            world.push_back(make_point(u, -8.0F, z));
+        }
+    }
+
+    Eigen::Isometry3f motion = Eigen::Isometry3f::Identity();
+    motion.rotate(Eigen::AngleAxisf(0.05F, Eigen::Vector3f::UnitZ()));
+    motion.pretranslate(Eigen::Vector3f(0.5F, 0.1F, 0.0F));
+    // Each scan sees the same world from one more step along the motion.
+    const auto observe = [&world](const Eigen::Isometry3f& pose) {
+        const Eigen::Isometry3f inverse = pose.inverse();
+        lidar::BaseLidarSensor::PointCloud scan;
+        for (const auto& point : world)
+        {
+            const Eigen::Vector3f local = inverse * Eigen::Vector3f(point.x, point.y, point.z);
+            scan.push_back(make_point(local.x(), local.y(), local.z()));
+        }
+        return scan;
+    };
+
+    lidar::ThreadPool pool(2U);
+    mapping::ScanRegistration registration;
+    registration.setThreadPool(&pool);
+    mapping::RegistrationResult result;
+    EXPECT_FALSE(registration.registerScan(observe(Eigen::Isometry3f::Identity()), result));
+
+    ASSERT_TRUE(registration.registerScan(observe(motion), result));
+    EXPECT_TRUE(result.converged);
+    EXPECT_GT(result.correspondences, mapping::ScanRegistration::kMinCorrespondences);
+    EXPECT_LT((result.motion.translation() - motion.translation()).norm(), 0.02F);
+    EXPECT_LT(Eigen::AngleAxisf(result.motion.rotation().transpose() * motion.rotation()).angle(), 0.003F);
+    const std::size_t firstIterations = result.iterations;
+
+    // The constant-velocity guess starts the next scan close to the answer.
+    ASSERT_TRUE(registration.registerScan(observe(motion * motion), result));
+    EXPECT_LE(result.iterations, firstIterations);
+    const Eigen::Isometry3f expected = motion * motion;
+    EXPECT_LT((registration.pose().translation() - expected.translation()).norm(), 0.04F);
+}
+
+TEST(OccupancyGridTest, RayMarksFreeCellsAndHitCell)
+{
+    mapping::OccupancyGridSettings settings;
+    settings.resolution = 0.5F;
+    settings.extent = 20.0F;
+    mapping::OccupancyGrid grid(settings);
+
+    grid.integrate({make_point(5.2F, 0.3F, 0.0F)}, glm::vec2(0.1F, 0.1F));
+    EXPECT_TRUE(grid.occupied(glm::vec2(5.2F, 0.3F)));
+    EXPECT_FLOAT_EQ(grid.logOdds(glm::vec2(2.5F, 0.2F)), settings.missLogOdds);
+    EXPECT_FLOAT_EQ(grid.logOdds(glm::vec2(-3.0F, 0.2F)), 0.0F);
+
+    // Many rays through the same cells still change each cell once per frame, and values clamp.
+    lidar::BaseLidarSensor::PointCloud scan(50U, make_point(5.2F, 0.3F, 0.0F));
+    for (int frame = 0; frame < 20; ++frame)
+    {
+        grid.integrate(scan, glm::vec2(0.1F, 0.1F));
+    }
+    EXPECT_FLOAT_EQ(grid.logOdds(glm::vec2(5.2F, 0.3F)), settings.maxLogOdds);
+    EXPECT_FLOAT_EQ(grid.logOdds(glm::vec2(2.5F, 0.2F)), settings.minLogOdds);
+}
+
+TEST(OccupancyGridTest, BinnedMissRaysLeaveNoHolesInsideScan)
+{
+    mapping::OccupancyGrid grid;
+    lidar::BaseLidarSensor::PointCloud scan;
+    for (int azimuth = 0; azimuth < 1800; ++azimuth)
+    {
+        const float angle = glm::two_pi<float>() * static_cast<float>(azimuth) / 1800.0F;
+        const float range = 12.0F + 6.0F * std::sin(3.0F * angle);
+        scan.push_back(make_point(range * std::cos(angle), range * std::sin(angle), 0.0F));
+        scan.push_back(make_point(0.5F * range * std::cos(angle), 0.5F * range * std::sin(angle), 0.0F));
+    }
+    grid.integrate(scan, glm::vec2(0.0F));
+
+    const float resolution = grid.settings().resolution;
+    for (float y = -17.95F; y < 18.0F; y += resolution)
+    {
+        for (float x = -17.95F; x < 18.0F; x += resolution)
+        {
+            const float angle = std::atan2(y, x);
+            const float radius = std::sqrt(x * x + y * y);
+            const float range = 12.0F + 6.0F * std::sin(3.0F * angle);
+            const float nearRange = 0.5F * range;
+            // Cells a couple of cells away from either return ring must have been cleared.
+            if (radius < range - 3.0F * resolution && std::fabs(radius - nearRange) > 3.0F * resolution)
+            {
+                ASSERT_LT(grid.logOdds(glm::vec2(x, y)), 0.0F) << x << ", " << y;
+            }
+        }
+    }
+    EXPECT_TRUE(grid.occupied(glm::vec2(6.0F, 0.0F)));
+}
+
+TEST(OccupancyGridTest, ReturnsBeyondWindowOnlyClearCells)
+{
+    mapping::OccupancyGridSettings settings;
+    settings.resolution = 0.25F;
+    settings.extent = 8.0F;
+    mapping::OccupancyGrid grid(settings);
+
+    grid.integrate({make_point(30.0F, 30.0F, 0.0F)}, glm::vec2(0.0F));
+    EXPECT_FLOAT_EQ(grid.logOdds(glm::vec2(2.0F, 2.0F)), settings.missLogOdds);
+    EXPECT_FLOAT_EQ(grid.logOdds(glm::vec2(3.9F, 3.9F)), settings.missLogOdds);
+    EXPECT_FLOAT_EQ(grid.logOdds(glm::vec2(30.0F, 30.0F)), 0.0F);
+}
+
+TEST(OccupancyGridTest, RecenterKeepsOverlapAndClearsScrolledInCells)
+{
+    mapping::OccupancyGridSettings settings;
+    settings.resolution = 0.5F;
+    settings.extent = 16.0F;
+    mapping::OccupancyGrid grid(settings);
+    ASSERT_EQ(grid.cellsPerSide() % mapping::OccupancyGrid::kTileSize, 0);
+
+    std::mt19937 generator(21U);
+    std::uniform_real_distribution<float> coordinate(-7.5F, 7.5F);
+    lidar::BaseLidarSensor::PointCloud scan;
+    for (int i = 0; i < 200; ++i)
+    {
+        scan.push_back(make_point(coordinate(generator), coordinate(generator), 0.0F));
+    }
+    grid.integrate(scan, glm::vec2(0.0F));
+
+    std::vector<std::pair<glm::vec2, float>> before;
+    for (float y = -7.75F; y < 8.0F; y += 0.5F)
+    {
+        for (float x = -7.75F; x < 8.0F; x += 0.5F)
+        {
+            before.emplace_back(glm::vec2(x, y), grid.logOdds(glm::vec2(x, y)));
+        }
+    }
+
+    const glm::vec2 shift(3.0F, -2.0F);
+    grid.recenter(shift);
+    const glm::vec2 windowMin = grid.windowOrigin();
+    const float windowSize = static_cast<float>(grid.cellsPerSide()) * settings.resolution;
+    for (const auto& [position, value] : before)
+    {
+        const bool stillInside = position.x >= windowMin.x && position.x < windowMin.x + windowSize
+                                 && position.y >= windowMin.y && position.y < windowMin.y + windowSize;
+        EXPECT_FLOAT_EQ(grid.logOdds(position), stillInside ? value : 0.0F);
+    }
+    // Cells that scrolled in start unknown even though their storage was reused.
+    for (float y = windowMin.y + 0.25F; y < windowMin.y + windowSize; y += 0.5F)
+    {
+        EXPECT_FLOAT_EQ(grid.logOdds(glm::vec2(windowMin.x + windowSize - 0.25F, y)), 0.0F);
+    }
+}
+
+TEST(LidarVirtualSensorMappingTest, CloseBinStaysAVertexOfTheHull)
+{
+    // Free space out to 10 m all round, except two adjacent bins that see an obstacle at 3 m.
+    mapping::LidarVirtualSensorMapping mapper;
+    const std::size_t bins = mapper.angularSensorCount();
+    lidar::BaseLidarSensor::PointCloud points;
+    std::vector<glm::vec2> close;
+    for (std::size_t i = 0; i < bins; ++i)
+    {
+        const float angle = (static_cast<float>(i) + 0.5F) * glm::two_pi<float>() / static_cast<float>(bins);
+        const float range = i == 10U || i == 11U ? 3.0F : 10.0F;
+        points.push_back(make_point(range * std::cos(angle), range * std::sin(angle), 0.5F));
+        if (range < 10.0F)
+        {
+            close.emplace_back(points.back().x, points.back().y);
+        }
+    }
+    mapper.setEnvelopeEnabled(true);
+    mapper.setEnvelopeSettings({mapping::HullShape::Convex});
+    mapper.updatePoints(points);
+
+    const auto& hull = mapper.hull();
+    ASSERT_EQ(hull.size(), bins);
+    EXPECT_TRUE(isSimplePolygon(hull));
+    for (const auto& point : close)
+    {
+        EXPECT_NE(std::find(hull.begin(), hull.end(), point), hull.end());
+        EXPECT_FALSE(polygonContains(hull, point * 1.5F));
+    }
+    ASSERT_NE(mapper.latestFrame(), nullptr);
+    EXPECT_EQ(mapper.latestFrame()->hull, hull);
+
+    // The envelope is opt-in and swallows the close returns, which is why it is not free space.
+    EXPECT_TRUE(polygonContains(mapper.envelope(), close.front() * 1.5F));
+    mapper.setEnvelopeEnabled(false);
+    EXPECT_TRUE(mapper.envelope().empty());
+}
+
+TEST(FreeSpaceHullTest, BinOrderedOutlineUntanglesCrossingsAcrossAGap)
+{
+    // Only bins between 10 and 150 degrees see anything, a gap of 220 degrees. The edge across the
+    // gap runs between the two far returns and cuts off the close one at 80 degrees.
+    const std::array<float, 5> degrees = {10.0F, 40.0F, 80.0F, 120.0F, 150.0F};
+    const std::array<float, 5> ranges = {10.0F, 10.0F, 0.1F, 10.0F, 10.0F};
+    std::vector<glm::vec2> positions;
+    for (std::size_t i = 0; i < degrees.size(); ++i)
+    {
+        const float angle = glm::radians(degrees[i]);
+        positions.emplace_back(ranges[i] * std::cos(angle), ranges[i] * std::sin(angle));
+    }
+    positions.emplace_back(0.0F, -10.0F);
+    std::vector<uint8_t> valid(positions.size(), 1U);
+    valid.back() = 0U;
+    std::vector<glm::vec2> outline;
+    EXPECT_GE(mapping::binOrderedOutline(valid, positions, glm::vec2(0.0F), outline), 1U);
+    ASSERT_EQ(outline.size(), 5U);
+    EXPECT_TRUE(isSimplePolygon(outline));
+    for (std::size_t i = 0; i < 5U; ++i)
+    {
+        EXPECT_NE(std::find(outline.begin(), outline.end(), positions[i]), outline.end());
+    }
+
+    // The bin that closes the gap leaves a star-shaped outline, kept in bin order.
+    valid.back() = 1U;
+    EXPECT_EQ(mapping::binOrderedOutline(valid, positions, glm::vec2(0.0F), outline), 0U);
+    EXPECT_EQ(outline, positions);
+}
+
+TEST(FreeSpaceHullTest, BinOrderedOutlineSkipsRepairOnAFullRing)
+{
+    // Ranges jump between 0.5 and 20 m from bin to bin, yet no gap exceeds pi, so bin order is
+    // already simple and comes back unchanged.
+    constexpr std::size_t kBins = 720U;
+    const glm::vec2 center(0.3F, -0.2F);
+    std::vector<glm::vec2> positions;
+    for (std::size_t i = 0; i < kBins; ++i)
+    {
+        const float angle = (static_cast<float>(i) + 0.5F) * glm::two_pi<float>() / static_cast<float>(kBins);
+        const float range = i % 2U == 0U ? 0.5F : 20.0F;
+        positions.push_back(center + range * glm::vec2(std::cos(angle), std::sin(angle)));
+    }
+    const std::vector<uint8_t> valid(kBins, 1U);
+    std::vector<glm::vec2> outline;
+    EXPECT_EQ(mapping::binOrderedOutline(valid, positions, center, outline), 0U);
+    EXPECT_EQ(outline, positions);
+    EXPECT_TRUE(isSimplePolygon(outline));
+}
+
+TEST(FreeSpaceHullTest, ConvexHullEnclosesEveryPoint)
+{
+    std::mt19937 rng(7U);
+    std::uniform_real_distribution<float> coordinate(-20.0F, 20.0F);
+    std::vector<glm::vec2> points(500U);
+    for (auto& point : points)
+    {
+        point = glm::vec2(coordinate(rng), coordinate(rng));
+    }
+    points.push_back(points.front());
+
+    mapping::FreeSpaceHull hull({mapping::HullShape::Convex});
+    hull.build(points);
+    const auto& vertices = hull.vertices();
+    ASSERT_GE(vertices.size(), 3U);
+    EXPECT_GT(polygonArea(vertices), 0.0F);
+    for (std::size_t i = 0; i < vertices.size(); ++i)
+    {
+        const glm::vec2& a = vertices[i];
+        const glm::vec2& b = vertices[(i + 1U) % vertices.size()];
+        const glm::vec2& c = vertices[(i + 2U) % vertices.size()];
+        EXPECT_GT((b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x), 0.0F);
+        for (const auto& point : points)
+        {
+            EXPECT_GE((b.x - a.x) * (point.y - a.y) - (b.y - a.y) * (point.x - a.x), -1e-3F);
+        }
+    }
+
+    hull.build(std::vector<glm::vec2>{{1.0F, 1.0F}});
+    EXPECT_EQ(hull.vertices().size(), 1U);
+    hull.build(std::vector<glm::vec2>{{0.0F, 0.0F}, {1.0F, 1.0F}, {2.0F, 2.0F}});
+    EXPECT_EQ(hull.vertices().size(), 2U);
+}
+
+TEST(FreeSpaceHullTest, ConcaveHullFollowsANotchAndStaysSimple)
+{
+    // Returns along a U-shaped wall: a 10 x 10 m square with a 4 m wide, 8 m deep notch.
+    std::vector<glm::vec2> points;
+    const auto addLine = [&points](glm::vec2 from, glm::vec2 to) {
+        for (int step = 0; step < 20; ++step)
+        {
+            points.push_back(from + (to - from) * (static_cast<float>(step) / 20.0F));
+        }
+    };
+    addLine({0.0F, 0.0F}, {10.0F, 0.0F});
+    addLine({10.0F, 0.0F}, {10.0F, 10.0F});
+    addLine({10.0F, 10.0F}, {7.0F, 10.0F});
+    addLine({7.0F, 10.0F}, {7.0F, 2.0F});
+    addLine({7.0F, 2.0F}, {3.0F, 2.0F});
+    addLine({3.0F, 2.0F}, {3.0F, 10.0F});
+    addLine({3.0F, 10.0F}, {0.0F, 10.0F});
+    addLine({0.0F, 10.0F}, {0.0F, 0.0F});
+
+    mapping::FreeSpaceHull hull;
+    hull.build(points);
+    const auto& vertices = hull.vertices();
+    EXPECT_NEAR(polygonArea(hull.convexVertices()), 100.0F, 1e-3F);
+    EXPECT_LT(polygonArea(vertices), 75.0F);
+    EXPECT_GT(polygonArea(vertices), 60.0F);
+    EXPECT_TRUE(isSimplePolygon(vertices));
+    for (const auto& point : points)
+    {
+        EXPECT_TRUE(polygonContains(vertices, point)) << point.x << ", " << point.y;
+    }
+}
+
+TEST(FreeSpaceHullTest, IncrementalUpdateMatchesRebuild)
+{
+    constexpr std::size_t kBins = 360U;
+    std::mt19937 rng(11U);
+    std::uniform_real_distribution<float> range(4.0F, 12.0F);
+    std::uniform_int_distribution<std::size_t> bin(0U, kBins - 1U);
+    std::vector<uint8_t> valid(kBins, 1U);
+    std::vector<glm::vec2> positions(kBins);
+    for (std::size_t i = 0; i < kBins; ++i)
+    {
+        const float angle = glm::two_pi<float>() * static_cast<float>(i) / static_cast<float>(kBins);
+        positions[i] = range(rng) * glm::vec2(std::cos(angle), std::sin(angle));
+    }
+
+    for (const auto shape : {mapping::HullShape::Convex, mapping::HullShape::Concave})
+    {
+        mapping::FreeSpaceHull incremental({shape});
+        mapping::FreeSpaceHull reference({shape});
+        incremental.update(valid, positions);
+        EXPECT_EQ(incremental.changedInputs(), kBins);
+        for (int frame = 0; frame < 20; ++frame)
+        {
+            for (int change = 0; change < 3; ++change)
+            {
+                const std::size_t i = bin(rng);
+                valid[i] = frame % 4 == 3 && change == 0 ? 0U : 1U;
+                positions[i] *= range(rng) / glm::length(positions[i]);
+            }
+            incremental.update(valid, positions);
+            EXPECT_LE(incremental.changedInputs(), 3U);
+
+            std::vector<glm::vec2> compacted;
+            for (std::size_t i = 0; i < kBins; ++i)
+            {
+                if (valid[i] != 0U)
+                {
+                    compacted.push_back(positions[i]);
+                }
+            }
+            reference.build(compacted);
+            ASSERT_EQ(incremental.vertices(), reference.vertices()) << "frame " << frame;
+        }
+
+        incremental.update(valid, positions);
+        EXPECT_EQ(incremental.changedInputs(), 0U);
+        EXPECT_FALSE(incremental.rebuilt());
+    }
+
+    // A return moving inside the convex hull leaves it untouched.
+    mapping::FreeSpaceHull convex({mapping::HullShape::Convex});
+    convex.update(valid, positions);
+    std::size_t interiorBin = kBins;
+    for (std::size_t i = 0; i < kBins && interiorBin == kBins; ++i)
+    {
+        if (valid[i] != 0U && std::find(convex.convexVertices().begin(), convex.convexVertices().end(), positions[i])
+                                  == convex.convexVertices().end())
+        {
+            interiorBin = i;
+        }
+    }
+    ASSERT_LT(interiorBin, kBins);
+    positions[interiorBin] *= 0.5F;
+    convex.update(valid, positions);
+    EXPECT_EQ(convex.changedInputs(), 1U);
+    EXPECT_FALSE(convex.rebuilt());
+}
+
+TEST(BoundarySimplifierTest, DouglasPeuckerKeepsCornersWithinTolerance)
+{
+    // Densely sampled 10 m square with a 0.3 m bump halfway along its top edge.
+    std::vector<glm::vec2> square;
+    const std::array<glm::vec2, 4> corners = {
+        glm::vec2(0.0F, 0.0F), glm::vec2(10.0F, 0.0F), glm::vec2(10.0F, 10.0F), glm::vec2(0.0F, 10.0F)};
+    for (std::size_t side = 0; side < corners.size(); ++side)
+    {
+        for (int step = 0; step < 20; ++step)
+        {
+            const float t = static_cast<float>(step) / 20.0F;
+            square.push_back(corners[side] + (corners[(side + 1U) % corners.size()] - corners[side]) * t);
+        }
+    }
+    square[50].y += 0.3F;
+
+    mapping::BoundarySimplifier simplifier({mapping::SimplificationMode::DouglasPeucker, 0.5F});
+    std::vector<glm::vec2> simplified;
+    float deviation = simplifier.simplify(square, simplified);
+    EXPECT_EQ(simplified.size(), 4U);
+    EXPECT_NEAR(deviation, 0.3F, 1e-4F);
+    for (const auto& corner : corners)
+    {
+        EXPECT_NE(std::find(simplified.begin(), simplified.end(), corner), simplified.end());
+    }
+
+    // Below the bump height the bump and its neighbours are kept, and nothing else.
+    simplifier.configure({mapping::SimplificationMode::DouglasPeucker, 0.1F});
+    deviation = simplifier.simplify(square, simplified);
+    EXPECT_EQ(simplified.size(), 7U);
+    EXPECT_FLOAT_EQ(deviation, 0.0F);
+    EXPECT_NE(std::find(simplified.begin(), simplified.end(), square[50]), simplified.end());
+
+    // Tiny polygons are passed through.
+    const std::vector<glm::vec2> triangle = {glm::vec2(0.0F), glm::vec2(1.0F, 0.0F), glm::vec2(0.0F, 1.0F)};
+    EXPECT_FLOAT_EQ(simplifier.simplify(triangle, simplified), 0.0F);
+    EXPECT_EQ(simplified, triangle);
+}
+
+TEST(BoundarySimplifierTest, VertexBudgetTradesSizeForDeviation)
+{
+    // 193 samples around a wavy boundary, like the B-spline free-space outline.
+    std::vector<glm::vec2> boundary;
+    for (int i = 0; i < 193; ++i)
+    {
+        const float angle = glm::two_pi<float>() * static_cast<float>(i) / 193.0F;
+        const float radius = 12.0F + 3.0F * std::sin(5.0F * angle);
+        boundary.emplace_back(radius * std::cos(angle), radius * std::sin(angle));
+    }
+
+    mapping::BoundarySimplifier simplifier;
+    std::vector<glm::vec2> simplified;
+    float previous = std::numeric_limits<float>::max();
+    for (const std::size_t budget : {3U, 8U, 16U, 32U, 64U})
+    {
+        simplifier.configure({mapping::SimplificationMode::VertexBudget, 0.0F, budget});
+        const float deviation = simplifier.simplify(boundary, simplified);
+        ASSERT_EQ(simplified.size(), budget);
+        EXPECT_LT(deviation, previous);
+        previous = deviation;
+
+        // Every dropped sample lies within the reported deviation of the outline.
+        float measured = 0.0F;
+        for (const auto& point : boundary)
+        {
+            measured = std::max(measured, outlineDistance(simplified, point));
+        }
+        EXPECT_LE(measured, deviation + 1e-4F) << budget << " vertices";
+    }
+
+    // The tolerance mode reaches its bound with fewer vertices than the budget that matches it.
+    simplifier.configure({mapping::SimplificationMode::DouglasPeucker, previous});
+    const float deviation = simplifier.simplify(boundary, simplified);
+    EXPECT_LE(deviation, previous);
+    EXPECT_LE(simplified.size(), 64U);
+
+    // Budgets beyond the vertex count keep every vertex exactly.
+    simplifier.configure({mapping::SimplificationMode::VertexBudget, 0.0F, 500U});
+    EXPECT_FLOAT_EQ(simplifier.simplify(boundary, simplified), 0.0F);
+    EXPECT_EQ(simplified, boundary);
+}
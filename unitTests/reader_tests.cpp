@@ -1,7 +1,83 @@
 #include <gtest/gtest.h>
 
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
 #include "VelodynePCAPReader.hpp"
 
+namespace
+{
+void appendBytes(std::vector<uint8_t>& bytes, uint32_t value, std::size_t width)
+{
+    for (std::size_t i = 0; i < width; ++i)
+    {
+        bytes.push_back(static_cast<uint8_t>((value >> (8U * i)) & 0xFFU));
+    }
+}
+
+void writeWord(std::vector<uint8_t>& bytes, std::size_t offset, uint16_t value)
+{
+    bytes[offset] = static_cast<uint8_t>(value & 0xFFU);
+    bytes[offset + 1U] = static_cast<uint8_t>(value >> 8U);
+}
+
+// Writes a little-endian pcap with data packets whose timestamps advance by 1 ms each. With a
+// positioning interval, a positioning packet precedes every `positioningInterval`-th data packet.
+std::string writeSyntheticPcap(std::size_t packetCount,
+                               uint8_t factoryByte = 0x22U,
+                               std::size_t positioningInterval = 0U)
+{
+    constexpr std::size_t kPacketLength = 1206U + 42U;
+    constexpr std::size_t kPositioningLength = 512U + 42U;
+    std::vector<uint8_t> bytes;
+    appendBytes(bytes, 0xa1b2c3d4U, 4U);
+    appendBytes(bytes, 2U, 2U);
+    appendBytes(bytes, 5U, 2U);
+    appendBytes(bytes, 0U, 4U);
+    appendBytes(bytes, 0U, 4U);
+    appendBytes(bytes, 65535U, 4U);
+    appendBytes(bytes, 1U, 4U);
+
+    for (std::size_t packet = 0; packet < packetCount; ++packet)
+    {
+        if (positioningInterval != 0U && packet % positioningInterval == 0U)
+        {
+            appendBytes(bytes, 1U, 4U);
+            appendBytes(bytes, static_cast<uint32_t>(packet * 1000U + 500U), 4U);
+            appendBytes(bytes, static_cast<uint32_t>(kPositioningLength), 4U);
+            appendBytes(bytes, static_cast<uint32_t>(kPositioningLength), 4U);
+            const std::size_t gyro1 = bytes.size() + 56U;
+            bytes.resize(bytes.size() + kPositioningLength, 0U);
+            writeWord(bytes, gyro1, 0x0FFFU);       // Gyro 1: -1 LSB
+            writeWord(bytes, gyro1 + 4U, 0xF800U);  // Accel 1 X: -2048 LSB, status bits set
+            writeWord(bytes, gyro1 + 8U, 0x0010U);  // Gyro 2: 16 LSB
+            writeWord(bytes, gyro1 + 12U, 0x0333U); // Accel 2 X: 819 LSB, about 1 g
+        }
+
+        appendBytes(bytes, 1U, 4U);
+        appendBytes(bytes, static_cast<uint32_t>(packet * 1000U), 4U);
+        appendBytes(bytes, static_cast<uint32_t>(kPacketLength), 4U);
+        appendBytes(bytes, static_cast<uint32_t>(kPacketLength), 4U);
+        const std::size_t payloadStart = bytes.size();
+        bytes.resize(payloadStart + kPacketLength, 0U);
+        bytes[payloadStart + kPacketLength - 1U] = factoryByte;
+    }
+
+    const std::string path = (std::filesystem::temp_directory_path() / "lidar_reader_seek_test.pcap").string();
+    FILE* file = std::fopen(path.c_str(), "wb");
+    if (file != nullptr)
+    {
+        std::fwrite(bytes.data(), 1U, bytes.size(), file);
+        std::fclose(file);
+    }
+    return path;
+}
+} // namespace
+
 TEST(VelodynePcapReaderTest, LegacyTimestampScalingAppliesMultiplier)
 {
     const unsigned long long expected = 2000ULL + 3000ULL;
@@ -31,3 +107,59 @@ TEST(VelodynePcapReaderTest, DetermineTimeScalingChoosesCorrectedForNewerVersion
     determineLiDARTimeScalingType(3, 0, nullptr, &type);
     EXPECT_EQ(type, PCAPLiDARTimeScalingType::Corrected);
 }
+
+TEST(VelodynePcapReaderTest, SeekReturnsToRecordedScanPosition)
+{
+    const std::size_t packetsPerScan = VDYNE::VLP16_Hardware.blocksPerScan;
+    const std::string path = writeSyntheticPcap(packetsPerScan * 3U);
+    auto scan = std::make_unique<VDYNE::LiDARScan_t>();
+
+    ASSERT_EQ(GetFirstLidarScan(path.c_str(), scan.get()), GLSE_SUCCESS);
+    const long long firstPosition = GetFirstLidarScanPosition();
+    const uint64_t firstTimestamp = scan->timestamp_us;
+    const long long secondPosition = GetLidarScanPosition();
+    ASSERT_EQ(GetNextLidarScan(scan.get()), GLSE_SUCCESS);
+    const uint64_t secondTimestamp = scan->timestamp_us;
+    EXPECT_GT(secondPosition, firstPosition);
+    EXPECT_GT(secondTimestamp, firstTimestamp);
+
+    ASSERT_EQ(SeekLidarScan(secondPosition), GLSE_SUCCESS);
+    ASSERT_EQ(GetNextLidarScan(scan.get()), GLSE_SUCCESS);
+    EXPECT_EQ(scan->timestamp_us, secondTimestamp);
+
+    ASSERT_EQ(SeekLidarScan(firstPosition), GLSE_SUCCESS);
+    ASSERT_EQ(GetNextLidarScan(scan.get()), GLSE_SUCCESS);
+    EXPECT_EQ(scan->timestamp_us, firstTimestamp);
+
+    EndLidarEnumeration();
+    EXPECT_EQ(GetLidarScanPosition(), -1);
+    EXPECT_EQ(SeekLidarScan(firstPosition), GLSE_FILEIOERR);
+    std::filesystem::remove(path);
+}
+
+TEST(VelodynePcapReaderTest, PositioningPacketsAttachImuSamplesToTheirScan)
+{
+    const std::size_t packetsPerScan = VDYNE::HDL32_Hardware.blocksPerScan;
+    const std::string path = writeSyntheticPcap(packetsPerScan * 2U, 0x21U, 20U);
+    auto scan = std::make_unique<VDYNE::LiDARScan_t>();
+
+    ASSERT_EQ(GetFirstLidarScan(path.c_str(), scan.get()), GLSE_SUCCESS);
+    EXPECT_EQ(scan->lidarHardware, VDYNE::LiDARHardware_t::HDL32);
+    // Data packets 0, 20, ..., 180 belong to the first scan.
+    ASSERT_EQ(scan->imuSampleCount, 10U);
+    const VDYNE::ImuSample_t& sample = scan->imuSamples[1];
+    EXPECT_EQ(sample.timestamp_us, 1000000ULL + 20500ULL);
+    EXPECT_NEAR(sample.gyro_dps[0], -0.09766F, 1e-6F);
+    EXPECT_NEAR(sample.gyro_dps[1], 16.0F * 0.09766F, 1e-5F);
+    EXPECT_NEAR(sample.gyro_dps[2], 0.0F, 1e-6F);
+    EXPECT_NEAR(sample.accel_g[0][0], -2048.0F * 0.001221F, 1e-5F);
+    EXPECT_NEAR(sample.accel_g[1][0], 819.0F * 0.001221F, 1e-5F);
+
+    // Block timestamps only come from data packets.
+    EXPECT_EQ(scan->block_timestamp_us[1], 1000000ULL + 1000ULL);
+
+    ASSERT_EQ(GetNextLidarScan(scan.get()), GLSE_SUCCESS);
+    EXPECT_EQ(scan->imuSampleCount, 9U);
+    EndLidarEnumeration();
+    std::filesystem::remove(path);
+}
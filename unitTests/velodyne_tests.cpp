@@ -1,12 +1,28 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
 #include <cstddef>
+#include <mutex>
+#include <optional>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include <gtest/gtest.h>
 
+#include "engine/FrameCache.hpp"
+#include "engine/FrameConsumer.hpp"
+#include "engine/FramePacer.hpp"
+#include "engine/FramePool.hpp"
 #include "engine/LidarEngine.hpp"
+#include "engine/ReplayController.hpp"
+#include "engine/StageGraph.hpp"
+#include "engine/ThreadPool.hpp"
 #include "sensors/BaseLidarSensor.hpp"
+#include "sensors/EgoMotion.hpp"
 #include "sensors/LidarFactory.hpp"
+#include "sensors/RangeImageFilter.hpp"
 #include "sensors/VelodyneLidar.hpp"
 #include "visualization/IVisualizer.hpp"
 
@@ -20,6 +36,14 @@ struct LidarEngineTestHelper
     {
         engine.captureFrame();
     }
+
+    static void captureAndPublish(LidarEngine& engine)
+    {
+        if (engine.captureFrame())
+        {
+            engine.publishFrame();
+        }
+    }
 };
 
 struct VelodyneLidarTestHelper
@@ -83,7 +107,7 @@ public:
         return initializeResult;
     }
 
-    void updatePoints(const lidar::BaseLidarSensor::PointCloud&) override
+    void updatePoints(const lidar::BaseLidarSensor::PointCloud&, uint64_t) override
     {
         ++updateCount;
     }
@@ -103,12 +127,18 @@ public:
         return frameSpeedScaleResult;
     }
 
+    void setOdometryMotionSource(lidar::PoseStreamMotionSource* source) override
+    {
+        odometryMotion = source;
+    }
+
     bool initializeResult = true;
     bool windowShouldCloseResult = true;
     float frameSpeedScaleResult = 1.0F;
     int initializeCalls = 0;
     int updateCount = 0;
     int renderCount = 0;
+    lidar::PoseStreamMotionSource* odometryMotion = nullptr;
 };
 
 class FakeSensor : public lidar::BaseLidarSensor
@@ -145,6 +175,11 @@ public:
         return true;
     }
 
+    void setEgoMotionSource(lidar::IEgoMotionSource* source) override
+    {
+        egoMotion = source;
+    }
+
     std::string m_identifier;
     int configureCount = 0;
     int readCount = 0;
@@ -152,6 +187,86 @@ public:
     uint64_t timestampValue = 0;
     float lastVerticalFov = 0.0F;
     float lastMaxRange = 0.0F;
+    lidar::IEgoMotionSource* egoMotion = nullptr;
+};
+
+// Recorded source with `frameCount` scans; each scan holds one point whose x is the scan index.
+class FakeReplaySensor : public FakeSensor
+{
+public:
+    explicit FakeReplaySensor(std::size_t count)
+        : frameCount(count)
+    {
+    }
+
+    bool readNextScan(PointCloud& destination, uint64_t& timestamp_us) override
+    {
+        ++readCount;
+        if (position >= frameCount)
+        {
+            return false;
+        }
+
+        destination.assign(1U, {static_cast<float>(position), 0.0F, 0.0F, 1.0F});
+        timestamp_us = 1000U * position;
+        ++position;
+        return true;
+    }
+
+    bool supportsRandomAccess() const noexcept override
+    {
+        return true;
+    }
+
+    bool seekScan(std::size_t index) override
+    {
+        position = std::min(index, frameCount);
+        return index < frameCount;
+    }
+
+    std::size_t nextScanIndex() const noexcept override
+    {
+        return position;
+    }
+
+    std::size_t frameCount;
+    std::size_t position = 0U;
+};
+
+class RecordingConsumer : public lidar::IFrameConsumer
+{
+public:
+    explicit RecordingConsumer(std::string name)
+        : m_name(std::move(name))
+    {
+    }
+
+    const std::string& name() const noexcept override
+    {
+        return m_name;
+    }
+
+    void consumeFrame(const lidar::Frame& frame) override
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        released.wait(lock, [this] { return !blocked; });
+        sequences.push_back(frame.sequence);
+    }
+
+    void release()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            blocked = false;
+        }
+        released.notify_all();
+    }
+
+    std::string m_name;
+    std::mutex mutex;
+    std::condition_variable released;
+    bool blocked = false;
+    std::vector<uint64_t> sequences;
 };
 } // namespace
 
@@ -186,6 +301,334 @@ TEST(LidarEngineTest, CaptureFrameUpdatesLatestTimestamp)
     EXPECT_EQ(engine.latestTimestamp(), 1234ULL);
 }
 
+TEST(LidarEngineTest, OdometryFromTheVisualizerDeskewsTheSensor)
+{
+    auto sensor = std::make_unique<FakeSensor>();
+    auto visualizer = std::make_unique<FakeVisualizer>();
+    FakeSensor* sensorView = sensor.get();
+    FakeVisualizer* visualizerView = visualizer.get();
+
+    lidar::LidarEngine engine(std::move(sensor), std::move(visualizer));
+    ASSERT_TRUE(engine.initialize());
+    ASSERT_NE(visualizerView->odometryMotion, nullptr);
+    EXPECT_EQ(sensorView->egoMotion, visualizerView->odometryMotion);
+
+    // Poses the visualizer publishes reach the sensor's deskew.
+    lidar::EgoMotion motion;
+    EXPECT_FALSE(sensorView->egoMotion->motionAt(0U, motion));
+    Eigen::Isometry3f pose = Eigen::Isometry3f::Identity();
+    visualizerView->odometryMotion->pushPose(0U, pose);
+    pose.translate(Eigen::Vector3f(1.0F, 0.0F, 0.0F));
+    visualizerView->odometryMotion->pushPose(100000U, pose);
+    ASSERT_TRUE(sensorView->egoMotion->motionAt(150000U, motion));
+    EXPECT_NEAR(motion.linearVelocity.x(), 10.0F, 1e-3F);
+}
+
+TEST(LidarEngineTest, SlowConsumerDoesNotBlockOthers)
+{
+    lidar::LidarEngine engine(std::make_unique<FakeSensor>(), std::make_unique<FakeVisualizer>());
+    ASSERT_TRUE(engine.initialize());
+
+    auto slow = std::make_shared<RecordingConsumer>("recorder");
+    slow->blocked = true;
+    auto fast = std::make_shared<RecordingConsumer>("mapper");
+    ASSERT_TRUE(engine.registerConsumer(slow, 1U));
+    ASSERT_TRUE(engine.registerConsumer(fast, 8U));
+    EXPECT_FALSE(engine.registerConsumer(nullptr));
+
+    for (int i = 0; i < 5; ++i)
+    {
+        lidar::LidarEngineTestHelper::captureAndPublish(engine);
+    }
+
+    slow->release();
+    engine.drainConsumers();
+
+    EXPECT_EQ(fast->sequences, (std::vector<uint64_t>{0U, 1U, 2U, 3U, 4U}));
+    const auto stats = engine.consumerStats();
+    ASSERT_EQ(stats.size(), 2U);
+    EXPECT_EQ(stats[0].framesDelivered + stats[0].framesDropped, 5U);
+    EXPECT_GE(stats[0].framesDropped, 3U);
+    EXPECT_EQ(slow->sequences.back(), 4U);
+    EXPECT_EQ(stats[1].framesDropped, 0U);
+}
+
+TEST(LidarEngineTest, ReplayJumpsServeCachedFramesWithoutReading)
+{
+    auto sensor = std::make_unique<FakeReplaySensor>(5U);
+    FakeReplaySensor* sensorView = sensor.get();
+    lidar::LidarEngine engine(std::move(sensor), std::make_unique<FakeVisualizer>());
+    ASSERT_TRUE(engine.initialize());
+
+    for (int i = 0; i < 3; ++i)
+    {
+        lidar::LidarEngineTestHelper::captureFrame(engine);
+    }
+    EXPECT_EQ(engine.latestTimestamp(), 2000U);
+    const int readsAfterPlayback = sensorView->readCount;
+
+    engine.replay().jumpTo(0U);
+    lidar::LidarEngineTestHelper::captureFrame(engine);
+    EXPECT_EQ(engine.latestTimestamp(), 0U);
+    EXPECT_EQ(sensorView->readCount, readsAfterPlayback);
+    EXPECT_EQ(engine.frameCache().hits(), 1U);
+
+    // Running off the end records the capture length and pauses on the last frame.
+    engine.replay().jumpTo(4U);
+    lidar::LidarEngineTestHelper::captureFrame(engine);
+    lidar::LidarEngineTestHelper::captureFrame(engine);
+    EXPECT_TRUE(engine.replay().paused());
+    ASSERT_TRUE(engine.replay().frameCount().has_value());
+    EXPECT_EQ(*engine.replay().frameCount(), 5U);
+    EXPECT_EQ(engine.latestTimestamp(), 4000U);
+}
+
+TEST(ReplayControllerTest, LoopAndStepsStayInRange)
+{
+    lidar::ReplayController replay;
+    EXPECT_EQ(replay.advance(), 0U);
+    EXPECT_EQ(replay.advance(), 1U);
+
+    replay.setLoop(5U, 3U);
+    EXPECT_EQ(replay.advance(), 3U);
+    EXPECT_EQ(replay.advance(), 4U);
+    EXPECT_EQ(replay.advance(), 5U);
+    EXPECT_EQ(replay.advance(), 3U);
+    EXPECT_EQ(replay.peek(2U), std::optional<std::size_t>(5U));
+
+    replay.setReverse(true);
+    EXPECT_EQ(replay.advance(), 5U);
+
+    replay.clearLoop();
+    replay.stepBackward();
+    EXPECT_TRUE(replay.paused());
+    EXPECT_EQ(replay.takePendingFrame(), std::optional<std::size_t>(4U));
+    EXPECT_FALSE(replay.takePendingFrame().has_value());
+    replay.jumpTo(0U);
+    replay.play();
+    EXPECT_EQ(replay.advance(), 0U);
+    EXPECT_EQ(replay.advance(), 0U);
+    EXPECT_TRUE(replay.paused());
+}
+
+TEST(FrameCacheTest, EvictsLeastRecentlyUsedWithinByteBudget)
+{
+    const auto makeFrame = [](std::size_t points) {
+        lidar::Frame frame;
+        frame.points = std::make_shared<const lidar::BaseLidarSensor::PointCloud>(points);
+        return frame;
+    };
+
+    lidar::FrameCache cache(3U * 10U * sizeof(lidar::LidarPoint));
+    cache.insert(0U, makeFrame(10U));
+    cache.insert(1U, makeFrame(10U));
+    cache.insert(2U, makeFrame(10U));
+    ASSERT_TRUE(cache.find(0U).has_value());
+
+    cache.insert(3U, makeFrame(10U));
+    EXPECT_TRUE(cache.contains(0U));
+    EXPECT_FALSE(cache.contains(1U));
+    EXPECT_EQ(cache.entryCount(), 3U);
+
+    cache.insert(4U, makeFrame(100U));
+    EXPECT_FALSE(cache.contains(4U));
+    cache.setCapacityBytes(10U * sizeof(lidar::LidarPoint));
+    EXPECT_EQ(cache.entryCount(), 1U);
+    EXPECT_TRUE(cache.contains(3U));
+}
+
+TEST(FramePoolTest, ReleasedBuffersAreRecycled)
+{
+    lidar::FramePool pool;
+    const lidar::BaseLidarSensor::PointCloud* firstAddress = nullptr;
+    {
+        auto buffer = pool.acquire();
+        buffer->resize(128U);
+        firstAddress = buffer.get();
+        lidar::SharedPointCloud shared = buffer;
+        buffer.reset();
+        EXPECT_EQ(pool.availableCount(), 0U);
+    }
+    EXPECT_EQ(pool.availableCount(), 1U);
+
+    auto reused = pool.acquire();
+    EXPECT_EQ(reused.get(), firstAddress);
+    EXPECT_TRUE(reused->empty());
+    EXPECT_GE(reused->capacity(), 128U);
+    EXPECT_EQ(pool.allocatedCount(), 1U);
+}
+
+TEST(StageGraphTest, IndependentStagesShareALevel)
+{
+    lidar::ThreadPool pool(2U);
+    lidar::StageGraph graph;
+    graph.setThreadPool(&pool);
+    graph.addStage("near", lidar::StageKind::Filter, {lidar::StageGraph::kSourceBuffer}, {"near"},
+                   [](lidar::FrameContext& frame) {
+                       for (const auto& point : frame.input(lidar::StageGraph::kSourceBuffer))
+                       {
+                           if (point.x < 5.0F)
+                           {
+                               frame.output("near").push_back(point);
+                           }
+                       }
+                   });
+    graph.addStage("far", lidar::StageKind::Filter, {lidar::StageGraph::kSourceBuffer}, {"far"},
+                   [](lidar::FrameContext& frame) {
+                       for (const auto& point : frame.input(lidar::StageGraph::kSourceBuffer))
+                       {
+                           if (point.x >= 5.0F)
+                           {
+                               frame.output("far").push_back(point);
+                           }
+                       }
+                   });
+    std::size_t nearCount = 0U;
+    std::size_t farCount = 0U;
+    graph.addStage("count", lidar::StageKind::Export, {"near", "far"}, {"counts"},
+                   [&](lidar::FrameContext& frame) {
+                       nearCount = frame.input("near").size();
+                       farCount = frame.input("far").size();
+                   });
+
+    ASSERT_TRUE(graph.compile());
+    ASSERT_EQ(graph.levels().size(), 2U);
+    EXPECT_EQ(graph.levels().front().size(), 2U);
+
+    const lidar::BaseLidarSensor::PointCloud cloud{
+        {1.0F, 0.0F, 0.0F, 1.0F}, {7.0F, 0.0F, 0.0F, 1.0F}, {9.0F, 0.0F, 0.0F, 1.0F}};
+    graph.run(cloud);
+    EXPECT_EQ(nearCount, 1U);
+    EXPECT_EQ(farCount, 2U);
+
+    graph.run(cloud);
+    EXPECT_EQ(nearCount, 1U);
+    EXPECT_EQ(farCount, 2U);
+}
+
+TEST(ThreadPoolTest, ParallelReduceIsIndependentOfWorkerCount)
+{
+    std::vector<float> values(10000U);
+    for (std::size_t i = 0; i < values.size(); ++i)
+    {
+        values[i] = 1.0F / static_cast<float>(i + 1U);
+    }
+
+    const auto sumWith = [&](lidar::ThreadPool* pool) {
+        return lidar::parallelReduce(
+            pool,
+            0U,
+            values.size(),
+            64U,
+            0.0F,
+            [&](std::size_t begin, std::size_t end) {
+                float partial = 0.0F;
+                for (std::size_t i = begin; i < end; ++i)
+                {
+                    partial += values[i];
+                }
+                return partial;
+            },
+            [](float lhs, float rhs) { return lhs + rhs; });
+    };
+
+    lidar::ThreadPoolConfig config;
+    config.workerCount = 3U;
+    config.idlePolicy = lidar::IdlePolicy::Sleep;
+    lidar::ThreadPool pool(config);
+
+    EXPECT_EQ(sumWith(nullptr), sumWith(&pool));
+}
+
+TEST(ThreadPoolTest, NestedParallelForCompletes)
+{
+    lidar::ThreadPool pool(2U);
+    std::vector<int> hits(64U, 0);
+    pool.parallelFor(0U, 8U, 1U, [&](std::size_t outerBegin, std::size_t outerEnd) {
+        for (std::size_t outer = outerBegin; outer < outerEnd; ++outer)
+        {
+            pool.parallelFor(0U, 8U, 1U, [&](std::size_t innerBegin, std::size_t innerEnd) {
+                for (std::size_t inner = innerBegin; inner < innerEnd; ++inner)
+                {
+                    ++hits[outer * 8U + inner];
+                }
+            }, lidar::TaskPriority::High);
+        }
+    });
+
+    EXPECT_TRUE(std::all_of(hits.begin(), hits.end(), [](int count) { return count == 1; }));
+}
+
+TEST(FramePacerTest, KeepLatestSkipsSupersededFrames)
+{
+    using namespace std::chrono_literals;
+    lidar::FramePacer pacer;
+    const auto start = lidar::FramePacer::Clock::time_point{};
+    pacer.start(start);
+
+    EXPECT_EQ(pacer.framesToSkip(start + 50ms, 100ms), 0U);
+    EXPECT_EQ(pacer.framesToSkip(start + 350ms, 100ms), 3U);
+
+    for (int i = 0; i < 3; ++i)
+    {
+        pacer.recordDropped(100ms, false);
+    }
+    const auto arrival = pacer.recordCaptured(100ms);
+    EXPECT_EQ(arrival, start + 300ms);
+    pacer.recordProcessed(arrival, start + 420ms, 70ms);
+
+    EXPECT_EQ(pacer.stats().framesDropped, 3U);
+    EXPECT_EQ(pacer.stats().framesProcessed, 1U);
+    EXPECT_EQ(pacer.stats().lastDataAge, 120ms);
+}
+
+TEST(FramePacerTest, AdaptiveDecimationFollowsProcessingTime)
+{
+    using namespace std::chrono_literals;
+    lidar::OverloadSettings settings;
+    settings.policy = lidar::OverloadPolicy::AdaptiveDecimation;
+    settings.maxDataAgeInFrames = 100.0F;
+    settings.processingTimeSmoothing = 1.0F;
+    lidar::FramePacer pacer(settings);
+    const auto start = lidar::FramePacer::Clock::time_point{};
+    pacer.start(start);
+
+    auto arrival = pacer.recordCaptured(100ms);
+    pacer.recordProcessed(arrival, arrival + 250ms, 250ms);
+    arrival = pacer.recordCaptured(100ms);
+
+    EXPECT_EQ(pacer.stats().decimationFactor, 3U);
+    EXPECT_EQ(pacer.framesToSkip(start + 200ms, 100ms), 2U);
+}
+
+TEST(FramePacerTest, StaleFramesAreNeverProcessed)
+{
+    using namespace std::chrono_literals;
+    lidar::OverloadSettings settings;
+    settings.policy = lidar::OverloadPolicy::AdaptiveDecimation;
+    settings.maxDataAgeInFrames = 2.0F;
+    lidar::FramePacer pacer(settings);
+    const auto start = lidar::FramePacer::Clock::time_point{};
+    pacer.start(start);
+
+    // Ten periods behind with no decimation yet: skip until the chosen frame is at most two periods old.
+    EXPECT_EQ(pacer.framesToSkip(start + 1000ms, 100ms), 8U);
+
+    lidar::OverloadSettings everyFrame;
+    everyFrame.policy = lidar::OverloadPolicy::ProcessEveryFrame;
+    pacer.setSettings(everyFrame);
+    EXPECT_EQ(pacer.framesToSkip(start + 1000ms, 100ms), 0U);
+}
+
+TEST(StageGraphTest, CompileRejectsCycles)
+{
+    lidar::StageGraph graph;
+    graph.addStage("a", lidar::StageKind::Filter, {"b"}, {"a"}, [](lidar::FrameContext&) {});
+    graph.addStage("b", lidar::StageKind::Filter, {"a"}, {"b"}, [](lidar::FrameContext&) {});
+
+    EXPECT_FALSE(graph.compile());
+}
+
 TEST(LidarFactoryTest, CreateSensorRespectsEmptySource)
 {
     EXPECT_EQ(lidar::LidarFactory::createSensor("velodyne", ""), nullptr);
@@ -230,3 +673,256 @@ TEST(VelodyneLidarTest, PopulateGeometryProducesCoordinates)
     EXPECT_NEAR(points[0].y, 0.0F, 1e-3F);
     EXPECT_NEAR(points[0].z, 0.0F, 1e-3F);
 }
+
+TEST(VelodyneLidarTest, ParallelDecodeMatchesSequentialOrder)
+{
+    VDYNE::LiDARConfiguration_t config{40, 1, 2};
+    // Scans are several hundred kilobytes, keep them off the test stack.
+    auto scan = std::make_unique<VDYNE::LiDARScan_t>();
+    scan->lidarHardware = VDYNE::LiDARHardware_t::HDL32;
+    for (std::size_t block = 0; block < config.blocksPerScan; ++block)
+    {
+        scan->firings[block].azimuth = static_cast<uint16_t>(block * 900U);
+        scan->firings[block].v_laser[0].range = static_cast<uint16_t>(100U + block);
+        scan->firings[block].v_laser[1].range = block % 3U == 0U ? 0U : static_cast<uint16_t>(200U + block);
+    }
+
+    auto decode = [&](lidar::ThreadPool* pool) {
+        auto lidar = std::make_unique<lidar::VelodyneLidar>("lidar", "");
+        lidar::VelodyneLidarTestHelper::configureForTest(*lidar, config, 0.01F, 0.0F, 0.0F);
+        lidar::VelodyneLidarTestHelper::setMaxRange(*lidar, 100.0F);
+        lidar::VelodyneLidarTestHelper::overrideScan(*lidar, *scan);
+        lidar->setThreadPool(pool);
+        lidar::BaseLidarSensor::PointCloud points;
+        lidar::VelodyneLidarTestHelper::populateGeometry(*lidar, points);
+        return points;
+    };
+
+    lidar::ThreadPool pool(3U);
+    const auto sequential = decode(nullptr);
+    const auto parallel = decode(&pool);
+    ASSERT_EQ(sequential.size(), parallel.size());
+    for (std::size_t i = 0; i < sequential.size(); ++i)
+    {
+        EXPECT_EQ(sequential[i].x, parallel[i].x);
+        EXPECT_EQ(sequential[i].y, parallel[i].y);
+        EXPECT_EQ(sequential[i].z, parallel[i].z);
+    }
+}
+
+TEST(RangeImageFilterTest, RejectsReturnsWithoutSupportingNeighbours)
+{
+    constexpr std::size_t kRows = 4U;
+    constexpr std::size_t kColumns = 12U;
+    std::vector<float> ranges(kRows * kColumns, 10.0F);
+    const auto at = [&ranges](std::size_t column, std::size_t row) -> float& { return ranges[column * kRows + row]; };
+    at(5U, 2U) = 3.0F;  // Spurious echo in front of a wall.
+    at(7U, 1U) = 0.0F;  // Missing return.
+    for (std::size_t row = 0; row < kRows; ++row)
+    {
+        at(9U, row) = 0.0F;
+    }
+    at(9U, 0U) = 2.0F;  // Dust in an otherwise empty column.
+    at(0U, 3U) = 20.0F; // Only supported across the revolution seam.
+    at(11U, 3U) = 20.0F;
+
+    lidar::RangeImageFilter filter;
+    std::vector<uint8_t> keep;
+    EXPECT_EQ(filter.filter(ranges, kRows, kColumns, keep), 2U);
+    ASSERT_EQ(keep.size(), ranges.size());
+    EXPECT_EQ(keep[5U * kRows + 2U], 0U);
+    EXPECT_EQ(keep[9U * kRows + 0U], 0U);
+    EXPECT_EQ(keep[7U * kRows + 1U], 0U);
+    EXPECT_EQ(keep[0U * kRows + 3U], 1U);
+    EXPECT_EQ(keep[6U * kRows + 2U], 1U);
+
+    lidar::RangeImageFilterSettings settings;
+    settings.wrapColumns = false;
+    filter.configure(settings);
+    // Both ends of the seam lose their only support.
+    EXPECT_EQ(filter.filter(ranges, kRows, kColumns, keep), 4U);
+    EXPECT_EQ(keep[0U * kRows + 3U], 0U);
+}
+
+TEST(VelodyneLidarTest, NoiseFilterComparesElevationNeighbours)
+{
+    VDYNE::LiDARConfiguration_t config{20, 1, 3};
+    auto scan = std::make_unique<VDYNE::LiDARScan_t>();
+    scan->lidarHardware = VDYNE::LiDARHardware_t::HDL32;
+    for (std::size_t block = 0; block < config.blocksPerScan; ++block)
+    {
+        scan->firings[block].azimuth = static_cast<uint16_t>(block * 1800U);
+        scan->firings[block].v_laser[0].range = 1000U;
+        scan->firings[block].v_laser[1].range = 500U;
+        scan->firings[block].v_laser[2].range = 1000U;
+    }
+    // Beam 2 fires next to beam 1 but sits next to beam 0 in elevation, so a 5 m return on it only
+    // has 10 m neighbours.
+    scan->firings[4].v_laser[2].range = 500U;
+    scan->firings[10].v_laser[0].range = 300U;
+
+    lidar::VelodyneLidar lidar("lidar", "");
+    lidar::VelodyneLidarTestHelper::configureForTest(lidar, config, 0.01F, 0.0F, 0.0F);
+    lidar::VelodyneLidarTestHelper::setMaxRange(lidar, 100.0F);
+    lidar::VelodyneLidarTestHelper::setVerticalAngle(lidar, 0U, 0.0F);
+    lidar::VelodyneLidarTestHelper::setVerticalAngle(lidar, 1U, -0.2F);
+    lidar::VelodyneLidarTestHelper::setVerticalAngle(lidar, 2U, 0.1F);
+    lidar::VelodyneLidarTestHelper::overrideScan(lidar, *scan);
+
+    lidar::BaseLidarSensor::PointCloud points;
+    lidar::VelodyneLidarTestHelper::populateGeometry(lidar, points);
+    EXPECT_EQ(points.size(), 60U);
+
+    lidar.setNoiseFilter(true);
+    points.clear();
+    lidar::VelodyneLidarTestHelper::populateGeometry(lidar, points);
+    EXPECT_EQ(points.size(), 58U);
+    EXPECT_EQ(lidar.rejectedReturns(), 2U);
+}
+
+TEST(VelodyneLidarTest, DeskewMovesEarlierBlocksByEgoMotion)
+{
+    VDYNE::LiDARConfiguration_t config{3, 1, 1};
+    auto scan = std::make_unique<VDYNE::LiDARScan_t>();
+    scan->lidarHardware = VDYNE::LiDARHardware_t::HDL32;
+    for (std::size_t block = 0; block < config.blocksPerScan; ++block)
+    {
+        scan->firings[block].v_laser[0].range = 1000U;
+        scan->block_timestamp_us[block] = 50000U * block;
+    }
+    scan->timestamp_us = 100000U;
+
+    lidar::VelodyneLidar lidar("lidar", "");
+    lidar::VelodyneLidarTestHelper::configureForTest(lidar, config, 0.01F, 0.0F, 0.0F);
+    lidar::VelodyneLidarTestHelper::setMaxRange(lidar, 100.0F);
+    lidar::VelodyneLidarTestHelper::setVerticalAngle(lidar, 0U, 0.0F);
+    lidar::VelodyneLidarTestHelper::overrideScan(lidar, *scan);
+
+    lidar::ConstantVelocityMotionSource motion;
+    lidar.setEgoMotionSource(&motion);
+    lidar::BaseLidarSensor::PointCloud points;
+    // No motion known yet: the scan stays as measured.
+    lidar::VelodyneLidarTestHelper::populateGeometry(lidar, points);
+    ASSERT_EQ(points.size(), 3U);
+    EXPECT_NEAR(points[0].x, 10.0F, 1e-4F);
+
+    // Driving forwards at 10 m/s, the wall was 1 m closer to the scan's end pose 100 ms earlier.
+    lidar::EgoMotion egoMotion;
+    egoMotion.linearVelocity = Eigen::Vector3f(10.0F, 0.0F, 0.0F);
+    motion.setMotion(egoMotion);
+    points.clear();
+    lidar::VelodyneLidarTestHelper::populateGeometry(lidar, points);
+    ASSERT_EQ(points.size(), 3U);
+    EXPECT_NEAR(points[0].x, 9.0F, 1e-4F);
+    EXPECT_NEAR(points[1].x, 9.5F, 1e-4F);
+    EXPECT_NEAR(points[2].x, 10.0F, 1e-4F);
+
+    egoMotion.linearVelocity.setZero();
+    egoMotion.angularVelocity = Eigen::Vector3f(0.0F, 0.0F, 1.0F);
+    motion.setMotion(egoMotion);
+    points.clear();
+    lidar::VelodyneLidarTestHelper::populateGeometry(lidar, points);
+    ASSERT_EQ(points.size(), 3U);
+    EXPECT_NEAR(points[0].x, 10.0F * std::cos(0.1F), 1e-4F);
+    EXPECT_NEAR(points[0].y, -10.0F * std::sin(0.1F), 1e-4F);
+    EXPECT_NEAR(points[2].y, 0.0F, 1e-4F);
+}
+
+TEST(EgoMotionTest, PoseStreamDifferentiatesNeighbouringPoses)
+{
+    lidar::PoseStreamMotionSource source;
+    lidar::EgoMotion motion;
+    source.pushPose(0U, Eigen::Isometry3f::Identity());
+    EXPECT_FALSE(source.motionAt(0U, motion));
+
+    Eigen::Isometry3f pose = Eigen::Isometry3f::Identity();
+    pose.translate(Eigen::Vector3f(1.0F, 0.0F, 0.0F));
+    pose.rotate(Eigen::AngleAxisf(0.1F, Eigen::Vector3f::UnitZ()));
+    source.pushPose(100000U, pose);
+    // Out-of-order poses are ignored.
+    source.pushPose(50000U, Eigen::Isometry3f::Identity());
+
+    ASSERT_TRUE(source.motionAt(150000U, motion));
+    EXPECT_NEAR(motion.linearVelocity.x(), 10.0F, 1e-3F);
+    EXPECT_NEAR(motion.linearVelocity.y(), 0.0F, 1e-3F);
+    EXPECT_NEAR(motion.angularVelocity.z(), 1.0F, 1e-3F);
+}
+
+TEST(EgoMotionTest, ImuSourceAveragesGyrosAndLevelsOnGravity)
+{
+    lidar::ImuMotionSource source;
+    lidar::EgoMotion motion;
+    float roll = 0.0F;
+    float pitch = 0.0F;
+    EXPECT_FALSE(source.motionAt(0U, motion));
+    EXPECT_FALSE(source.tilt(roll, pitch));
+
+    for (uint64_t i = 0; i < 20U; ++i)
+    {
+        lidar::ImuSample sample;
+        sample.timestamp_us = 1000000U + 10000U * i;
+        sample.angularVelocity[2] = i % 2U == 0U ? 0.4F : 0.6F;
+        sample.acceleration[1] = 9.80665F * std::sin(0.1F);
+        sample.acceleration[2] = 9.80665F * std::cos(0.1F);
+        source.pushSample(sample);
+    }
+    ASSERT_TRUE(source.motionAt(1100000U, motion));
+    EXPECT_NEAR(motion.angularVelocity.z(), 0.5F, 0.02F);
+    EXPECT_TRUE(motion.linearVelocity.isZero());
+    EXPECT_FALSE(source.motionAt(2000000U, motion));
+    ASSERT_TRUE(source.tilt(roll, pitch));
+    EXPECT_NEAR(roll, 0.1F, 1e-4F);
+    EXPECT_NEAR(pitch, 0.0F, 1e-4F);
+
+    // A jump back in time (a replay seek) restarts the estimates; hard braking does not count as gravity.
+    lidar::ImuSample braking;
+    braking.timestamp_us = 500000U;
+    braking.acceleration[0] = -8.0F;
+    braking.acceleration[2] = 9.80665F;
+    source.pushSample(braking);
+    EXPECT_FALSE(source.tilt(roll, pitch));
+    EXPECT_FALSE(source.motionAt(1100000U, motion));
+}
+
+TEST(VelodyneLidarTest, ImuDeskewUsesPositioningPacketGyros)
+{
+    VDYNE::LiDARConfiguration_t config{3, 1, 1};
+    auto scan = std::make_unique<VDYNE::LiDARScan_t>();
+    scan->lidarHardware = VDYNE::LiDARHardware_t::HDL32;
+    for (std::size_t block = 0; block < config.blocksPerScan; ++block)
+    {
+        scan->firings[block].v_laser[0].range = 1000U;
+        scan->block_timestamp_us[block] = 50000U * block;
+    }
+    scan->timestamp_us = 100000U;
+    scan->imuSampleCount = 1U;
+    scan->imuSamples[0].timestamp_us = 80000U;
+    scan->imuSamples[0].gyro_dps[0] = 57.2957795F; // Yaw at 1 rad/s.
+    scan->imuSamples[0].accel_g[1][0] = 1.0F;
+    scan->imuSamples[0].accel_g[2][0] = 1.0F;
+
+    lidar::VelodyneLidar lidar("lidar", "");
+    lidar::VelodyneLidarTestHelper::configureForTest(lidar, config, 0.01F, 0.0F, 0.0F);
+    lidar::VelodyneLidarTestHelper::setMaxRange(lidar, 100.0F);
+    lidar::VelodyneLidarTestHelper::setVerticalAngle(lidar, 0U, 0.0F);
+    lidar::VelodyneLidarTestHelper::overrideScan(lidar, *scan);
+    lidar.setImuDeskew(true);
+
+    lidar::BaseLidarSensor::PointCloud points;
+    lidar::VelodyneLidarTestHelper::populateGeometry(lidar, points);
+    ASSERT_EQ(points.size(), 3U);
+    EXPECT_NEAR(points[0].x, 10.0F * std::cos(0.1F), 1e-4F);
+    EXPECT_NEAR(points[0].y, -10.0F * std::sin(0.1F), 1e-4F);
+
+    std::vector<lidar::ImuSample> samples;
+    lidar.imuSamples(samples);
+    ASSERT_EQ(samples.size(), 1U);
+    EXPECT_NEAR(samples[0].angularVelocity[2], 1.0F, 1e-5F);
+    EXPECT_NEAR(samples[0].acceleration[2], lidar::kStandardGravity, 1e-4F);
+
+    // The same samples level the sensor: gravity straight along z.
+    lidar::SensorTilt tilt{1.0F, 1.0F};
+    ASSERT_TRUE(lidar.sensorTilt(tilt));
+    EXPECT_NEAR(tilt.roll, 0.0F, 1e-5F);
+    EXPECT_NEAR(tilt.pitch, 0.0F, 1e-5F);
+}
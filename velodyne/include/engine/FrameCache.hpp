@@ -0,0 +1,54 @@
+#pragma once
+
+#include "engine/FrameConsumer.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <optional>
+#include <unordered_map>
+
+namespace lidar
+{
+
+/// Least-recently-used cache of decoded frames keyed by scan index and bounded by the number of
+/// point bytes it keeps alive.
+class FrameCache
+{
+public:
+    explicit FrameCache(std::size_t capacityBytes = 0U);
+
+    void setCapacityBytes(std::size_t capacityBytes);
+    std::size_t capacityBytes() const noexcept { return m_capacityBytes; }
+
+    /// Returns the cached frame and marks it most recently used.
+    std::optional<Frame> find(std::size_t index);
+    bool contains(std::size_t index) const;
+    /// Frames larger than the whole budget are not cached.
+    void insert(std::size_t index, const Frame& frame);
+    void clear();
+
+    std::size_t sizeBytes() const noexcept { return m_sizeBytes; }
+    std::size_t entryCount() const noexcept { return m_entries.size(); }
+    uint64_t hits() const noexcept { return m_hits; }
+    uint64_t misses() const noexcept { return m_misses; }
+
+private:
+    struct Entry
+    {
+        std::size_t index;
+        Frame frame;
+        std::size_t bytes;
+    };
+
+    void evictToFit(std::size_t incomingBytes);
+
+    std::size_t m_capacityBytes;
+    std::size_t m_sizeBytes = 0U;
+    std::list<Entry> m_entries;
+    std::unordered_map<std::size_t, std::list<Entry>::iterator> m_lookup;
+    uint64_t m_hits = 0U;
+    uint64_t m_misses = 0U;
+};
+
+} // namespace lidar
@@ -0,0 +1,82 @@
+#pragma once
+
+#include "engine/FramePool.hpp"
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace lidar
+{
+
+struct Frame
+{
+    SharedPointCloud points;
+    uint64_t timestamp_us = 0U;
+    uint64_t sequence = 0U;
+    /// IMU samples the sensor received with this scan, oldest first.
+    std::vector<ImuSample> imu;
+    /// Sensor tilt after those samples, when the sensor estimates one.
+    std::optional<SensorTilt> tilt;
+};
+
+/// Receives published frames on its own executor thread (recorders, mappers, exporters...).
+class IFrameConsumer
+{
+public:
+    virtual ~IFrameConsumer() = default;
+
+    virtual const std::string& name() const noexcept = 0;
+    virtual void consumeFrame(const Frame& frame) = 0;
+};
+
+struct FrameConsumerStats
+{
+    std::string name;
+    uint64_t framesDelivered = 0U;
+    uint64_t framesDropped = 0U;
+};
+
+/// Dedicated thread plus bounded queue for one consumer. When the queue is full the oldest
+/// pending frame is dropped, so a slow consumer never blocks the publisher or its peers.
+class FrameConsumerExecutor
+{
+public:
+    FrameConsumerExecutor(std::shared_ptr<IFrameConsumer> consumer, std::size_t queueDepth);
+    ~FrameConsumerExecutor();
+
+    FrameConsumerExecutor(const FrameConsumerExecutor&) = delete;
+    FrameConsumerExecutor& operator=(const FrameConsumerExecutor&) = delete;
+
+    void publish(const Frame& frame);
+    /// Blocks until every queued frame has been consumed.
+    void drain();
+
+    FrameConsumerStats stats() const;
+
+private:
+    void workerLoop();
+
+    std::shared_ptr<IFrameConsumer> m_consumer;
+    std::size_t m_queueDepth;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_frameAvailable;
+    std::condition_variable m_idle;
+    std::deque<Frame> m_queue;
+    uint64_t m_delivered = 0U;
+    uint64_t m_dropped = 0U;
+    bool m_busy = false;
+    bool m_stopping = false;
+
+    std::thread m_worker;
+};
+
+} // namespace lidar
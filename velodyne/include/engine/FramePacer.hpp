@@ -0,0 +1,82 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace lidar
+{
+
+enum class OverloadPolicy
+{
+    ProcessEveryFrame = 0, // never drop; replay falls behind when processing is slow
+    KeepLatest,            // skip every frame that was superseded before processing could start
+    AdaptiveDecimation     // process every Nth frame, N following the measured processing time
+};
+
+struct OverloadSettings
+{
+    OverloadPolicy policy = OverloadPolicy::KeepLatest;
+    /// Frames whose age exceeds this many frame periods are never processed (except with
+    /// ProcessEveryFrame, which only reports them).
+    float maxDataAgeInFrames = 2.0F;
+    std::size_t maxDecimation = 8U;
+    /// Weight of the newest processing-time sample in the moving average used for decimation.
+    float processingTimeSmoothing = 0.2F;
+};
+
+struct FrameStats
+{
+    uint64_t framesCaptured = 0U;
+    uint64_t framesProcessed = 0U;
+    uint64_t framesDropped = 0U;
+    uint64_t staleFramesDropped = 0U;
+    std::size_t decimationFactor = 1U;
+    std::chrono::microseconds lastProcessingTime{0};
+    std::chrono::microseconds lastDataAge{0};
+    std::chrono::microseconds maxDataAge{0};
+    std::chrono::microseconds averageDataAge{0};
+};
+
+/// Replays frames on a fixed arrival schedule (one frame per period) and decides which frames
+/// the engine processes when it cannot keep up. Age of data is measured from a frame's scheduled
+/// arrival until its processing finished.
+class FramePacer
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit FramePacer(OverloadSettings settings = {});
+
+    void setSettings(const OverloadSettings& settings);
+    const OverloadSettings& settings() const noexcept { return m_settings; }
+
+    void start(Clock::time_point now);
+    bool started() const noexcept { return m_started; }
+
+    Clock::time_point nextArrival() const noexcept { return m_nextArrival; }
+
+    /// Number of frames to discard before the next processed frame.
+    std::size_t framesToSkip(Clock::time_point now, Clock::duration period) const;
+
+    /// Advances the schedule past a frame that is discarded unprocessed.
+    void recordDropped(Clock::duration period, bool stale);
+    /// Advances the schedule past a captured frame and returns its scheduled arrival.
+    Clock::time_point recordCaptured(Clock::duration period);
+    void recordProcessed(Clock::time_point arrival, Clock::time_point finished, Clock::duration processingTime);
+
+    const FrameStats& stats() const noexcept { return m_stats; }
+
+private:
+    std::size_t decimationFor(Clock::duration period) const;
+
+    OverloadSettings m_settings;
+    FrameStats m_stats;
+    Clock::time_point m_nextArrival{};
+    double m_averageProcessingUs = 0.0;
+    double m_averageAgeUs = 0.0;
+    std::size_t m_framesUntilProcessed = 0U;
+    bool m_started = false;
+};
+
+} // namespace lidar
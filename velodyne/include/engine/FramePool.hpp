@@ -0,0 +1,40 @@
+#pragma once
+
+#include "sensors/BaseLidarSensor.hpp"
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace lidar
+{
+
+/// Immutable, reference-counted point cloud shared by every consumer of a frame.
+using SharedPointCloud = std::shared_ptr<const BaseLidarSensor::PointCloud>;
+
+/// Recycles point cloud buffers so publishing a frame never reallocates once the pool is warm.
+/// A buffer returns to the pool when its last reference is released; buffers still referenced
+/// after the pool is destroyed are simply freed.
+class FramePool
+{
+public:
+    FramePool();
+
+    std::shared_ptr<BaseLidarSensor::PointCloud> acquire();
+
+    std::size_t allocatedCount() const;
+    std::size_t availableCount() const;
+
+private:
+    struct State
+    {
+        mutable std::mutex mutex;
+        std::vector<std::unique_ptr<BaseLidarSensor::PointCloud>> freeBuffers;
+        std::size_t allocated = 0U;
+    };
+
+    std::shared_ptr<State> m_state;
+};
+
+} // namespace lidar
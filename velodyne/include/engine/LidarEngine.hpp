@@ -1,12 +1,20 @@
 #pragma once
 
+#include "engine/FrameCache.hpp"
+#include "engine/FrameConsumer.hpp"
+#include "engine/FramePacer.hpp"
+#include "engine/FramePool.hpp"
+#include "engine/ReplayController.hpp"
+#include "engine/ThreadPool.hpp"
 #include "sensors/BaseLidarSensor.hpp"
+#include "sensors/EgoMotion.hpp"
 #include "visualization/IVisualizer.hpp"
 
-#include <array>
 #include <chrono>
 #include <memory>
+#include <optional>
 #include <string>
+#include <vector>
 
 namespace lidar
 {
@@ -15,24 +23,62 @@ class LidarEngine
 {
 public:
     explicit LidarEngine(std::unique_ptr<BaseLidarSensor> sensor,
-                         std::unique_ptr<visualization::IVisualizer> visualizer = nullptr);
+                         std::unique_ptr<visualization::IVisualizer> visualizer = nullptr,
+                         ThreadPoolConfig schedulerConfig = {});
 
     bool initialize();
     void run();
 
     uint64_t latestTimestamp() const { return m_latestTimestamp; }
+    ThreadPool& threadPool() noexcept { return m_threadPool; }
+
+    void setOverloadSettings(const OverloadSettings& settings) { m_pacer.setSettings(settings); }
+    const FrameStats& frameStats() const noexcept { return m_pacer.stats(); }
+
+    /// Adds a consumer fed with every published frame on its own thread. Up to queueDepth frames
+    /// wait for a busy consumer before the oldest is dropped.
+    bool registerConsumer(std::shared_ptr<IFrameConsumer> consumer, std::size_t queueDepth = 2U);
+    std::vector<FrameConsumerStats> consumerStats() const;
+    void drainConsumers();
+
+    /// Playback controls; only effective for sensors that support random access.
+    ReplayController& replay() noexcept { return m_replay; }
+    const FrameCache& frameCache() const noexcept { return m_frameCache; }
+    void setReplaySettings(const ReplaySettings& settings);
 
 private:
     friend struct LidarEngineTestHelper;
-    void captureFrame();
+    bool captureFrame();
+    void publishFrame();
+    /// The sensor's own tilt estimate, recorded with each frame so replayed frames keep theirs.
+    std::optional<SensorTilt> sensorTilt() const;
+    void dropFrames(std::size_t count, FramePacer::Clock::time_point now, FramePacer::Clock::duration period);
+    bool presentReplayFrame(std::size_t index);
+    std::optional<Frame> loadReplayFrame(std::size_t index);
+    void prefetchReplayFrames(FramePacer::Clock::time_point deadline);
+    void runPausedReplayTick();
 
     static constexpr std::chrono::milliseconds kTargetFrameDuration{33};
+    /// Tick length while paused, so scrubbing cached frames stays at 60 fps.
+    static constexpr std::chrono::milliseconds kScrubFrameDuration{16};
 
+    // Declared first so the pool and the motion source outlive the sensor and visualizer that borrow them.
+    ThreadPool m_threadPool;
+    /// Sensor-frame odometry from the visualizer, used to deskew the sensor's scans.
+    PoseStreamMotionSource m_odometryMotion;
     std::unique_ptr<BaseLidarSensor> m_sensor;
     std::unique_ptr<visualization::IVisualizer> m_visualizer;
-    std::array<BaseLidarSensor::PointCloud, 2> m_pointBuffers;
-    size_t m_readIndex;
+    FramePool m_framePool;
+    Frame m_currentFrame;
     uint64_t m_latestTimestamp;
+    uint64_t m_frameSequence;
+    FramePacer m_pacer;
+    ReplaySettings m_replaySettings;
+    ReplayController m_replay;
+    FrameCache m_frameCache;
+    FramePacer::Clock::duration m_lastDecodeTime{};
+    bool m_randomAccess;
+    std::vector<std::unique_ptr<FrameConsumerExecutor>> m_consumers;
 };
 
 } // namespace lidar
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstddef>
+#include <optional>
+#include <utility>
+
+namespace lidar
+{
+
+struct ReplaySettings
+{
+    /// Budget for decoded frames kept in memory; an HDL-32 scan is roughly 1 MB.
+    std::size_t cacheBytes = 256U * 1024U * 1024U;
+    /// Frames decoded ahead in the playback direction while waiting for the next frame.
+    std::size_t prefetchFrames = 8U;
+};
+
+/// Playback state for recorded captures: play/pause, direction, single steps, jumps and an A-B
+/// loop. It only tracks scan indices; LidarEngine resolves them through its frame cache.
+class ReplayController
+{
+public:
+    void play();
+    void pause();
+    bool paused() const noexcept { return m_paused; }
+
+    void setReverse(bool reverse) { m_reverse = reverse; }
+    bool reverse() const noexcept { return m_reverse; }
+
+    /// Steps pause playback and move one frame.
+    void stepForward();
+    void stepBackward();
+    void jumpTo(std::size_t index);
+
+    void setLoop(std::size_t first, std::size_t last);
+    void setLoopStart() { setLoop(m_position, m_loop ? m_loop->second : m_position); }
+    void setLoopEnd() { setLoop(m_loop ? m_loop->first : m_position, m_position); }
+    void clearLoop() { m_loop.reset(); }
+    const std::optional<std::pair<std::size_t, std::size_t>>& loop() const noexcept { return m_loop; }
+
+    /// Scan index currently on screen (or about to be).
+    std::size_t position() const noexcept { return m_position; }
+    /// Total frames once the end of the capture has been reached.
+    const std::optional<std::size_t>& frameCount() const noexcept { return m_frameCount; }
+    /// Frames the scrub bar can address: the whole capture, or every frame seen so far.
+    std::size_t knownFrameCount() const noexcept;
+    /// Records the end of the capture; playback pauses on the last frame.
+    void setFrameCount(std::size_t count);
+
+    /// Returns the index to present on this tick while playing and advances the position.
+    std::size_t advance();
+    /// Index `steps` frames ahead in the playback direction, without moving.
+    std::optional<std::size_t> peek(std::size_t steps) const;
+    /// Returns the position once after a step or jump so paused playback can present it.
+    std::optional<std::size_t> takePendingFrame();
+
+private:
+    std::optional<std::size_t> following(std::size_t index) const;
+
+    std::size_t m_position = 0U;
+    std::size_t m_highestSeen = 0U;
+    std::optional<std::size_t> m_frameCount;
+    std::optional<std::pair<std::size_t, std::size_t>> m_loop;
+    bool m_paused = false;
+    bool m_reverse = false;
+    bool m_pendingFrame = true;
+};
+
+} // namespace lidar
@@ -0,0 +1,115 @@
+#pragma once
+
+#include "sensors/BaseLidarSensor.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace lidar
+{
+
+class ThreadPool;
+
+enum class StageKind
+{
+    Filter = 0,
+    Segment,
+    Map,
+    Export
+};
+
+/// Per-frame buffers exchanged between stages. Buffers are created once when the graph is
+/// compiled and only cleared between frames, so steady-state processing does not allocate.
+class FrameContext
+{
+public:
+    const BaseLidarSensor::PointCloud& input(const std::string& name) const;
+    BaseLidarSensor::PointCloud& output(const std::string& name);
+    uint64_t timestamp() const noexcept { return m_timestamp; }
+
+private:
+    friend class StageGraph;
+
+    std::unordered_map<std::string, BaseLidarSensor::PointCloud> m_buffers;
+    const BaseLidarSensor::PointCloud* m_source = nullptr;
+    uint64_t m_timestamp = 0U;
+};
+
+class ProcessingStage
+{
+public:
+    virtual ~ProcessingStage() = default;
+
+    virtual const std::string& name() const noexcept = 0;
+    virtual StageKind kind() const noexcept = 0;
+    /// Buffers read by the stage; `StageGraph::kSourceBuffer` refers to the incoming scan.
+    virtual const std::vector<std::string>& inputs() const noexcept = 0;
+    /// Buffers produced by the stage. A port may also just sequence state owned by the stage,
+    /// in which case its buffer stays empty.
+    virtual const std::vector<std::string>& outputs() const noexcept = 0;
+    virtual void process(FrameContext& frame) = 0;
+};
+
+class FunctionStage : public ProcessingStage
+{
+public:
+    using Callback = std::function<void(FrameContext&)>;
+
+    FunctionStage(std::string name,
+                  StageKind kind,
+                  std::vector<std::string> inputs,
+                  std::vector<std::string> outputs,
+                  Callback callback);
+
+    const std::string& name() const noexcept override { return m_name; }
+    StageKind kind() const noexcept override { return m_kind; }
+    const std::vector<std::string>& inputs() const noexcept override { return m_inputs; }
+    const std::vector<std::string>& outputs() const noexcept override { return m_outputs; }
+    void process(FrameContext& frame) override;
+
+private:
+    std::string m_name;
+    StageKind m_kind;
+    std::vector<std::string> m_inputs;
+    std::vector<std::string> m_outputs;
+    Callback m_callback;
+};
+
+class StageGraph
+{
+public:
+    static constexpr const char* kSourceBuffer = "source";
+
+    void addStage(std::unique_ptr<ProcessingStage> stage);
+    void addStage(std::string name,
+                  StageKind kind,
+                  std::vector<std::string> inputs,
+                  std::vector<std::string> outputs,
+                  FunctionStage::Callback callback);
+
+    /// Validates the declared ports and orders the stages into dependency levels. Stages within
+    /// a level never depend on each other and are executed concurrently.
+    bool compile();
+    bool compiled() const noexcept { return m_compiled; }
+
+    void setThreadPool(ThreadPool* pool) noexcept { m_threadPool = pool; }
+    void run(const BaseLidarSensor::PointCloud& source, uint64_t timestamp = 0U);
+
+    std::size_t stageCount() const noexcept { return m_stages.size(); }
+    const std::vector<std::vector<std::size_t>>& levels() const noexcept { return m_levels; }
+    const ProcessingStage& stage(std::size_t index) const { return *m_stages[index]; }
+
+private:
+    std::vector<std::unique_ptr<ProcessingStage>> m_stages;
+    std::vector<std::vector<std::size_t>> m_levels;
+    FrameContext m_frame;
+    ThreadPool* m_threadPool = nullptr;
+    bool m_compiled = false;
+};
+
+} // namespace lidar
@@ -0,0 +1,235 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace lidar
+{
+
+enum class TaskPriority
+{
+    High = 0,
+    Normal,
+    Low
+};
+
+enum class IdlePolicy
+{
+    Sleep = 0,     // block on a condition variable as soon as no work is available
+    Spin,          // busy-wait for work; lowest latency, burns a core per worker
+    SpinThenSleep  // spin for `spinDuration`, then block
+};
+
+struct ThreadPoolConfig
+{
+    std::optional<std::size_t> workerCount; // defaults to hardware threads minus the caller
+    std::vector<int> cpuAffinity;           // CPU index per worker, reused cyclically; empty = OS scheduling
+    IdlePolicy idlePolicy = IdlePolicy::SpinThenSleep;
+    std::chrono::microseconds spinDuration{50};
+};
+
+/// Work-stealing pool shared by the engine, the decoder, and the processing stages. Every worker
+/// owns a deque per priority; tasks spawned from a worker stay on its deque (LIFO) while idle
+/// workers steal from the opposite end. Threads that wait for a batch help executing tasks.
+class ThreadPool
+{
+public:
+    using Task = std::function<void()>;
+
+    explicit ThreadPool(ThreadPoolConfig config = {});
+    explicit ThreadPool(std::size_t workerCount);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    std::size_t workerCount() const noexcept { return m_workers.size(); }
+    /// Number of threads that execute a parallel call, including the calling thread.
+    std::size_t concurrency() const noexcept { return m_workers.size() + 1U; }
+    const ThreadPoolConfig& config() const noexcept { return m_config; }
+
+    /// Runs every task and blocks until all of them completed.
+    void parallelInvoke(const std::vector<Task>& tasks, TaskPriority priority = TaskPriority::Normal);
+
+    /// Calls `body(chunkBegin, chunkEnd)` for consecutive chunks of at most `grainSize` indices.
+    template <typename Body>
+    void parallelFor(std::size_t begin,
+                     std::size_t end,
+                     std::size_t grainSize,
+                     Body&& body,
+                     TaskPriority priority = TaskPriority::Normal);
+
+    /// Reduces `chunk(chunkBegin, chunkEnd)` results with `combine` in chunk order. Chunk bounds
+    /// only depend on `grainSize`, so the result does not depend on the number of workers.
+    template <typename T, typename Chunk, typename Combine>
+    T parallelReduce(std::size_t begin,
+                     std::size_t end,
+                     std::size_t grainSize,
+                     T identity,
+                     Chunk&& chunk,
+                     Combine&& combine,
+                     TaskPriority priority = TaskPriority::Normal);
+
+    static std::size_t defaultWorkerCount() noexcept;
+
+private:
+    static constexpr std::size_t kPriorityCount = 3U;
+    static constexpr std::size_t kNoWorker = static_cast<std::size_t>(-1);
+
+    struct Batch;
+    struct QueuedTask
+    {
+        const Task* task = nullptr;
+        Batch* batch = nullptr;
+    };
+
+    struct WorkQueue
+    {
+        std::mutex mutex;
+        std::array<std::deque<QueuedTask>, kPriorityCount> tasks;
+    };
+
+    void workerLoop(std::size_t workerIndex);
+    void waitForWork();
+    void applyAffinity(std::size_t workerIndex);
+    std::size_t currentWorkerIndex() const noexcept;
+    bool runPendingTask(std::size_t workerIndex);
+    bool popTask(std::size_t workerIndex, QueuedTask& out);
+    static void execute(const QueuedTask& queued);
+
+    ThreadPoolConfig m_config;
+    std::vector<std::thread> m_workers;
+    std::vector<std::unique_ptr<WorkQueue>> m_localQueues;
+    WorkQueue m_globalQueue;
+    std::atomic<std::size_t> m_pendingTasks{0U};
+    std::atomic<bool> m_stopping{false};
+    std::mutex m_sleepMutex;
+    std::condition_variable m_wakeUp;
+};
+
+template <typename Body>
+void ThreadPool::parallelFor(std::size_t begin,
+                             std::size_t end,
+                             std::size_t grainSize,
+                             Body&& body,
+                             TaskPriority priority)
+{
+    if (end <= begin)
+    {
+        return;
+    }
+
+    grainSize = std::max<std::size_t>(grainSize, 1U);
+    const std::size_t chunkCount = (end - begin + grainSize - 1U) / grainSize;
+    if (chunkCount == 1U || m_workers.empty())
+    {
+        body(begin, end);
+        return;
+    }
+
+    std::atomic<std::size_t> nextChunk{0U};
+    const Task drain = [&]() {
+        for (;;)
+        {
+            const std::size_t chunkIndex = nextChunk.fetch_add(1U, std::memory_order_relaxed);
+            if (chunkIndex >= chunkCount)
+            {
+                return;
+            }
+            const std::size_t chunkBegin = begin + chunkIndex * grainSize;
+            body(chunkBegin, std::min(end, chunkBegin + grainSize));
+        }
+    };
+    const std::vector<Task> tasks(std::min(chunkCount, concurrency()), drain);
+    parallelInvoke(tasks, priority);
+}
+
+template <typename T, typename Chunk, typename Combine>
+T ThreadPool::parallelReduce(std::size_t begin,
+                             std::size_t end,
+                             std::size_t grainSize,
+                             T identity,
+                             Chunk&& chunk,
+                             Combine&& combine,
+                             TaskPriority priority)
+{
+    if (end <= begin)
+    {
+        return identity;
+    }
+
+    grainSize = std::max<std::size_t>(grainSize, 1U);
+    const std::size_t chunkCount = (end - begin + grainSize - 1U) / grainSize;
+    std::vector<T> partials(chunkCount, identity);
+    parallelFor(
+        0U,
+        chunkCount,
+        1U,
+        [&](std::size_t firstChunk, std::size_t lastChunk) {
+            for (std::size_t chunkIndex = firstChunk; chunkIndex < lastChunk; ++chunkIndex)
+            {
+                const std::size_t chunkBegin = begin + chunkIndex * grainSize;
+                partials[chunkIndex] = chunk(chunkBegin, std::min(end, chunkBegin + grainSize));
+            }
+        },
+        priority);
+
+    T result = std::move(identity);
+    for (auto& partial : partials)
+    {
+        result = combine(std::move(result), std::move(partial));
+    }
+    return result;
+}
+
+/// Helpers for code paths that may run without a pool attached.
+template <typename Body>
+void parallelFor(ThreadPool* pool, std::size_t begin, std::size_t end, std::size_t grainSize, Body&& body)
+{
+    if (pool)
+    {
+        pool->parallelFor(begin, end, grainSize, std::forward<Body>(body));
+    }
+    else if (begin < end)
+    {
+        body(begin, end);
+    }
+}
+
+template <typename T, typename Chunk, typename Combine>
+T parallelReduce(ThreadPool* pool,
+                 std::size_t begin,
+                 std::size_t end,
+                 std::size_t grainSize,
+                 T identity,
+                 Chunk&& chunk,
+                 Combine&& combine)
+{
+    if (pool)
+    {
+        return pool->parallelReduce(
+            begin, end, grainSize, std::move(identity), std::forward<Chunk>(chunk), std::forward<Combine>(combine));
+    }
+
+    grainSize = std::max<std::size_t>(grainSize, 1U);
+    T result = std::move(identity);
+    for (std::size_t chunkBegin = begin; chunkBegin < end; chunkBegin += grainSize)
+    {
+        result = combine(std::move(result), chunk(chunkBegin, std::min(end, chunkBegin + grainSize)));
+    }
+    return result;
+}
+
+} // namespace lidar
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
 #include <string>
 #include <vector>
@@ -7,6 +8,9 @@
 namespace lidar
 {
 
+class ThreadPool;
+class IEgoMotionSource;
+
 struct LidarPoint
 {
     float x;
@@ -15,6 +19,26 @@ struct LidarPoint
     float intensity;
 };
 
+/// [m/s^2]
+inline constexpr float kStandardGravity = 9.80665F;
+
+/// Inertial reading in the sensor frame.
+struct ImuSample
+{
+    uint64_t timestamp_us = 0U;
+    /// [rad/s]
+    float angularVelocity[3] = {0.0F, 0.0F, 0.0F};
+    /// Specific force; points up with magnitude g when the sensor is at rest [m/s^2].
+    float acceleration[3] = {0.0F, 0.0F, 0.0F};
+};
+
+/// Sensor roll (about x) and pitch (about y) relative to gravity [rad].
+struct SensorTilt
+{
+    float roll = 0.0F;
+    float pitch = 0.0F;
+};
+
 class BaseLidarSensor
 {
 public:
@@ -30,6 +54,34 @@ public:
 
     /// The sensor pushes the next frame into the provided buffer.
     virtual bool readNextScan(PointCloud& destination, uint64_t& timestamp_us) = 0;
+
+    /// Advances past the next frame without handing it out; used when the engine drops frames.
+    /// Sensors that can skip decoding should override this.
+    virtual bool skipScan(uint64_t& timestamp_us)
+    {
+        PointCloud discarded;
+        return readNextScan(discarded, timestamp_us);
+    }
+
+    /// Recorded sources can reposition to any scan; live sensors keep these defaults.
+    virtual bool supportsRandomAccess() const noexcept { return false; }
+    /// Positions the sensor so the next readNextScan returns scan `index`.
+    virtual bool seekScan(std::size_t /*index*/) { return false; }
+    /// Index of the scan the next readNextScan call returns.
+    virtual std::size_t nextScanIndex() const noexcept { return 0U; }
+
+    /// Shared worker pool owned by the engine; sensors may use it to decode a scan in parallel.
+    virtual void setThreadPool(ThreadPool* /*pool*/) {}
+
+    /// Motion used to deskew each scan to its end timestamp; nullptr leaves scans as measured.
+    /// Sensors without per-packet timing ignore it.
+    virtual void setEgoMotionSource(IEgoMotionSource* /*source*/) {}
+
+    /// IMU samples received with the scan last handed out or skipped, oldest first. Sensors without
+    /// an IMU leave it empty.
+    virtual void imuSamples(std::vector<ImuSample>& destination) const { destination.clear(); }
+    /// Tilt estimated from the IMU samples so far; false for sensors without one, or before it settles.
+    virtual bool sensorTilt(SensorTilt& /*tilt*/) const { return false; }
 };
 
 } // namespace lidar
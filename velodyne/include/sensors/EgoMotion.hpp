@@ -0,0 +1,100 @@
+#pragma once
+
+#include "sensors/BaseLidarSensor.hpp"
+
+#include <Eigen/Geometry>
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+
+namespace lidar
+{
+
+/// Sensor velocity, expressed in the sensor frame.
+struct EgoMotion
+{
+    /// [m/s]
+    Eigen::Vector3f linearVelocity = Eigen::Vector3f::Zero();
+    /// Rotation axis scaled by the rate [rad/s].
+    Eigen::Vector3f angularVelocity = Eigen::Vector3f::Zero();
+};
+
+/// Supplies the sensor's motion for deskewing. Sensors query it from their decode thread.
+class IEgoMotionSource
+{
+public:
+    virtual ~IEgoMotionSource() = default;
+
+    /// Motion around `timestamp_us`; false when none is known and the scan stays as measured.
+    virtual bool motionAt(uint64_t timestamp_us, EgoMotion& motion) const = 0;
+};
+
+/// Constant-velocity model, set from the vehicle bus or the last odometry estimate.
+class ConstantVelocityMotionSource : public IEgoMotionSource
+{
+public:
+    void setMotion(const EgoMotion& motion);
+    void clear();
+    bool motionAt(uint64_t timestamp_us, EgoMotion& motion) const override;
+
+private:
+    mutable std::mutex m_mutex;
+    EgoMotion m_motion;
+    bool m_valid = false;
+};
+
+/// Velocity differentiated from timestamped poses, such as scan-registration odometry or an
+/// external localization stream. Queries between two poses use that pair, queries outside the
+/// stream extrapolate its first or last pair.
+class PoseStreamMotionSource : public IEgoMotionSource
+{
+public:
+    static constexpr std::size_t kMaxPoses = 64U;
+
+    /// `sensorToWorld` maps the sensor frame at `timestamp_us` into a fixed frame. Poses must
+    /// arrive in time order; older ones are dropped.
+    void pushPose(uint64_t timestamp_us, const Eigen::Isometry3f& sensorToWorld);
+    void clear();
+    bool motionAt(uint64_t timestamp_us, EgoMotion& motion) const override;
+
+private:
+    struct StampedPose
+    {
+        uint64_t timestamp_us = 0U;
+        Eigen::Isometry3f sensorToWorld = Eigen::Isometry3f::Identity();
+    };
+
+    mutable std::mutex m_mutex;
+    std::deque<StampedPose> m_poses;
+};
+
+/// Rotation-only motion from the sensor's own gyros, plus roll and pitch from the accelerometers.
+/// Linear velocity stays zero: it removes the skew of turning, which dominates at range, but not of
+/// driving forwards. Samples that go back in time, or after a long gap, restart both estimates.
+class ImuMotionSource : public IEgoMotionSource
+{
+public:
+    static constexpr std::size_t kMaxSamples = 256U;
+    /// Gyro readings within this distance of a query are averaged [us].
+    static constexpr uint64_t kRateWindowUs = 50000U;
+    /// Low-pass time constant of the gravity estimate [s].
+    static constexpr float kGravityTimeConstant = 1.0F;
+
+    void pushSample(const ImuSample& sample);
+    void clear();
+    bool motionAt(uint64_t timestamp_us, EgoMotion& motion) const override;
+
+    /// Sensor roll (about x) and pitch (about y) relative to gravity [rad]; false until an
+    /// accelerometer reading close to 1 g has arrived.
+    bool tilt(float& roll, float& pitch) const;
+
+private:
+    mutable std::mutex m_mutex;
+    std::deque<ImuSample> m_samples;
+    Eigen::Vector3f m_gravity = Eigen::Vector3f::Zero();
+    bool m_hasGravity = false;
+};
+
+} // namespace lidar
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace lidar
+{
+
+struct RangeImageFilterSettings
+{
+    /// Neighbours within `absoluteTolerance + relativeTolerance * range` of a return support it.
+    float absoluteTolerance = 0.3F;
+    float relativeTolerance = 0.05F;
+    /// Returns with fewer supporting neighbours are rejected.
+    uint32_t minSupport = 1U;
+    /// Treat the first and last column as adjacent (a full revolution).
+    bool wrapColumns = true;
+};
+
+/// Drops isolated returns (rain, dust, single spurious echoes) from an organized range image.
+/// Each return is compared with its 8 ring and column neighbours, so no spatial search is needed.
+/// A real surface almost always has a neighbour at a similar range, usually the next firing of
+/// the same laser.
+class RangeImageFilter
+{
+public:
+    explicit RangeImageFilter(const RangeImageFilterSettings& settings = {});
+
+    void configure(const RangeImageFilterSettings& settings) { m_settings = settings; }
+    const RangeImageFilterSettings& settings() const noexcept { return m_settings; }
+
+    /// `ranges` holds `columns` firings of `rows` rings each, column after column, with the rings of a
+    /// column ordered by elevation. A range of 0 marks a missing return. `keep` is resized to
+    /// ranges.size() and set to 1 for every return that passes. Returns the number of rejected returns.
+    std::size_t filter(std::span<const float> ranges,
+                       std::size_t rows,
+                       std::size_t columns,
+                       std::vector<uint8_t>& keep) const;
+
+private:
+    RangeImageFilterSettings m_settings;
+};
+
+} // namespace lidar
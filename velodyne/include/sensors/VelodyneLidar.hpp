@@ -3,10 +3,14 @@
 #include "LidarScan.hpp"
 #include "VelodynePCAPReader.hpp"
 #include "sensors/BaseLidarSensor.hpp"
+#include "sensors/EgoMotion.hpp"
+#include "sensors/RangeImageFilter.hpp"
 
 #include <array>
+#include <cstddef>
 #include <cstdint>
 #include <string>
+#include <vector>
 
 namespace lidar
 {
@@ -22,11 +26,41 @@ public:
     const std::string& identifier() const noexcept override;
     void configure(float vertical_fov_deg, float max_range_m) override;
     bool readNextScan(PointCloud& destination, uint64_t& timestamp_us) override;
+    bool skipScan(uint64_t& timestamp_us) override;
+    bool supportsRandomAccess() const noexcept override { return true; }
+    bool seekScan(std::size_t index) override;
+    std::size_t nextScanIndex() const noexcept override { return m_pendingIndex; }
+    void setThreadPool(ThreadPool* pool) override { m_threadPool = pool; }
+    void setEgoMotionSource(IEgoMotionSource* source) override { m_egoMotion = source; }
+    void imuSamples(std::vector<ImuSample>& destination) const override { destination = m_imuSamples; }
+    bool sensorTilt(SensorTilt& tilt) const override { return m_imuMotion.tilt(tilt.roll, tilt.pitch); }
+
+    /// Deskews rotation with the gyros of the capture's positioning packets whenever the ego-motion
+    /// source has no motion. Off by default; the factory turns it on for the HDL-32E.
+    void setImuDeskew(bool enabled) { m_imuDeskew = enabled; }
+
+    /// Drops isolated returns from the organized scan before it is decoded. Off by default; the
+    /// factory turns it on.
+    void setNoiseFilter(bool enabled, const RangeImageFilterSettings& settings = {});
+    /// Returns the noise filter rejected in the last decoded scan.
+    std::size_t rejectedReturns() const noexcept { return m_rejectedReturns; }
 
 private:
+    /// Sensor pose at a block's timestamp relative to the scan timestamp.
+    struct BlockTransform
+    {
+        Eigen::Matrix3f rotation = Eigen::Matrix3f::Identity();
+        Eigen::Vector3f translation = Eigen::Vector3f::Zero();
+    };
+
+    bool advanceScan();
     void initializeSensor();
     void finalizeSensor();
     void populateGeometry(PointCloud& destination);
+    void buildNoiseMask();
+    void collectImuSamples();
+    bool buildBlockTransforms();
+    void decodeBlocks(std::size_t firstBlock, std::size_t lastBlock, PointCloud& destination) const;
 
     static const std::array<float, VDYNE::maxkHDLNumBeams> HDL32_VERTICAL_ANGLES_RAD;
     static const std::array<float, VDYNE::maxkHDLNumBeams> VLP16_VERTICAL_ANGLES_RAD;
@@ -43,6 +77,28 @@ private:
     float m_microsecondsPerLaserFiring = 1.152F;
     float m_spinRate = 600.0F * (1.0F / 60.0F * 2.0F * 3.14159265358979323846F / 1e6F);
 
+    ThreadPool* m_threadPool = nullptr;
+    std::vector<PointCloud> m_decodeChunks;
+
+    RangeImageFilter m_noiseFilter;
+    bool m_noiseFilterEnabled = false;
+    /// Ranges per firing column, rings ordered by elevation; reused between scans.
+    std::vector<float> m_rangeImage;
+    std::vector<uint8_t> m_keepMask;
+    std::array<uint8_t, VDYNE::maxkHDLNumBeams> m_beamRow{};
+    std::size_t m_rejectedReturns = 0U;
+
+    IEgoMotionSource* m_egoMotion = nullptr;
+    ImuMotionSource m_imuMotion;
+    std::vector<ImuSample> m_imuSamples;
+    bool m_imuDeskew = false;
+    std::vector<BlockTransform> m_blockTransforms;
+    bool m_deskew = false;
+
+    /// Stream offset of every scan seen so far, indexed by scan number.
+    std::vector<long long> m_scanOffsets;
+    std::size_t m_pendingIndex = 0U;
+
     bool m_initialized = false;
     bool m_pendingScan = false;
 };
@@ -0,0 +1,83 @@
+#include "engine/FrameCache.hpp"
+
+namespace lidar
+{
+
+namespace
+{
+std::size_t frameBytes(const Frame& frame)
+{
+    return frame.points ? frame.points->size() * sizeof(LidarPoint) : 0U;
+}
+} // namespace
+
+FrameCache::FrameCache(std::size_t capacityBytes)
+    : m_capacityBytes(capacityBytes)
+{
+}
+
+void FrameCache::setCapacityBytes(std::size_t capacityBytes)
+{
+    m_capacityBytes = capacityBytes;
+    evictToFit(0U);
+}
+
+std::optional<Frame> FrameCache::find(std::size_t index)
+{
+    const auto it = m_lookup.find(index);
+    if (it == m_lookup.end())
+    {
+        ++m_misses;
+        return std::nullopt;
+    }
+
+    ++m_hits;
+    m_entries.splice(m_entries.begin(), m_entries, it->second);
+    return it->second->frame;
+}
+
+bool FrameCache::contains(std::size_t index) const
+{
+    return m_lookup.find(index) != m_lookup.end();
+}
+
+void FrameCache::insert(std::size_t index, const Frame& frame)
+{
+    const std::size_t bytes = frameBytes(frame);
+    const auto existing = m_lookup.find(index);
+    if (existing != m_lookup.end())
+    {
+        m_sizeBytes -= existing->second->bytes;
+        m_entries.erase(existing->second);
+        m_lookup.erase(existing);
+    }
+    if (bytes > m_capacityBytes)
+    {
+        return;
+    }
+
+    evictToFit(bytes);
+    m_entries.push_front(Entry{index, frame, bytes});
+    m_lookup[index] = m_entries.begin();
+    m_sizeBytes += bytes;
+}
+
+void FrameCache::clear()
+{
+    m_entries.clear();
+    m_lookup.clear();
+    m_sizeBytes = 0U;
+}
+
+void FrameCache::evictToFit(std::size_t incomingBytes)
+{
+    while (!m_entries.empty() && m_sizeBytes + incomingBytes > m_capacityBytes)
+    {
+        const Entry& oldest = m_entries.back();
+        m_sizeBytes -= oldest.bytes;
+        m_lookup.erase(oldest.index);
+        m_entries.pop_back();
+    }
+}
+
+} // namespace lidar
@@ -0,0 +1,85 @@
+#include "engine/FrameConsumer.hpp"
+
+#include <algorithm>
+#include <utility>
+
+namespace lidar
+{
+
+FrameConsumerExecutor::FrameConsumerExecutor(std::shared_ptr<IFrameConsumer> consumer, std::size_t queueDepth)
+    : m_consumer(std::move(consumer))
+    , m_queueDepth(std::max<std::size_t>(queueDepth, 1U))
+    , m_worker([this] { workerLoop(); })
+{
+}
+
+FrameConsumerExecutor::~FrameConsumerExecutor()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_frameAvailable.notify_all();
+    if (m_worker.joinable())
+    {
+        m_worker.join();
+    }
+}
+
+void FrameConsumerExecutor::publish(const Frame& frame)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_queue.size() >= m_queueDepth)
+        {
+            m_queue.pop_front();
+            ++m_dropped;
+        }
+        m_queue.push_back(frame);
+    }
+    m_frameAvailable.notify_one();
+}
+
+void FrameConsumerExecutor::drain()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_idle.wait(lock, [this] { return m_queue.empty() && !m_busy; });
+}
+
+FrameConsumerStats FrameConsumerExecutor::stats() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return FrameConsumerStats{m_consumer->name(), m_delivered, m_dropped};
+}
+
+void FrameConsumerExecutor::workerLoop()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true)
+    {
+        m_frameAvailable.wait(lock, [this] { return m_stopping || !m_queue.empty(); });
+        if (m_stopping)
+        {
+            return;
+        }
+
+        Frame frame = std::move(m_queue.front());
+        m_queue.pop_front();
+        m_busy = true;
+
+        lock.unlock();
+        m_consumer->consumeFrame(frame);
+        // Release the buffer before reacquiring the lock so it can return to the pool promptly.
+        frame = Frame{};
+        lock.lock();
+
+        ++m_delivered;
+        m_busy = false;
+        if (m_queue.empty())
+        {
+            m_idle.notify_all();
+        }
+    }
+}
+
+} // namespace lidar
@@ -0,0 +1,130 @@
+#include "engine/FramePacer.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace lidar
+{
+
+namespace
+{
+using Microseconds = std::chrono::microseconds;
+
+double toMicroseconds(FramePacer::Clock::duration duration)
+{
+    return static_cast<double>(std::chrono::duration_cast<Microseconds>(duration).count());
+}
+} // namespace
+
+FramePacer::FramePacer(OverloadSettings settings)
+{
+    setSettings(settings);
+}
+
+void FramePacer::setSettings(const OverloadSettings& settings)
+{
+    m_settings = settings;
+    m_settings.maxDecimation = std::max<std::size_t>(m_settings.maxDecimation, 1U);
+    m_settings.processingTimeSmoothing = std::clamp(m_settings.processingTimeSmoothing, 0.01F, 1.0F);
+}
+
+void FramePacer::start(Clock::time_point now)
+{
+    m_nextArrival = now;
+    m_framesUntilProcessed = 0U;
+    m_started = true;
+}
+
+std::size_t FramePacer::framesToSkip(Clock::time_point now, Clock::duration period) const
+{
+    if (m_settings.policy == OverloadPolicy::ProcessEveryFrame || period <= Clock::duration::zero())
+    {
+        return 0U;
+    }
+
+    std::size_t skip = 0U;
+    const Clock::duration behind = now - m_nextArrival;
+    if (m_settings.policy == OverloadPolicy::KeepLatest)
+    {
+        // Every frame that arrived before the newest arrived frame is already superseded.
+        if (behind >= period)
+        {
+            skip = static_cast<std::size_t>(behind / period);
+        }
+        return skip;
+    }
+
+    skip = m_framesUntilProcessed;
+    const double maxAgeUs = static_cast<double>(m_settings.maxDataAgeInFrames) * toMicroseconds(period);
+    const double ageUs = toMicroseconds(behind - period * static_cast<long long>(skip));
+    if (ageUs > maxAgeUs)
+    {
+        const double excessFrames = std::ceil((ageUs - maxAgeUs) / toMicroseconds(period));
+        skip += static_cast<std::size_t>(excessFrames);
+    }
+    return skip;
+}
+
+void FramePacer::recordDropped(Clock::duration period, bool stale)
+{
+    m_nextArrival += period;
+    ++m_stats.framesDropped;
+    if (stale)
+    {
+        ++m_stats.staleFramesDropped;
+    }
+    if (m_framesUntilProcessed > 0U)
+    {
+        --m_framesUntilProcessed;
+    }
+}
+
+FramePacer::Clock::time_point FramePacer::recordCaptured(Clock::duration period)
+{
+    const Clock::time_point arrival = m_nextArrival;
+    m_nextArrival += period;
+    ++m_stats.framesCaptured;
+
+    if (m_settings.policy == OverloadPolicy::AdaptiveDecimation)
+    {
+        m_stats.decimationFactor = decimationFor(period);
+        m_framesUntilProcessed = m_stats.decimationFactor - 1U;
+    }
+    else
+    {
+        m_stats.decimationFactor = 1U;
+        m_framesUntilProcessed = 0U;
+    }
+    return arrival;
+}
+
+void FramePacer::recordProcessed(Clock::time_point arrival, Clock::time_point finished, Clock::duration processingTime)
+{
+    const double smoothing = static_cast<double>(m_settings.processingTimeSmoothing);
+    const double processingUs = toMicroseconds(processingTime);
+    const double ageUs = std::max(0.0, toMicroseconds(finished - arrival));
+
+    m_averageProcessingUs =
+        m_stats.framesProcessed == 0U ? processingUs : m_averageProcessingUs + smoothing * (processingUs - m_averageProcessingUs);
+    m_averageAgeUs = m_stats.framesProcessed == 0U ? ageUs : m_averageAgeUs + smoothing * (ageUs - m_averageAgeUs);
+
+    ++m_stats.framesProcessed;
+    m_stats.lastProcessingTime = std::chrono::duration_cast<Microseconds>(processingTime);
+    m_stats.lastDataAge = Microseconds(static_cast<long long>(ageUs));
+    m_stats.maxDataAge = std::max(m_stats.maxDataAge, m_stats.lastDataAge);
+    m_stats.averageDataAge = Microseconds(static_cast<long long>(m_averageAgeUs));
+}
+
+std::size_t FramePacer::decimationFor(Clock::duration period) const
+{
+    const double periodUs = toMicroseconds(period);
+    if (periodUs <= 0.0 || m_stats.framesProcessed == 0U)
+    {
+        return 1U;
+    }
+
+    const auto factor = static_cast<std::size_t>(std::ceil(m_averageProcessingUs / periodUs));
+    return std::clamp<std::size_t>(factor, 1U, m_settings.maxDecimation);
+}
+
+} // namespace lidar
@@ -0,0 +1,58 @@
+#include "engine/FramePool.hpp"
+
+namespace lidar
+{
+
+FramePool::FramePool()
+    : m_state(std::make_shared<State>())
+{
+}
+
+std::shared_ptr<BaseLidarSensor::PointCloud> FramePool::acquire()
+{
+    std::unique_ptr<BaseLidarSensor::PointCloud> buffer;
+    {
+        std::lock_guard<std::mutex> lock(m_state->mutex);
+        if (!m_state->freeBuffers.empty())
+        {
+            buffer = std::move(m_state->freeBuffers.back());
+            m_state->freeBuffers.pop_back();
+        }
+        else
+        {
+            ++m_state->allocated;
+        }
+    }
+
+    if (!buffer)
+    {
+        buffer = std::make_unique<BaseLidarSensor::PointCloud>();
+    }
+    buffer->clear();
+
+    std::weak_ptr<State> weakState = m_state;
+    return std::shared_ptr<BaseLidarSensor::PointCloud>(buffer.release(),
+                                                        [weakState](BaseLidarSensor::PointCloud* cloud)
+                                                        {
+                                                            std::unique_ptr<BaseLidarSensor::PointCloud> owned(cloud);
+                                                            if (const auto state = weakState.lock())
+                                                            {
+                                                                std::lock_guard<std::mutex> lock(state->mutex);
+                                                                state->freeBuffers.push_back(std::move(owned));
+                                                            }
+                                                        });
+}
+
+std::size_t FramePool::allocatedCount() const
+{
+    std::lock_guard<std::mutex> lock(m_state->mutex);
+    return m_state->allocated;
+}
+
+std::size_t FramePool::availableCount() const
+{
+    std::lock_guard<std::mutex> lock(m_state->mutex);
+    return m_state->freeBuffers.size();
+}
+
+} // namespace lidar
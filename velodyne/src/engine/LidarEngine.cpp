@@ -1,8 +1,9 @@
 #include "engine/LidarEngine.hpp"
 #include "visualization/Visualizer.hpp"
 
-#include <iostream>
+#include <algorithm>
 #include <chrono>
+#include <iostream>
 #include <memory>
 #include <thread>
 
@@ -10,11 +11,15 @@ namespace lidar
 {
 
 LidarEngine::LidarEngine(std::unique_ptr<BaseLidarSensor> sensor,
-                         std::unique_ptr<visualization::IVisualizer> visualizer)
-    : m_sensor(std::move(sensor))
+                         std::unique_ptr<visualization::IVisualizer> visualizer,
+                         ThreadPoolConfig schedulerConfig)
+    : m_threadPool(std::move(schedulerConfig))
+    , m_sensor(std::move(sensor))
     , m_visualizer(std::move(visualizer))
-    , m_readIndex(0U)
     , m_latestTimestamp(0U)
+    , m_frameSequence(0U)
+    , m_frameCache(m_replaySettings.cacheBytes)
+    , m_randomAccess(false)
 {
     if (!m_visualizer)
     {
@@ -30,7 +35,16 @@ bool LidarEngine::initialize()
         return false;
     }
 
+    m_sensor->setThreadPool(&m_threadPool);
+    m_visualizer->setThreadPool(&m_threadPool);
+    m_sensor->setEgoMotionSource(&m_odometryMotion);
+    m_visualizer->setOdometryMotionSource(&m_odometryMotion);
     m_sensor->configure(30.0F, 120.0F);
+    m_randomAccess = m_sensor->supportsRandomAccess();
+    if (m_randomAccess)
+    {
+        m_visualizer->setReplayController(&m_replay, &m_frameCache);
+    }
     std::cout << "Preparing sensor " << m_sensor->identifier() << '\n';
     return m_visualizer->initialize();
 }
@@ -42,38 +56,260 @@ void LidarEngine::run()
         return;
     }
 
+    using Clock = FramePacer::Clock;
+    m_pacer.start(Clock::now());
+
     while (!m_visualizer->windowShouldClose())
     {
-        const auto frameStart = std::chrono::steady_clock::now();
+        if (m_randomAccess && m_replay.paused())
+        {
+            runPausedReplayTick();
+            // Resume on a fresh schedule so the pause is not counted as lag.
+            m_pacer.start(Clock::now());
+            continue;
+        }
 
-        captureFrame();
-        m_visualizer->updatePoints(m_pointBuffers[m_readIndex]);
-        m_visualizer->render();
+        // Replayed frames arrive one per scaled target period; the pacer decides which of the
+        // arrived frames are worth processing when we fall behind.
+        const auto period = std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<float, std::milli>(kTargetFrameDuration) / m_visualizer->frameSpeedScale());
+
+        if (m_randomAccess)
+        {
+            prefetchReplayFrames(m_pacer.nextArrival());
+        }
+        if (Clock::now() < m_pacer.nextArrival())
+        {
+            std::this_thread::sleep_until(m_pacer.nextArrival());
+        }
 
-        m_readIndex = (m_readIndex + 1U) % m_pointBuffers.size();
+        const auto frameStart = Clock::now();
+        dropFrames(m_pacer.framesToSkip(frameStart, period), frameStart, period);
 
-        const auto scaledTarget = kTargetFrameDuration / m_visualizer->frameSpeedScale();
-        const auto frameDuration = std::chrono::steady_clock::now() - frameStart;
-        if (frameDuration < scaledTarget)
+        const auto arrival = m_pacer.recordCaptured(period);
+        if (captureFrame())
         {
-            std::this_thread::sleep_for(scaledTarget - frameDuration);
+            publishFrame();
         }
+        if (m_currentFrame.points)
+        {
+            if (m_currentFrame.tilt)
+            {
+                m_visualizer->updateSensorTilt(*m_currentFrame.tilt);
+            }
+            m_visualizer->updatePoints(*m_currentFrame.points, m_currentFrame.timestamp_us);
+        }
+        m_visualizer->render();
+
+        const auto frameEnd = Clock::now();
+        m_pacer.recordProcessed(arrival, frameEnd, frameEnd - frameStart);
+        m_visualizer->updateFrameStats(m_pacer.stats());
     }
 }
 
-void LidarEngine::captureFrame()
+bool LidarEngine::captureFrame()
 {
+    if (m_randomAccess)
+    {
+        return presentReplayFrame(m_replay.advance());
+    }
+
     uint64_t timestamp = 0U;
-    BaseLidarSensor::PointCloud& buffer = m_pointBuffers[m_readIndex];
-    buffer.clear();
+    // Consumers may still hold earlier frames; each capture fills a fresh buffer from the pool.
+    std::shared_ptr<BaseLidarSensor::PointCloud> buffer = m_framePool.acquire();
 
-    if (!m_sensor->readNextScan(buffer, timestamp))
+    const bool captured = m_sensor->readNextScan(*buffer, timestamp);
+    if (!captured)
     {
         std::cerr << "Sensor returned no data" << '\n';
-        return;
+        buffer->clear();
+        m_currentFrame.imu.clear();
+        m_currentFrame.tilt.reset();
+    }
+    else
+    {
+        m_latestTimestamp = timestamp;
+        m_sensor->imuSamples(m_currentFrame.imu);
+        m_currentFrame.tilt = sensorTilt();
+    }
+
+    m_currentFrame.points = std::move(buffer);
+    m_currentFrame.timestamp_us = m_latestTimestamp;
+    m_currentFrame.sequence = m_frameSequence++;
+    return captured;
+}
+
+std::optional<SensorTilt> LidarEngine::sensorTilt() const
+{
+    SensorTilt tilt;
+    if (!m_sensor->sensorTilt(tilt))
+    {
+        return std::nullopt;
+    }
+    return tilt;
+}
+
+void LidarEngine::publishFrame()
+{
+    for (const auto& consumer : m_consumers)
+    {
+        consumer->publish(m_currentFrame);
+    }
+}
+
+bool LidarEngine::registerConsumer(std::shared_ptr<IFrameConsumer> consumer, std::size_t queueDepth)
+{
+    if (!consumer)
+    {
+        std::cerr << "Ignoring null frame consumer" << '\n';
+        return false;
+    }
+
+    m_consumers.push_back(std::make_unique<FrameConsumerExecutor>(std::move(consumer), queueDepth));
+    return true;
+}
+
+void LidarEngine::drainConsumers()
+{
+    for (const auto& consumer : m_consumers)
+    {
+        consumer->drain();
+    }
+}
+
+std::vector<FrameConsumerStats> LidarEngine::consumerStats() const
+{
+    std::vector<FrameConsumerStats> stats;
+    stats.reserve(m_consumers.size());
+    for (const auto& consumer : m_consumers)
+    {
+        stats.push_back(consumer->stats());
+    }
+    return stats;
+}
+
+void LidarEngine::dropFrames(std::size_t count, FramePacer::Clock::time_point now, FramePacer::Clock::duration period)
+{
+    const auto maxAge = std::chrono::duration_cast<FramePacer::Clock::duration>(
+        period * m_pacer.settings().maxDataAgeInFrames);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        if (m_randomAccess)
+        {
+            // Dropped replay frames are never read, only stepped over.
+            m_replay.advance();
+            m_pacer.recordDropped(period, now - m_pacer.nextArrival() > maxAge);
+            if (m_replay.paused())
+            {
+                return;
+            }
+            continue;
+        }
+
+        uint64_t timestamp = 0U;
+        if (!m_sensor->skipScan(timestamp))
+        {
+            return;
+        }
+        m_pacer.recordDropped(period, now - m_pacer.nextArrival() > maxAge);
+        m_latestTimestamp = timestamp;
+    }
+}
+
+void LidarEngine::setReplaySettings(const ReplaySettings& settings)
+{
+    m_replaySettings = settings;
+    m_frameCache.setCapacityBytes(settings.cacheBytes);
+}
+
+bool LidarEngine::presentReplayFrame(std::size_t index)
+{
+    const std::optional<Frame> frame = loadReplayFrame(index);
+    if (!frame)
+    {
+        // Past the end of the capture: remember its length and hold the last frame on screen.
+        m_replay.setFrameCount(std::min(index, m_sensor->nextScanIndex()));
+        return false;
+    }
+
+    m_currentFrame = *frame;
+    m_currentFrame.sequence = m_frameSequence++;
+    m_latestTimestamp = frame->timestamp_us;
+    return true;
+}
+
+std::optional<Frame> LidarEngine::loadReplayFrame(std::size_t index)
+{
+    if (auto cached = m_frameCache.find(index))
+    {
+        return cached;
+    }
+
+    const auto decodeStart = FramePacer::Clock::now();
+    if (!m_sensor->seekScan(index))
+    {
+        return std::nullopt;
+    }
+
+    std::shared_ptr<BaseLidarSensor::PointCloud> buffer = m_framePool.acquire();
+    uint64_t timestamp = 0U;
+    if (!m_sensor->readNextScan(*buffer, timestamp))
+    {
+        return std::nullopt;
+    }
+
+    Frame frame;
+    frame.points = std::move(buffer);
+    frame.timestamp_us = timestamp;
+    m_sensor->imuSamples(frame.imu);
+    frame.tilt = sensorTilt();
+    m_frameCache.insert(index, frame);
+    m_lastDecodeTime = FramePacer::Clock::now() - decodeStart;
+    return frame;
+}
+
+void LidarEngine::prefetchReplayFrames(FramePacer::Clock::time_point deadline)
+{
+    for (std::size_t step = 1U; step <= m_replaySettings.prefetchFrames; ++step)
+    {
+        // Only start a decode that is expected to finish before the next frame is due.
+        if (FramePacer::Clock::now() + m_lastDecodeTime >= deadline)
+        {
+            return;
+        }
+
+        const std::optional<std::size_t> index = m_replay.peek(step);
+        if (!index)
+        {
+            return;
+        }
+        if (!m_frameCache.contains(*index) && !loadReplayFrame(*index))
+        {
+            return;
+        }
+    }
+}
+
+void LidarEngine::runPausedReplayTick()
+{
+    const auto tickStart = FramePacer::Clock::now();
+    if (const std::optional<std::size_t> index = m_replay.takePendingFrame())
+    {
+        if (presentReplayFrame(*index))
+        {
+            publishFrame();
+            if (m_currentFrame.tilt)
+            {
+                m_visualizer->updateSensorTilt(*m_currentFrame.tilt);
+            }
+            m_visualizer->updatePoints(*m_currentFrame.points, m_currentFrame.timestamp_us);
+        }
     }
+    m_visualizer->render();
 
-    m_latestTimestamp = timestamp;
+    const auto deadline = tickStart + kScrubFrameDuration;
+    prefetchReplayFrames(deadline);
+    std::this_thread::sleep_until(deadline);
 }
 
 } // namespace lidar
@@ -0,0 +1,142 @@
+#include "engine/ReplayController.hpp"
+
+#include <algorithm>
+
+namespace lidar
+{
+
+void ReplayController::play()
+{
+    m_paused = false;
+}
+
+void ReplayController::pause()
+{
+    m_paused = true;
+}
+
+void ReplayController::stepForward()
+{
+    m_paused = true;
+    const bool wasReverse = m_reverse;
+    m_reverse = false;
+    if (const auto next = following(m_position))
+    {
+        jumpTo(*next);
+    }
+    m_reverse = wasReverse;
+}
+
+void ReplayController::stepBackward()
+{
+    m_paused = true;
+    const bool wasReverse = m_reverse;
+    m_reverse = true;
+    if (const auto previous = following(m_position))
+    {
+        jumpTo(*previous);
+    }
+    m_reverse = wasReverse;
+}
+
+void ReplayController::jumpTo(std::size_t index)
+{
+    if (m_frameCount && *m_frameCount > 0U)
+    {
+        index = std::min(index, *m_frameCount - 1U);
+    }
+    m_position = index;
+    m_highestSeen = std::max(m_highestSeen, index);
+    m_pendingFrame = true;
+}
+
+void ReplayController::setLoop(std::size_t first, std::size_t last)
+{
+    m_loop = std::make_pair(std::min(first, last), std::max(first, last));
+}
+
+std::size_t ReplayController::knownFrameCount() const noexcept
+{
+    return m_frameCount ? *m_frameCount : m_highestSeen + 1U;
+}
+
+void ReplayController::setFrameCount(std::size_t count)
+{
+    m_frameCount = count;
+    if (count > 0U && m_position >= count)
+    {
+        m_position = count - 1U;
+        m_pendingFrame = true;
+    }
+    if (m_loop && count > 0U)
+    {
+        m_loop->first = std::min(m_loop->first, count - 1U);
+        m_loop->second = std::min(m_loop->second, count - 1U);
+    }
+    m_paused = true;
+}
+
+std::size_t ReplayController::advance()
+{
+    if (m_pendingFrame)
+    {
+        m_pendingFrame = false;
+        return m_position;
+    }
+
+    if (const auto next = following(m_position))
+    {
+        m_position = *next;
+        m_highestSeen = std::max(m_highestSeen, m_position);
+    }
+    else
+    {
+        m_paused = true;
+    }
+    return m_position;
+}
+
+std::optional<std::size_t> ReplayController::peek(std::size_t steps) const
+{
+    std::optional<std::size_t> index = m_position;
+    for (std::size_t i = 0; i < steps && index; ++i)
+    {
+        index = following(*index);
+    }
+    return index;
+}
+
+std::optional<std::size_t> ReplayController::takePendingFrame()
+{
+    if (!m_pendingFrame)
+    {
+        return std::nullopt;
+    }
+    m_pendingFrame = false;
+    return m_position;
+}
+
+std::optional<std::size_t> ReplayController::following(std::size_t index) const
+{
+    if (m_loop)
+    {
+        const auto [first, last] = *m_loop;
+        if (!m_reverse)
+        {
+            return (index >= last || index < first) ? first : index + 1U;
+        }
+        return (index <= first || index > last) ? last : index - 1U;
+    }
+
+    if (m_reverse)
+    {
+        return index == 0U ? std::nullopt : std::optional<std::size_t>(index - 1U);
+    }
+    if (m_frameCount && index + 1U >= *m_frameCount)
+    {
+        return std::nullopt;
+    }
+    return index + 1U;
+}
+
+} // namespace lidar
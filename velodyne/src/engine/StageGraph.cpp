@@ -0,0 +1,186 @@
+#include "engine/StageGraph.hpp"
+#include "engine/ThreadPool.hpp"
+
+#include <iostream>
+#include <utility>
+
+namespace lidar
+{
+
+const BaseLidarSensor::PointCloud& FrameContext::input(const std::string& name) const
+{
+    if (m_source && name == StageGraph::kSourceBuffer)
+    {
+        return *m_source;
+    }
+    return m_buffers.at(name);
+}
+
+BaseLidarSensor::PointCloud& FrameContext::output(const std::string& name)
+{
+    return m_buffers.at(name);
+}
+
+FunctionStage::FunctionStage(std::string name,
+                             StageKind kind,
+                             std::vector<std::string> inputs,
+                             std::vector<std::string> outputs,
+                             Callback callback)
+    : m_name(std::move(name))
+    , m_kind(kind)
+    , m_inputs(std::move(inputs))
+    , m_outputs(std::move(outputs))
+    , m_callback(std::move(callback))
+{
+}
+
+void FunctionStage::process(FrameContext& frame)
+{
+    if (m_callback)
+    {
+        m_callback(frame);
+    }
+}
+
+void StageGraph::addStage(std::unique_ptr<ProcessingStage> stage)
+{
+    if (!stage)
+    {
+        return;
+    }
+    m_stages.push_back(std::move(stage));
+    m_compiled = false;
+}
+
+void StageGraph::addStage(std::string name,
+                          StageKind kind,
+                          std::vector<std::string> inputs,
+                          std::vector<std::string> outputs,
+                          FunctionStage::Callback callback)
+{
+    addStage(std::make_unique<FunctionStage>(
+        std::move(name), kind, std::move(inputs), std::move(outputs), std::move(callback)));
+}
+
+bool StageGraph::compile()
+{
+    m_levels.clear();
+    m_frame.m_buffers.clear();
+    m_compiled = false;
+
+    std::unordered_map<std::string, std::size_t> producers;
+    for (std::size_t index = 0; index < m_stages.size(); ++index)
+    {
+        for (const auto& output : m_stages[index]->outputs())
+        {
+            if (output == kSourceBuffer || !producers.emplace(output, index).second)
+            {
+                std::cerr << "StageGraph: buffer '" << output << "' produced more than once (stage "
+                          << m_stages[index]->name() << ")" << '\n';
+                return false;
+            }
+            m_frame.m_buffers[output];
+        }
+    }
+
+    std::vector<std::size_t> pendingInputs(m_stages.size(), 0U);
+    std::vector<std::vector<std::size_t>> consumers(m_stages.size());
+    for (std::size_t index = 0; index < m_stages.size(); ++index)
+    {
+        for (const auto& input : m_stages[index]->inputs())
+        {
+            if (input == kSourceBuffer)
+            {
+                continue;
+            }
+
+            const auto producer = producers.find(input);
+            if (producer == producers.end())
+            {
+                std::cerr << "StageGraph: stage " << m_stages[index]->name() << " reads unknown buffer '" << input
+                          << "'" << '\n';
+                return false;
+            }
+            consumers[producer->second].push_back(index);
+            ++pendingInputs[index];
+        }
+    }
+
+    std::vector<std::size_t> current;
+    for (std::size_t index = 0; index < m_stages.size(); ++index)
+    {
+        if (pendingInputs[index] == 0U)
+        {
+            current.push_back(index);
+        }
+    }
+
+    std::size_t scheduled = 0U;
+    while (!current.empty())
+    {
+        std::vector<std::size_t> next;
+        for (const std::size_t index : current)
+        {
+            for (const std::size_t consumer : consumers[index])
+            {
+                if (--pendingInputs[consumer] == 0U)
+                {
+                    next.push_back(consumer);
+                }
+            }
+        }
+        scheduled += current.size();
+        m_levels.push_back(std::move(current));
+        current = std::move(next);
+    }
+
+    if (scheduled != m_stages.size())
+    {
+        std::cerr << "StageGraph: dependency cycle detected" << '\n';
+        m_levels.clear();
+        return false;
+    }
+
+    m_compiled = true;
+    return true;
+}
+
+void StageGraph::run(const BaseLidarSensor::PointCloud& source, uint64_t timestamp)
+{
+    if (!m_compiled && !compile())
+    {
+        return;
+    }
+
+    m_frame.m_source = &source;
+    m_frame.m_timestamp = timestamp;
+    for (auto& [name, buffer] : m_frame.m_buffers)
+    {
+        buffer.clear();
+    }
+
+    std::vector<ThreadPool::Task> tasks;
+    for (const auto& level : m_levels)
+    {
+        if (!m_threadPool || level.size() == 1U)
+        {
+            for (const std::size_t index : level)
+            {
+                m_stages[index]->process(m_frame);
+            }
+            continue;
+        }
+
+        tasks.clear();
+        for (const std::size_t index : level)
+        {
+            ProcessingStage* stage = m_stages[index].get();
+            tasks.emplace_back([this, stage]() { stage->process(m_frame); });
+        }
+        m_threadPool->parallelInvoke(tasks);
+    }
+
+    m_frame.m_source = nullptr;
+}
+
+} // namespace lidar
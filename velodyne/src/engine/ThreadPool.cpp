@@ -0,0 +1,302 @@
+#include "engine/ThreadPool.hpp"
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#elif defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include <iostream>
+
+namespace lidar
+{
+
+namespace
+{
+thread_local const ThreadPool* tlsPool = nullptr;
+thread_local std::size_t tlsWorkerIndex = 0U;
+} // namespace
+
+struct ThreadPool::Batch
+{
+    std::size_t remaining = 0U;
+    std::mutex mutex;
+    std::condition_variable done;
+};
+
+ThreadPool::ThreadPool(ThreadPoolConfig config)
+    : m_config(std::move(config))
+{
+    const std::size_t workerCount = m_config.workerCount.value_or(defaultWorkerCount());
+    m_localQueues.reserve(workerCount);
+    for (std::size_t index = 0; index < workerCount; ++index)
+    {
+        m_localQueues.push_back(std::make_unique<WorkQueue>());
+    }
+
+    m_workers.reserve(workerCount);
+    for (std::size_t index = 0; index < workerCount; ++index)
+    {
+        m_workers.emplace_back([this, index]() { workerLoop(index); });
+    }
+}
+
+ThreadPool::ThreadPool(std::size_t workerCount)
+    : ThreadPool([workerCount]() {
+        ThreadPoolConfig config;
+        config.workerCount = workerCount;
+        return config;
+    }())
+{
+}
+
+ThreadPool::~ThreadPool()
+{
+    m_stopping.store(true, std::memory_order_release);
+    {
+        std::lock_guard<std::mutex> lock(m_sleepMutex);
+    }
+    m_wakeUp.notify_all();
+    for (auto& worker : m_workers)
+    {
+        if (worker.joinable())
+        {
+            worker.join();
+        }
+    }
+}
+
+void ThreadPool::parallelInvoke(const std::vector<Task>& tasks, TaskPriority priority)
+{
+    if (tasks.empty())
+    {
+        return;
+    }
+
+    if (m_workers.empty() || tasks.size() == 1U)
+    {
+        for (const auto& task : tasks)
+        {
+            task();
+        }
+        return;
+    }
+
+    Batch batch;
+    batch.remaining = tasks.size();
+
+    const std::size_t workerIndex = currentWorkerIndex();
+    WorkQueue& queue = workerIndex == kNoWorker ? m_globalQueue : *m_localQueues[workerIndex];
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        auto& deque = queue.tasks[static_cast<std::size_t>(priority)];
+        for (const auto& task : tasks)
+        {
+            deque.push_back(QueuedTask{&task, &batch});
+        }
+    }
+    m_pendingTasks.fetch_add(tasks.size(), std::memory_order_release);
+    {
+        std::lock_guard<std::mutex> lock(m_sleepMutex);
+    }
+    m_wakeUp.notify_all();
+
+    for (;;)
+    {
+        {
+            // The batch lives on this stack frame, so only leave once the last worker released its mutex.
+            std::lock_guard<std::mutex> lock(batch.mutex);
+            if (batch.remaining == 0U)
+            {
+                return;
+            }
+        }
+
+        if (runPendingTask(workerIndex))
+        {
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(batch.mutex);
+        batch.done.wait(lock, [&batch]() { return batch.remaining == 0U; });
+        return;
+    }
+}
+
+std::size_t ThreadPool::defaultWorkerCount() noexcept
+{
+    const unsigned int hardwareThreads = std::thread::hardware_concurrency();
+    return hardwareThreads > 1U ? static_cast<std::size_t>(hardwareThreads - 1U) : 0U;
+}
+
+void ThreadPool::workerLoop(std::size_t workerIndex)
+{
+    tlsPool = this;
+    tlsWorkerIndex = workerIndex;
+    applyAffinity(workerIndex);
+
+    for (;;)
+    {
+        if (runPendingTask(workerIndex))
+        {
+            continue;
+        }
+        if (m_stopping.load(std::memory_order_acquire))
+        {
+            return;
+        }
+        waitForWork();
+    }
+}
+
+void ThreadPool::waitForWork()
+{
+    const auto hasWork = [this]() {
+        return m_pendingTasks.load(std::memory_order_acquire) > 0U || m_stopping.load(std::memory_order_acquire);
+    };
+
+    if (m_config.idlePolicy != IdlePolicy::Sleep)
+    {
+        const auto deadline = std::chrono::steady_clock::now() + m_config.spinDuration;
+        while (!hasWork())
+        {
+            if (m_config.idlePolicy == IdlePolicy::SpinThenSleep && std::chrono::steady_clock::now() >= deadline)
+            {
+                break;
+            }
+            std::this_thread::yield();
+        }
+        if (hasWork())
+        {
+            return;
+        }
+    }
+
+    std::unique_lock<std::mutex> lock(m_sleepMutex);
+    m_wakeUp.wait(lock, hasWork);
+}
+
+void ThreadPool::applyAffinity(std::size_t workerIndex)
+{
+    if (m_config.cpuAffinity.empty())
+    {
+        return;
+    }
+
+    const int cpu = m_config.cpuAffinity[workerIndex % m_config.cpuAffinity.size()];
+    if (cpu < 0)
+    {
+        return;
+    }
+
+#if defined(_WIN32)
+    if (cpu < static_cast<int>(sizeof(DWORD_PTR) * 8U))
+    {
+        SetThreadAffinityMask(GetCurrentThread(), static_cast<DWORD_PTR>(1) << cpu);
+    }
+#elif defined(__linux__)
+    cpu_set_t cpuSet;
+    CPU_ZERO(&cpuSet);
+    CPU_SET(cpu, &cpuSet);
+    if (pthread_setaffinity_np(pthread_self(), sizeof(cpuSet), &cpuSet) != 0)
+    {
+        std::cerr << "ThreadPool: failed to pin worker " << workerIndex << " to CPU " << cpu << '\n';
+    }
+#endif
+}
+
+std::size_t ThreadPool::currentWorkerIndex() const noexcept
+{
+    return tlsPool == this ? tlsWorkerIndex : kNoWorker;
+}
+
+bool ThreadPool::runPendingTask(std::size_t workerIndex)
+{
+    QueuedTask queued;
+    if (!popTask(workerIndex, queued))
+    {
+        return false;
+    }
+    execute(queued);
+    return true;
+}
+
+bool ThreadPool::popTask(std::size_t workerIndex, QueuedTask& out)
+{
+    if (m_pendingTasks.load(std::memory_order_acquire) == 0U)
+    {
+        return false;
+    }
+
+    const std::size_t queueCount = m_localQueues.size();
+    for (std::size_t priority = 0; priority < kPriorityCount; ++priority)
+    {
+        if (workerIndex != kNoWorker)
+        {
+            WorkQueue& own = *m_localQueues[workerIndex];
+            std::lock_guard<std::mutex> lock(own.mutex);
+            auto& deque = own.tasks[priority];
+            if (!deque.empty())
+            {
+                out = deque.back();
+                deque.pop_back();
+                m_pendingTasks.fetch_sub(1U, std::memory_order_acq_rel);
+                return true;
+            }
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_globalQueue.mutex);
+            auto& deque = m_globalQueue.tasks[priority];
+            if (!deque.empty())
+            {
+                out = deque.front();
+                deque.pop_front();
+                m_pendingTasks.fetch_sub(1U, std::memory_order_acq_rel);
+                return true;
+            }
+        }
+
+        const std::size_t firstVictim = workerIndex == kNoWorker ? 0U : workerIndex + 1U;
+        for (std::size_t offset = 0; offset < queueCount; ++offset)
+        {
+            const std::size_t victim = (firstVictim + offset) % queueCount;
+            if (victim == workerIndex)
+            {
+                continue;
+            }
+
+            WorkQueue& other = *m_localQueues[victim];
+            std::lock_guard<std::mutex> lock(other.mutex);
+            auto& deque = other.tasks[priority];
+            if (!deque.empty())
+            {
+                out = deque.front();
+                deque.pop_front();
+                m_pendingTasks.fetch_sub(1U, std::memory_order_acq_rel);
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+void ThreadPool::execute(const QueuedTask& queued)
+{
+    (*queued.task)();
+    Batch& batch = *queued.batch;
+    std::lock_guard<std::mutex> lock(batch.mutex);
+    if (--batch.remaining == 0U)
+    {
+        batch.done.notify_all();
+    }
+}
+
+} // namespace lidar
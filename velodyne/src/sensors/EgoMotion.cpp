@@ -0,0 +1,162 @@
+#include "sensors/EgoMotion.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace lidar
+{
+
+void ConstantVelocityMotionSource::setMotion(const EgoMotion& motion)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_motion = motion;
+    m_valid = true;
+}
+
+void ConstantVelocityMotionSource::clear()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_valid = false;
+}
+
+bool ConstantVelocityMotionSource::motionAt(uint64_t /*timestamp_us*/, EgoMotion& motion) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_valid)
+    {
+        motion = m_motion;
+    }
+    return m_valid;
+}
+
+void PoseStreamMotionSource::pushPose(uint64_t timestamp_us, const Eigen::Isometry3f& sensorToWorld)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_poses.empty() && timestamp_us <= m_poses.back().timestamp_us)
+    {
+        return;
+    }
+    m_poses.push_back(StampedPose{timestamp_us, sensorToWorld});
+    if (m_poses.size() > kMaxPoses)
+    {
+        m_poses.pop_front();
+    }
+}
+
+void PoseStreamMotionSource::clear()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_poses.clear();
+}
+
+bool PoseStreamMotionSource::motionAt(uint64_t timestamp_us, EgoMotion& motion) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_poses.size() < 2U)
+    {
+        return false;
+    }
+
+    const auto upper = std::upper_bound(m_poses.begin(),
+                                        m_poses.end(),
+                                        timestamp_us,
+                                        [](uint64_t time, const StampedPose& pose) { return time < pose.timestamp_us; });
+    const auto later = std::clamp(upper, m_poses.begin() + 1, m_poses.end() - 1);
+    const auto& from = *(later - 1);
+    const auto& to = *later;
+
+    const float seconds = static_cast<float>(to.timestamp_us - from.timestamp_us) * 1e-6F;
+    const Eigen::Isometry3f relative = from.sensorToWorld.inverse() * to.sensorToWorld;
+    const Eigen::AngleAxisf rotation(relative.rotation());
+    motion.linearVelocity = relative.translation() / seconds;
+    motion.angularVelocity = rotation.axis() * (rotation.angle() / seconds);
+    return true;
+}
+
+namespace
+{
+// Readings further than this from 1 g are dominated by braking or cornering, not by tilt.
+constexpr float kGravityTolerance = 0.2F * kStandardGravity;
+constexpr uint64_t kMaxSampleGapUs = 1000000U;
+} // namespace
+
+void ImuMotionSource::pushSample(const ImuSample& sample)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_samples.empty())
+    {
+        const uint64_t last = m_samples.back().timestamp_us;
+        if (sample.timestamp_us <= last || sample.timestamp_us - last > kMaxSampleGapUs)
+        {
+            m_samples.clear();
+            m_hasGravity = false;
+        }
+    }
+
+    const Eigen::Vector3f acceleration(sample.acceleration[0], sample.acceleration[1], sample.acceleration[2]);
+    if (std::fabs(acceleration.norm() - kStandardGravity) <= kGravityTolerance)
+    {
+        if (!m_hasGravity)
+        {
+            m_gravity = acceleration;
+            m_hasGravity = true;
+        }
+        else
+        {
+            const float seconds = static_cast<float>(sample.timestamp_us - m_samples.back().timestamp_us) * 1e-6F;
+            const float blend = 1.0F - std::exp(-seconds / kGravityTimeConstant);
+            m_gravity += blend * (acceleration - m_gravity);
+        }
+    }
+
+    m_samples.push_back(sample);
+    if (m_samples.size() > kMaxSamples)
+    {
+        m_samples.pop_front();
+    }
+}
+
+void ImuMotionSource::clear()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_samples.clear();
+    m_hasGravity = false;
+}
+
+bool ImuMotionSource::motionAt(uint64_t timestamp_us, EgoMotion& motion) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Eigen::Vector3f sum = Eigen::Vector3f::Zero();
+    std::size_t count = 0U;
+    for (const auto& sample : m_samples)
+    {
+        const uint64_t distance =
+            sample.timestamp_us > timestamp_us ? sample.timestamp_us - timestamp_us : timestamp_us - sample.timestamp_us;
+        if (distance <= kRateWindowUs)
+        {
+            sum += Eigen::Vector3f(sample.angularVelocity[0], sample.angularVelocity[1], sample.angularVelocity[2]);
+            ++count;
+        }
+    }
+    if (count == 0U)
+    {
+        return false;
+    }
+    motion.linearVelocity.setZero();
+    motion.angularVelocity = sum / static_cast<float>(count);
+    return true;
+}
+
+bool ImuMotionSource::tilt(float& roll, float& pitch) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_hasGravity)
+    {
+        return false;
+    }
+    roll = std::atan2(m_gravity.y(), m_gravity.z());
+    pitch = std::atan2(-m_gravity.x(), std::hypot(m_gravity.y(), m_gravity.z()));
+    return true;
+}
+
+} // namespace lidar
@@ -21,12 +21,16 @@ std::unique_ptr<BaseLidarSensor> LidarFactory::createSensor(const std::string& t
 
     if (lowerType == "velodyne" || lowerType == "velodyne_hdl")
     {
-        return std::make_unique<VelodyneLidar>("Velodyne HDL-32E", sourcePath);
+        auto sensor = std::make_unique<VelodyneLidar>("Velodyne HDL-32E", sourcePath);
+        sensor->setNoiseFilter(true);
+        sensor->setImuDeskew(true);
+        return sensor;
     }
 
     if (lowerType == "velodyne_vlp")
     {
         auto sensor = std::make_unique<VelodyneLidar>("Velodyne VLP-16", sourcePath);
+        sensor->setNoiseFilter(true);
         sensor->configure(30.0F, 120.0F);
         return sensor;
     }
@@ -0,0 +1,82 @@
+#include "sensors/RangeImageFilter.hpp"
+
+#include <cmath>
+
+namespace lidar
+{
+
+RangeImageFilter::RangeImageFilter(const RangeImageFilterSettings& settings)
+    : m_settings(settings)
+{
+}
+
+std::size_t RangeImageFilter::filter(std::span<const float> ranges,
+                                     std::size_t rows,
+                                     std::size_t columns,
+                                     std::vector<uint8_t>& keep) const
+{
+    keep.assign(ranges.size(), 0U);
+    if (rows == 0U || columns == 0U || ranges.size() < rows * columns)
+    {
+        return 0U;
+    }
+
+    const bool wrap = m_settings.wrapColumns && columns > 2U;
+    std::size_t rejected = 0U;
+    for (std::size_t column = 0; column < columns; ++column)
+    {
+        const bool hasPrevious = column > 0U || wrap;
+        const bool hasNext = column + 1U < columns || wrap;
+        const std::size_t previous = (column + columns - 1U) % columns;
+        const std::size_t next = (column + 1U) % columns;
+        const float* current = ranges.data() + column * rows;
+        const float* left = hasPrevious ? ranges.data() + previous * rows : nullptr;
+        const float* right = hasNext ? ranges.data() + next * rows : nullptr;
+
+        for (std::size_t row = 0; row < rows; ++row)
+        {
+            const float range = current[row];
+            if (range <= 0.0F)
+            {
+                continue;
+            }
+
+            const float tolerance = m_settings.absoluteTolerance + m_settings.relativeTolerance * range;
+            uint32_t support = 0U;
+            const auto check = [&](const float* neighbourColumn, std::size_t neighbourRow) {
+                if (neighbourColumn && support < m_settings.minSupport)
+                {
+                    const float neighbour = neighbourColumn[neighbourRow];
+                    support += static_cast<uint32_t>(neighbour > 0.0F && std::fabs(neighbour - range) <= tolerance);
+                }
+            };
+            // Same ring first: neighbouring firings of one laser are the most likely support.
+            check(left, row);
+            check(right, row);
+            if (row > 0U)
+            {
+                check(current, row - 1U);
+                check(left, row - 1U);
+                check(right, row - 1U);
+            }
+            if (row + 1U < rows)
+            {
+                check(current, row + 1U);
+                check(left, row + 1U);
+                check(right, row + 1U);
+            }
+
+            if (support >= m_settings.minSupport)
+            {
+                keep[column * rows + row] = 1U;
+            }
+            else
+            {
+                ++rejected;
+            }
+        }
+    }
+    return rejected;
+}
+
+} // namespace lidar
@@ -1,8 +1,11 @@
 #include "sensors/VelodyneLidar.hpp"
+#include "engine/ThreadPool.hpp"
 
 #include <cmath>
+#include <cstdlib>
 #include <iostream>
 #include <algorithm>
+#include <numeric>
 
 namespace lidar
 {
@@ -23,6 +26,15 @@ namespace
 {
 constexpr float kRadiansPerTick = 1.745329251994329e-04F;
 constexpr float kTwoPi = 6.28318530717958647692F;
+constexpr std::size_t kBlocksPerDecodeChunk = 16U;
+// A revolution takes 100 ms; larger offsets come from clock wraps in the capture.
+constexpr int64_t kMaxDeskewOffsetUs = 200000;
+constexpr float kRadiansPerDegree = kTwoPi / 360.0F;
+
+// HDL-32E IMU boards in the point frame (x forward, y left, z up): gyro 1 senses yaw, gyros 2 and
+// 3 roll and pitch. Accelerometer 1 lies flat and gives x and y; boards 2 and 3 stand upright and
+// both give z on their X axis, so their mean is used.
+constexpr std::array<std::size_t, 3> kGyroBoardPerAxis = {1U, 2U, 0U};
 }
 
 VelodyneLidar::VelodyneLidar(std::string identifier, std::string pcapPath)
@@ -53,6 +65,13 @@ void VelodyneLidar::configure(float vertical_fov_deg, float max_range_m)
     }
 }
 
+void VelodyneLidar::setNoiseFilter(bool enabled, const RangeImageFilterSettings& settings)
+{
+    m_noiseFilterEnabled = enabled;
+    m_noiseFilter.configure(settings);
+    m_rejectedReturns = 0U;
+}
+
 bool VelodyneLidar::readNextScan(PointCloud& destination, uint64_t& timestamp_us)
 {
     if (!m_initialized || !m_pendingScan)
@@ -65,19 +84,63 @@ bool VelodyneLidar::readNextScan(PointCloud& destination, uint64_t& timestamp_us
 
     populateGeometry(destination);
     timestamp_us = m_scan.timestamp_us;
+    return advanceScan();
+}
 
-    const int rc = GetNextLidarScan(&m_scan);
-    if (rc != GLSE_SUCCESS)
+bool VelodyneLidar::skipScan(uint64_t& timestamp_us)
+{
+    if (!m_initialized || !m_pendingScan)
     {
-        m_pendingScan = false;
-        finalizeSensor();
-        return true;
+        return false;
     }
 
-    m_pendingScan = true;
+    collectImuSamples();
+    timestamp_us = m_scan.timestamp_us;
+    return advanceScan();
+}
+
+bool VelodyneLidar::advanceScan()
+{
+    const long long offset = GetLidarScanPosition();
+    ++m_pendingIndex;
+    if (m_pendingIndex == m_scanOffsets.size())
+    {
+        m_scanOffsets.push_back(offset);
+    }
+
+    // The file stays open at the end of the capture so earlier scans can still be revisited.
+    m_pendingScan = GetNextLidarScan(&m_scan) == GLSE_SUCCESS;
     return true;
 }
 
+bool VelodyneLidar::seekScan(std::size_t index)
+{
+    if (!m_initialized || m_scanOffsets.empty())
+    {
+        return false;
+    }
+    if (index == m_pendingIndex)
+    {
+        return m_pendingScan;
+    }
+
+    // Unindexed scans are reached by skipping forward from the last known offset.
+    const std::size_t known = std::min(index, m_scanOffsets.size() - 1U);
+    if (SeekLidarScan(m_scanOffsets[known]) != GLSE_SUCCESS)
+    {
+        return false;
+    }
+    m_pendingIndex = known;
+    m_pendingScan = GetNextLidarScan(&m_scan) == GLSE_SUCCESS;
+
+    uint64_t timestamp = 0U;
+    while (m_pendingScan && m_pendingIndex < index)
+    {
+        skipScan(timestamp);
+    }
+    return m_pendingScan && m_pendingIndex == index;
+}
+
 void VelodyneLidar::initializeSensor()
 {
     if (m_initialized || m_pcapPath.empty())
@@ -94,6 +157,8 @@ void VelodyneLidar::initializeSensor()
 
     m_initialized = true;
     m_pendingScan = true;
+    m_pendingIndex = 0U;
+    m_scanOffsets.assign(1U, GetFirstLidarScanPosition());
 
     switch (m_scan.lidarHardware)
     {
@@ -129,10 +194,126 @@ void VelodyneLidar::finalizeSensor()
     }
 }
 
+void VelodyneLidar::collectImuSamples()
+{
+    m_imuSamples.resize(m_scan.imuSampleCount);
+    for (std::size_t i = 0; i < m_imuSamples.size(); ++i)
+    {
+        const VDYNE::ImuSample_t& raw = m_scan.imuSamples[i];
+        ImuSample& sample = m_imuSamples[i];
+        sample.timestamp_us = raw.timestamp_us;
+        for (std::size_t axis = 0; axis < 3U; ++axis)
+        {
+            sample.angularVelocity[axis] = raw.gyro_dps[kGyroBoardPerAxis[axis]] * kRadiansPerDegree;
+        }
+        sample.acceleration[0] = raw.accel_g[0][0] * kStandardGravity;
+        sample.acceleration[1] = raw.accel_g[0][1] * kStandardGravity;
+        sample.acceleration[2] = 0.5F * (raw.accel_g[1][0] + raw.accel_g[2][0]) * kStandardGravity;
+        m_imuMotion.pushSample(sample);
+    }
+}
+
 void VelodyneLidar::populateGeometry(PointCloud& destination)
 {
-    for (size_t block = 0; block < m_config.blocksPerScan; ++block)
+    collectImuSamples();
+    if (m_noiseFilterEnabled)
+    {
+        buildNoiseMask();
+    }
+    m_deskew = buildBlockTransforms();
+
+    const std::size_t blockCount = m_config.blocksPerScan;
+    if (!m_threadPool || blockCount <= kBlocksPerDecodeChunk)
+    {
+        decodeBlocks(0U, blockCount, destination);
+        return;
+    }
+
+    // Decode fixed block ranges into per-chunk buffers and concatenate them in order, so the
+    // resulting point order matches the sequential decode.
+    const std::size_t chunkCount = (blockCount + kBlocksPerDecodeChunk - 1U) / kBlocksPerDecodeChunk;
+    m_decodeChunks.resize(chunkCount);
+    m_threadPool->parallelFor(0U, chunkCount, 1U, [&](std::size_t firstChunk, std::size_t lastChunk) {
+        for (std::size_t chunk = firstChunk; chunk < lastChunk; ++chunk)
+        {
+            auto& buffer = m_decodeChunks[chunk];
+            buffer.clear();
+            const std::size_t firstBlock = chunk * kBlocksPerDecodeChunk;
+            decodeBlocks(firstBlock, std::min(blockCount, firstBlock + kBlocksPerDecodeChunk), buffer);
+        }
+    });
+
+    for (const auto& buffer : m_decodeChunks)
+    {
+        destination.insert(destination.end(), buffer.begin(), buffer.end());
+    }
+}
+
+void VelodyneLidar::buildNoiseMask()
+{
+    const std::size_t rows = m_config.numBeams;
+    const std::size_t columns = m_config.blocksPerScan * m_config.firingSequencesPerBlock;
+
+    // Lasers fire interleaved in elevation; image rows follow elevation so row neighbours are
+    // physically adjacent rings.
+    std::array<uint8_t, VDYNE::maxkHDLNumBeams> beamOrder{};
+    std::iota(beamOrder.begin(), beamOrder.begin() + static_cast<std::ptrdiff_t>(rows), uint8_t{0});
+    std::stable_sort(beamOrder.begin(),
+                     beamOrder.begin() + static_cast<std::ptrdiff_t>(rows),
+                     [this](uint8_t a, uint8_t b) { return m_verticalAnglesRad[a] < m_verticalAnglesRad[b]; });
+    for (std::size_t row = 0; row < rows; ++row)
+    {
+        m_beamRow[beamOrder[row]] = static_cast<uint8_t>(row);
+    }
+
+    m_rangeImage.resize(rows * columns);
+    for (std::size_t column = 0; column < columns; ++column)
     {
+        const auto& firing = m_scan.firings[column];
+        float* ranges = m_rangeImage.data() + column * rows;
+        for (std::size_t beam = 0; beam < rows; ++beam)
+        {
+            // Returns the decoder drops count as missing, so they cannot support a neighbour.
+            const float rangeMeters = static_cast<float>(firing.v_laser[beam].range) * m_metersPerTick;
+            ranges[m_beamRow[beam]] = rangeMeters <= m_maxRangeMeters ? rangeMeters : 0.0F;
+        }
+    }
+    m_rejectedReturns = m_noiseFilter.filter(m_rangeImage, rows, columns, m_keepMask);
+}
+
+bool VelodyneLidar::buildBlockTransforms()
+{
+    // The attached source also knows the linear velocity; the gyros cover the time it has none.
+    EgoMotion motion;
+    const bool known = (m_egoMotion && m_egoMotion->motionAt(m_scan.timestamp_us, motion))
+                       || (m_imuDeskew && m_imuMotion.motionAt(m_scan.timestamp_us, motion));
+    if (!known)
+    {
+        return false;
+    }
+
+    // One transform per packet: the sensor moves well under a millimetre between its firings.
+    m_blockTransforms.resize(m_config.blocksPerScan);
+    for (std::size_t block = 0; block < m_config.blocksPerScan; ++block)
+    {
+        const auto offset = static_cast<int64_t>(m_scan.block_timestamp_us[block] - m_scan.timestamp_us);
+        const float seconds = std::abs(offset) <= kMaxDeskewOffsetUs ? static_cast<float>(offset) * 1e-6F : 0.0F;
+        const Eigen::Vector3f rotation = motion.angularVelocity * seconds;
+        const float angle = rotation.norm();
+
+        auto& transform = m_blockTransforms[block];
+        transform.rotation = angle > 0.0F ? Eigen::AngleAxisf(angle, rotation / angle).toRotationMatrix()
+                                          : Eigen::Matrix3f::Identity();
+        transform.translation = motion.linearVelocity * seconds;
+    }
+    return true;
+}
+
+void VelodyneLidar::decodeBlocks(std::size_t firstBlock, std::size_t lastBlock, PointCloud& destination) const
+{
+    for (size_t block = firstBlock; block < lastBlock; ++block)
+    {
+        const BlockTransform* deskew = m_deskew ? &m_blockTransforms[block] : nullptr;
         for (size_t firing = 0; firing < m_config.firingSequencesPerBlock; ++firing)
         {
             const size_t firingIdx = block * m_config.firingSequencesPerBlock + firing;
@@ -152,16 +333,25 @@ void VelodyneLidar::populateGeometry(PointCloud& destination)
                 {
                     continue;
                 }
+                if (m_noiseFilterEnabled && m_keepMask[firingIdx * m_config.numBeams + m_beamRow[beam]] == 0U)
+                {
+                    continue;
+                }
 
                 const float phi = m_verticalAnglesRad[beam];
                 const float theta = baseTheta + m_spinRate * static_cast<float>(beam) * m_microsecondsPerLaserFiring;
 
                 const float cosPhi = std::cos(phi);
-                const float x = rangeMeters * cosPhi * std::cos(theta);
-                const float y = -rangeMeters * cosPhi * std::sin(theta);
-                const float z = rangeMeters * std::sin(phi);
+                Eigen::Vector3f point(rangeMeters * cosPhi * std::cos(theta),
+                                      -rangeMeters * cosPhi * std::sin(theta),
+                                      rangeMeters * std::sin(phi));
+                if (deskew)
+                {
+                    point = deskew->rotation * point + deskew->translation;
+                }
 
-                destination.push_back({x, y, z, static_cast<float>(currentFiring.v_laser[beam].refl) / 255.0F});
+                destination.push_back(
+                    {point.x(), point.y(), point.z(), static_cast<float>(currentFiring.v_laser[beam].refl) / 255.0F});
             }
         }
     }
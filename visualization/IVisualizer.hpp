@@ -1,7 +1,16 @@
 #pragma once
 
+#include "engine/FramePacer.hpp"
 #include "sensors/BaseLidarSensor.hpp"
 
+namespace lidar
+{
+class FrameCache;
+class PoseStreamMotionSource;
+class ReplayController;
+class ThreadPool;
+} // namespace lidar
+
 namespace visualization
 {
 class IVisualizer
@@ -10,10 +19,18 @@ public:
     virtual ~IVisualizer() = default;
 
     virtual bool initialize() = 0;
-    virtual void updatePoints(const lidar::BaseLidarSensor::PointCloud& points) = 0;
+    virtual void updatePoints(const lidar::BaseLidarSensor::PointCloud& points, uint64_t timestamp_us) = 0;
+    /// Sensor tilt of the frame handed to the following updatePoints call, when the sensor has one.
+    virtual void updateSensorTilt(const lidar::SensorTilt& /*tilt*/) {}
     virtual void render() = 0;
     virtual bool windowShouldClose() const = 0;
     virtual float frameSpeedScale() const = 0;
+    virtual void setThreadPool(lidar::ThreadPool* /*pool*/) {}
+    /// Stream the engine deskews the sensor with; visualizers that estimate odometry push into it.
+    virtual void setOdometryMotionSource(lidar::PoseStreamMotionSource* /*source*/) {}
+    virtual void updateFrameStats(const lidar::FrameStats& /*stats*/) {}
+    /// Called for recorded sources so the visualizer can offer playback controls.
+    virtual void setReplayController(lidar::ReplayController* /*replay*/, const lidar::FrameCache* /*cache*/) {}
 };
 
 } // namespace visualization
@@ -1,4 +1,6 @@
 #include "visualization/Visualizer.hpp"
+#include "engine/FrameCache.hpp"
+#include "engine/ReplayController.hpp"
 
 #include <GL/glew.h>
 #include <GLFW/glfw3.h>
@@ -36,6 +38,10 @@ constexpr const char* kDefaultVehicleProfileFilename = "VehicleProfileCustom.ini
 constexpr const char* kVertexShaderPath = "shaders/point.vs";
 constexpr const char* kFragmentShaderPath = "shaders/point.fs";
 constexpr std::array<const char*, 3> kColorModeLabels = {"Classification", "Height", "Intensity"};
+constexpr std::array<const char*, 3> kFreeSpaceFilterLabels = {"Latest frame", "Exponential decay", "Minimum of frames"};
+constexpr std::array<const char*, 2> kHullShapeLabels = {"Convex", "Concave"};
+constexpr std::array<const char*, 2> kSimplificationLabels = {"Douglas-Peucker", "Vertex budget"};
+constexpr std::array<const char*, 2> kGroundSegmentationLabels = {"Height threshold", "Polar plane fit"};
 constexpr std::array<const char*, 2> kAlphaModeLabels = {"User value", "Intensity"};
 constexpr std::array<const char*, 5> kCameraModeLabels = {"Free orbit", "Bird's eye", "Front", "Side", "Rear"};
 constexpr float kScrollSpeed = 2.0F;
@@ -91,6 +97,26 @@ constexpr float kGridHalfSpan = 50.0F;
 constexpr glm::vec2 kContourExpansion(0.1F, 0.1F);
 constexpr std::size_t kFreeSpaceSplineSampleCount = 192;
 constexpr std::size_t kFreeSpaceSectorSubdivisions = 10;
+constexpr std::size_t kVertexPreparationGrainSize = 8192;
+constexpr const char* kVehicleFrameBuffer = "vehicleFrame";
+constexpr const char* kGroundBuffer = "ground";
+constexpr const char* kNonGroundBuffer = "nonGround";
+constexpr const char* kObstacleBuffer = "obstacles";
+constexpr const char* kCoarseObstacleBuffer = "coarseObstacles";
+constexpr const char* kContourClearancePort = "contourClearance";
+constexpr const char* kVertexPort = "vertices";
+constexpr const char* kSensorMapPort = "sensorMap";
+constexpr const char* kFreeSpaceBoundaryPort = "freeSpaceBoundary";
+constexpr const char* kOccupancyGridPort = "occupancyGrid";
+constexpr const char* kClusterPort = "clusters";
+constexpr const char* kOdometryPort = "odometry";
+
+// Ground-plane part of a vehicle-frame transform: x, y and the rotation about z.
+mapping::PlanarMotion planarMotion(const Eigen::Isometry3f& transform)
+{
+    return mapping::PlanarMotion{std::atan2(transform.linear()(1, 0), transform.linear()(0, 0)),
+                                 glm::vec2(transform.translation().x(), transform.translation().y())};
+}
 
 std::string_view trim(std::string_view value)
 {
@@ -115,6 +141,21 @@ bool parseInt(std::string_view text, int& out)
     return result.ec == std::errc();
 }
 
+bool parseBool(std::string_view text, bool& out)
+{
+    if (text == "true" || text == "True" || text == "TRUE" || text == "1")
+    {
+        out = true;
+        return true;
+    }
+    if (text == "false" || text == "False" || text == "FALSE" || text == "0")
+    {
+        out = false;
+        return true;
+    }
+    return false;
+}
+
 std::string_view stripInlineComment(std::string_view value)
 {
     const auto semicolon = value.find(';');
@@ -138,6 +179,7 @@ VehicleProfileData loadVehicleProfile(const fs::path& profilePath)
 
     std::string currentSection;
     std::map<int, glm::vec2> contourPoints;
+    std::map<int, mapping::LidarVirtualSensorMapping::HeightBand> heightBands;
     std::string line;
     while (std::getline(file, line))
     {
@@ -306,6 +348,63 @@ VehicleProfileData loadVehicleProfile(const fs::path& profilePath)
             }
             continue;
         }
+
+        if (currentSection == "[Fusion]")
+        {
+            auto& slots = profile.virtualSlots;
+            if (rawKey == "EnableVirtualSlots")
+            {
+                parseBool(rawValue, slots.enabled);
+            }
+            else if (rawKey == "SlotDistance")
+            {
+                parseFloat(rawValue, slots.distance);
+            }
+            else if (rawKey == "SlotWidth")
+            {
+                parseFloat(rawValue, slots.width);
+            }
+            else if (rawKey == "SlotRange")
+            {
+                parseFloat(rawValue, slots.range);
+            }
+            continue;
+        }
+
+        if (currentSection == "[VirtualSensors]")
+        {
+            if (rawKey == "AngularBins")
+            {
+                int value = 0;
+                if (parseInt(rawValue, value) && value > 0)
+                {
+                    profile.angularSensorCount = static_cast<std::size_t>(value);
+                }
+            }
+            else if (rawKey.starts_with("HeightBand"))
+            {
+                // HeightBandN = minHeight,maxHeight above the floor [m]
+                int index = 0;
+                const auto commaPos = rawValue.find(',');
+                if (!parseInt(rawKey.substr(std::string_view("HeightBand").size()), index)
+                    || commaPos == std::string_view::npos)
+                {
+                    continue;
+                }
+                mapping::LidarVirtualSensorMapping::HeightBand band;
+                if (parseFloat(trim(rawValue.substr(0, commaPos)), band.minHeight)
+                    && parseFloat(trim(rawValue.substr(commaPos + 1)), band.maxHeight))
+                {
+                    heightBands[index] = band;
+                }
+            }
+            continue;
+        }
+    }
+
+    for (const auto& entry : heightBands)
+    {
+        profile.heightBands.push_back(entry.second);
     }
 
     profile.contour.reserve(contourPoints.size());
@@ -410,122 +509,346 @@ bool Visualizer::initialize()
     return true;
 }
 
-void Visualizer::updatePoints(const BaseLidarSensor::PointCloud& points)
+void Visualizer::updatePoints(const BaseLidarSensor::PointCloud& points, uint64_t timestamp_us)
 {
-    std::vector<Vertex> ground;
-    std::vector<Vertex> nonGround;
-    BaseLidarSensor::PointCloud nonGroundPoints;
-    ground.reserve(points.size());
-    nonGround.reserve(points.size());
-    nonGroundPoints.reserve(points.size());
+    if (!m_processingGraph.compiled())
+    {
+        buildProcessingGraph();
+    }
 
-    const bool useZoneColors = m_cameraMode == CameraMode::FreeOrbit;
-    m_closestContourDistance = std::numeric_limits<float>::max();
-    float cloudMinX = std::numeric_limits<float>::max();
-    float cloudMaxX = -std::numeric_limits<float>::max();
-    float cloudMinY = std::numeric_limits<float>::max();
-    float cloudMaxY = -std::numeric_limits<float>::max();
-    for (const auto& point : points)
-    {
-        // Shift LiDAR samples from the sensor frame back into the vehicle frame (front bumper origin).
-        const glm::vec2 translatedPosition{
-            point.x - m_lidarSensorOffset.x,
-            point.y - m_lidarSensorOffset.y};
-        lidar::LidarPoint translatedPoint = point;
-        translatedPoint.x = translatedPosition.x;
-        translatedPoint.y = translatedPosition.y;
-
-        const bool groundPoint = isGroundPoint(point);
-        float classification = groundPoint ? 0.0F : 1.0F;
-        if (useZoneColors)
-        {
-            classification = static_cast<float>(zoneIndexFromHeight(point.z));
-        }
-        if (!groundPoint && !m_translatedContour.empty())
-        {
-            const float contourDist = distanceToContour(translatedPosition);
-            if (contourDist < m_closestContourDistance)
+    m_processingGraph.run(points, timestamp_us);
+
+    if (m_vertexBuffer.size() > m_gpuCapacity)
+    {
+        m_gpuCapacity = m_vertexBuffer.size();
+        m_needsReallocation = true;
+    }
+
+    uploadBuffer();
+}
+
+void Visualizer::updateSensorTilt(const lidar::SensorTilt& tilt)
+{
+    m_hasTilt = true;
+    m_sensorRoll = tilt.roll;
+    m_sensorPitch = tilt.pitch;
+    m_groundSegmentation.setSensorTilt(m_sensorRoll, m_sensorPitch);
+}
+
+void Visualizer::buildProcessingGraph()
+{
+    using lidar::FrameContext;
+    using lidar::StageGraph;
+    using lidar::StageKind;
+
+    m_processingGraph = StageGraph{};
+    m_processingGraph.setThreadPool(m_threadPool);
+
+    m_processingGraph.addStage(
+        "sensorToVehicle",
+        StageKind::Filter,
+        {StageGraph::kSourceBuffer},
+        {kVehicleFrameBuffer},
+        [this](FrameContext& frame) {
+            const auto& source = frame.input(StageGraph::kSourceBuffer);
+            auto& vehicleFrame = frame.output(kVehicleFrameBuffer);
+            vehicleFrame.reserve(source.size());
+            for (const auto& point : source)
             {
-                m_closestContourDistance = contourDist;
-                m_closestContourPoint = translatedPosition;
+                // Shift LiDAR samples from the sensor frame back into the vehicle frame (front bumper origin).
+                lidar::LidarPoint translatedPoint = point;
+                translatedPoint.x = point.x - m_lidarSensorOffset.x;
+                translatedPoint.y = point.y - m_lidarSensorOffset.y;
+                vehicleFrame.push_back(translatedPoint);
             }
-        }
-        Vertex vertex{
-            translatedPoint.x,
-            translatedPoint.y,
-            point.z,
-            point.intensity,
-            classification,
-        };
-
-        if (groundPoint)
-        {
-            ground.push_back(vertex);
-        }
-        else
+        });
+
+    m_processingGraph.addStage(
+        "groundSegmentation",
+        StageKind::Segment,
+        {kVehicleFrameBuffer},
+        {kGroundBuffer, kNonGroundBuffer},
+        [this](FrameContext& frame) {
+            m_groundSegmentation.segment(frame.input(kVehicleFrameBuffer),
+                                         -m_lidarSensorOffset,
+                                         frame.output(kGroundBuffer),
+                                         frame.output(kNonGroundBuffer));
+        });
+
+    m_processingGraph.addStage(
+        "obstacleFilter",
+        StageKind::Filter,
+        {kNonGroundBuffer},
+        {kObstacleBuffer},
+        [this](FrameContext& frame) {
+            const auto& nonGround = frame.input(kNonGroundBuffer);
+            auto& obstacles = frame.output(kObstacleBuffer);
+            obstacles.reserve(nonGround.size());
+            for (const auto& point : nonGround)
+            {
+                if (point.z >= m_floorHeight)
+                {
+                    obstacles.push_back(point);
+                }
+            }
+        });
+
+    m_processingGraph.addStage(
+        "contourClearance",
+        StageKind::Map,
+        {kNonGroundBuffer},
+        {kContourClearancePort},
+        [this](FrameContext& frame) { updateClosestContourPoint(frame.input(kNonGroundBuffer)); });
+
+    m_processingGraph.addStage(
+        "vertexPreparation",
+        StageKind::Export,
+        {kGroundBuffer, kNonGroundBuffer},
+        {kVertexPort},
+        [this](FrameContext& frame) { prepareVertices(frame.input(kGroundBuffer), frame.input(kNonGroundBuffer)); });
+
+    m_processingGraph.addStage(
+        "virtualSensorMapping",
+        StageKind::Map,
+        {kObstacleBuffer, kOdometryPort},
+        {kSensorMapPort},
+        [this](FrameContext& frame) {
+            if (m_hasOdometryStep)
+            {
+                m_virtualSensorMapping.compensateEgoMotion(m_odometryStep);
+            }
+            m_virtualSensorMapping.updatePoints(frame.input(kObstacleBuffer));
+        });
+
+    m_processingGraph.addStage(
+        "freeSpaceBoundary",
+        StageKind::Export,
+        {kSensorMapPort},
+        {kFreeSpaceBoundaryPort},
+        [this](FrameContext&)
         {
-            nonGround.push_back(vertex);
-            if (point.z >= m_floorHeight)
+            // The boundary only depends on the published sensor frame; skip unchanged frames.
+            const auto sensorFrame = m_virtualSensorMapping.latestFrame();
+            if (sensorFrame && sensorFrame->version != m_freeSpaceBoundaryVersion)
             {
-                nonGroundPoints.push_back(point);
+                m_freeSpaceBoundary = buildFreeSpaceBoundary(*sensorFrame);
+                m_freeSpaceBoundaryVersion = sensorFrame->version;
+                if (m_worldFrameSettings.simplifyFreeSpaceBoundary)
+                {
+                    m_boundaryDeviation = m_boundarySimplifier.simplify(m_freeSpaceBoundary, m_simplifiedBoundary);
+                }
+            }
+        });
+
+    // The grid cannot resolve more than one return per cell, so it gets one obstacle per voxel.
+    m_obstacleVoxelGrid.configure({m_occupancyGrid.settings().resolution, mapping::VoxelReduction::FirstPoint});
+    m_processingGraph.addStage(
+        "obstacleDownsample",
+        StageKind::Filter,
+        {kObstacleBuffer},
+        {kCoarseObstacleBuffer},
+        [this](FrameContext& frame) {
+            if (m_worldFrameSettings.showOccupancyGrid)
+            {
+                m_obstacleVoxelGrid.filter(frame.input(kObstacleBuffer), frame.output(kCoarseObstacleBuffer));
+            }
+        });
+
+    m_processingGraph.addStage(
+        "occupancyGrid",
+        StageKind::Map,
+        {kCoarseObstacleBuffer, kOdometryPort},
+        {kOccupancyGridPort},
+        [this](FrameContext& frame) {
+            if (!m_worldFrameSettings.showOccupancyGrid)
+            {
+                return;
+            }
+            // Obstacles are already shifted into the vehicle frame, where the LiDAR sits at -offset.
+            const auto& obstacles = frame.input(kCoarseObstacleBuffer);
+            if (!m_odometry.valid)
+            {
+                // Without a pose successive scans cannot be aligned, so the grid only shows the latest one.
+                m_occupancyGrid.clear();
+                m_occupancyGrid.recenter(glm::vec2(0.0F));
+                m_occupancyGrid.integrate(obstacles, -m_lidarSensorOffset);
+                return;
             }
-        }
-
-        cloudMinX = std::min(cloudMinX, translatedPoint.x);
-        cloudMaxX = std::max(cloudMaxX, translatedPoint.x);
-        cloudMinY = std::min(cloudMinY, translatedPoint.y);
-        cloudMaxY = std::max(cloudMaxY, translatedPoint.y);
-    }
-
-    m_virtualSensorMapping.updatePoints(nonGroundPoints);
-    m_freeSpaceBoundary = buildFreeSpaceBoundary();
 
-    m_groundPointCount = ground.size();
-    m_nonGroundPointCount = nonGround.size();
+            // The grid lives in the odometry frame and rolls with the vehicle. A restarted odometry
+            // starts a new frame, so earlier evidence no longer lines up.
+            if (!m_hasOdometryStep)
+            {
+                m_occupancyGrid.clear();
+            }
+            const Eigen::Isometry3f& pose = m_odometry.scanToOdometry;
+            m_odometryObstacles.resize(obstacles.size());
+            for (std::size_t i = 0; i < obstacles.size(); ++i)
+            {
+                const Eigen::Vector3f point = pose * Eigen::Vector3f(obstacles[i].x, obstacles[i].y, obstacles[i].z);
+                m_odometryObstacles[i] = lidar::LidarPoint{point.x(), point.y(), point.z(), obstacles[i].intensity};
+            }
+            const Eigen::Vector3f origin = pose * Eigen::Vector3f(-m_lidarSensorOffset.x, -m_lidarSensorOffset.y, 0.0F);
+            m_occupancyGrid.recenter(glm::vec2(pose.translation().x(), pose.translation().y()));
+            m_occupancyGrid.integrate(m_odometryObstacles, glm::vec2(origin.x(), origin.y()));
+        });
+
+    m_processingGraph.addStage(
+        "scanRegistration",
+        StageKind::Map,
+        {kVehicleFrameBuffer},
+        {kOdometryPort},
+        [this](FrameContext& frame) {
+            const mapping::OdometryPose previous = m_odometry;
+            m_odometry.valid = false;
+            m_hasOdometryStep = false;
+            if (!m_worldFrameSettings.estimateOdometry)
+            {
+                // Stale poses would keep extrapolating the last motion into the sensor's deskew.
+                if (previous.valid && m_odometryMotion)
+                {
+                    m_odometryMotion->clear();
+                }
+                return;
+            }
+            // A replay seek goes back in time, so odometry restarts from the new scan.
+            const bool continues = previous.valid && frame.timestamp() > previous.timestamp_us;
+            if (!continues)
+            {
+                m_scanRegistration.reset();
+                if (m_odometryMotion)
+                {
+                    m_odometryMotion->clear();
+                }
+            }
+            m_scanRegistration.registerScan(frame.input(kVehicleFrameBuffer), m_registrationResult);
+            m_odometry = mapping::OdometryPose{frame.timestamp(), m_scanRegistration.pose(), true};
+            if (m_odometryMotion)
+            {
+                // The vehicle frame is the sensor frame shifted by -offset, so the sensor's pose is
+                // the vehicle pose applied after that shift.
+                const Eigen::Isometry3f sensorToOdometry =
+                    m_odometry.scanToOdometry
+                    * Eigen::Translation3f(-m_lidarSensorOffset.x, -m_lidarSensorOffset.y, 0.0F);
+                m_odometryMotion->pushPose(frame.timestamp(), sensorToOdometry);
+            }
+            if (continues)
+            {
+                m_odometryStep = planarMotion(m_odometry.scanToOdometry.inverse() * previous.scanToOdometry);
+                m_hasOdometryStep = true;
+            }
+        });
+
+    m_processingGraph.addStage(
+        "obstacleClustering",
+        StageKind::Segment,
+        {kObstacleBuffer},
+        {kClusterPort},
+        [this](FrameContext& frame) {
+            if (m_worldFrameSettings.showClusters)
+            {
+                m_obstacleClustering.cluster(frame.input(kObstacleBuffer));
+            }
+        });
 
-    m_vertexBuffer.clear();
-    m_vertexBuffer.reserve(ground.size() + nonGround.size());
-    m_vertexBuffer.insert(m_vertexBuffer.end(), ground.begin(), ground.end());
-    m_vertexBuffer.insert(m_vertexBuffer.end(), nonGround.begin(), nonGround.end());
+    m_processingGraph.compile();
+}
 
-    if (m_vertexBuffer.size() > m_gpuCapacity)
+void Visualizer::updateClosestContourPoint(const BaseLidarSensor::PointCloud& nonGround)
+{
+    m_closestContourDistance = std::numeric_limits<float>::max();
+    m_contourClearance.closestPoints(nonGround, 1U, m_closestContourPoints);
+    if (!m_closestContourPoints.empty())
     {
-        m_gpuCapacity = m_vertexBuffer.size();
-        m_needsReallocation = true;
+        m_closestContourDistance = m_closestContourPoints.front().distance;
+        m_closestContourPoint = m_closestContourPoints.front().position;
     }
+}
+
+void Visualizer::prepareVertices(const BaseLidarSensor::PointCloud& ground,
+                                 const BaseLidarSensor::PointCloud& nonGround)
+{
+    struct CloudBounds
+    {
+        float minX = std::numeric_limits<float>::max();
+        float maxX = -std::numeric_limits<float>::max();
+        float minY = std::numeric_limits<float>::max();
+        float maxY = -std::numeric_limits<float>::max();
+        float minZ = std::numeric_limits<float>::max();
+        float maxZ = -std::numeric_limits<float>::max();
+    };
+
+    const bool useZoneColors = m_cameraMode == CameraMode::FreeOrbit;
+    const std::size_t groundCount = ground.size();
+    m_vertexBuffer.resize(groundCount + nonGround.size());
+
+    const CloudBounds bounds = lidar::parallelReduce(
+        m_threadPool,
+        0U,
+        m_vertexBuffer.size(),
+        kVertexPreparationGrainSize,
+        CloudBounds{},
+        [&](std::size_t begin, std::size_t end) {
+            CloudBounds local;
+            for (std::size_t index = begin; index < end; ++index)
+            {
+                const bool groundPoint = index < groundCount;
+                const auto& point = groundPoint ? ground[index] : nonGround[index - groundCount];
+                float classification = groundPoint ? 0.0F : 1.0F;
+                if (useZoneColors)
+                {
+                    classification = static_cast<float>(zoneIndexFromHeight(point.z));
+                }
+                m_vertexBuffer[index] = Vertex{point.x, point.y, point.z, point.intensity, classification};
+
+                local.minX = std::min(local.minX, point.x);
+                local.maxX = std::max(local.maxX, point.x);
+                local.minY = std::min(local.minY, point.y);
+                local.maxY = std::max(local.maxY, point.y);
+                local.minZ = std::min(local.minZ, point.z);
+                local.maxZ = std::max(local.maxZ, point.z);
+            }
+            return local;
+        },
+        [](CloudBounds lhs, const CloudBounds& rhs) {
+            lhs.minX = std::min(lhs.minX, rhs.minX);
+            lhs.maxX = std::max(lhs.maxX, rhs.maxX);
+            lhs.minY = std::min(lhs.minY, rhs.minY);
+            lhs.maxY = std::max(lhs.maxY, rhs.maxY);
+            lhs.minZ = std::min(lhs.minZ, rhs.minZ);
+            lhs.maxZ = std::max(lhs.maxZ, rhs.maxZ);
+            return lhs;
+        });
+
+    m_groundPointCount = groundCount;
+    m_nonGroundPointCount = nonGround.size();
 
     if (!m_vertexBuffer.empty())
     {
-        const auto [minIt, maxIt] = std::minmax_element(
-            m_vertexBuffer.begin(),
-            m_vertexBuffer.end(),
-            [](const Vertex& lhs, const Vertex& rhs) { return lhs.z < rhs.z; });
-        m_minHeight = minIt->z;
-        m_maxHeight = maxIt->z;
+        m_minHeight = bounds.minZ;
+        m_maxHeight = bounds.maxZ;
         if (std::fabs(m_maxHeight - m_minHeight) < 1e-3F)
         {
             m_maxHeight = m_minHeight + 1e-3F;
         }
     }
 
-    if (cloudMinX <= cloudMaxX && cloudMinY <= cloudMaxY)
+    if (bounds.minX <= bounds.maxX && bounds.minY <= bounds.maxY)
     {
         const glm::vec2 defaultMin(-kGridHalfSpan);
         const glm::vec2 defaultMax(kGridHalfSpan);
         m_gridMin = glm::vec2(
-            std::min(cloudMinX, defaultMin.x),
-            std::min(cloudMinY, defaultMin.y));
+            std::min(bounds.minX, defaultMin.x),
+            std::min(bounds.minY, defaultMin.y));
         m_gridMax = glm::vec2(
-            std::max(cloudMaxX, defaultMax.x),
-            std::max(cloudMaxY, defaultMax.y));
+            std::max(bounds.maxX, defaultMax.x),
+            std::max(bounds.maxY, defaultMax.y));
     }
     else
     {
         m_gridMin = glm::vec2(-kGridHalfSpan);
         m_gridMax = glm::vec2(kGridHalfSpan);
     }
-
-    uploadBuffer();
 }
 
 void Visualizer::render()
@@ -585,6 +908,18 @@ void Visualizer::render()
     {
         drawBsplineFreeSpaceMap();
     }
+    if (m_worldFrameSettings.enableWorldVisualization && m_worldFrameSettings.showObstacleEnvelope)
+    {
+        drawOverlayPolygon(m_virtualSensorMapping.envelope(), glm::vec3(1.0F, 0.55F, 0.1F), 0.6F);
+    }
+    if (m_worldFrameSettings.enableWorldVisualization && m_worldFrameSettings.showOccupancyGrid)
+    {
+        drawOccupancyGrid();
+    }
+    if (m_worldFrameSettings.enableWorldVisualization && m_worldFrameSettings.showClusters)
+    {
+        drawClusters();
+    }
 
     if (m_worldFrameSettings.enableWorldVisualization && m_worldFrameSettings.showVehicleContour)
     {
@@ -651,12 +986,47 @@ void Visualizer::render()
     ImGui::NewFrame();
 
     drawWorldControls();
+    drawReplayControls();
 
     ImGui::Begin("LiDAR Stats");
     ImGui::Text("Total points: %zu", m_vertexBuffer.size());
     ImGui::Text("Ground points: %zu", m_groundPointCount);
     ImGui::Text("Non-ground points: %zu", m_nonGroundPointCount);
     ImGui::Text("GPU capacity: %zu", m_gpuCapacity);
+    ImGui::Separator();
+    ImGui::Text("Frames processed: %llu", static_cast<unsigned long long>(m_frameStats.framesProcessed));
+    ImGui::Text("Frames dropped: %llu (stale %llu)",
+                static_cast<unsigned long long>(m_frameStats.framesDropped),
+                static_cast<unsigned long long>(m_frameStats.staleFramesDropped));
+    ImGui::Text("Decimation: 1/%zu", m_frameStats.decimationFactor);
+    ImGui::Text("Data age: %.1f ms (max %.1f ms)",
+                static_cast<double>(m_frameStats.lastDataAge.count()) / 1000.0,
+                static_cast<double>(m_frameStats.maxDataAge.count()) / 1000.0);
+    if (m_worldFrameSettings.showBsplineFreeSpaceMap && m_worldFrameSettings.simplifyFreeSpaceBoundary)
+    {
+        ImGui::Text("Boundary: %zu of %zu vertices, max deviation %.3f m",
+                    m_simplifiedBoundary.size(),
+                    m_freeSpaceBoundary.size(),
+                    m_boundaryDeviation);
+    }
+    if (m_hasTilt)
+    {
+        ImGui::Text(
+            "Sensor tilt: roll %.1f deg, pitch %.1f deg", glm::degrees(m_sensorRoll), glm::degrees(m_sensorPitch));
+    }
+    if (m_worldFrameSettings.estimateOdometry)
+    {
+        const auto& pose = m_scanRegistration.pose();
+        ImGui::Separator();
+        ImGui::Text("Odometry: x %.2f m, y %.2f m, yaw %.1f deg",
+                    pose.translation().x(),
+                    pose.translation().y(),
+                    glm::degrees(std::atan2(pose.linear()(1, 0), pose.linear()(0, 0))));
+        ImGui::Text("ICP: %zu iterations, %zu matches, rmse %.3f m",
+                    m_registrationResult.iterations,
+                    m_registrationResult.correspondences,
+                    m_registrationResult.rmse);
+    }
     ImGui::End();
 
     ImGui::Render();
@@ -692,11 +1062,12 @@ void Visualizer::uploadBuffer()
 
 void Visualizer::drawFreeSpaceMap()
 {
-    const auto snapshots = m_virtualSensorMapping.snapshots();
-    if (snapshots.empty())
+    const auto sensorFrame = m_virtualSensorMapping.latestFrame();
+    if (!sensorFrame || sensorFrame->sensors.empty())
     {
         return;
     }
+    const auto& snapshots = sensorFrame->sensors;
 
     const glm::vec3 freespaceColor(1.0F, 0.9F, 0.0F);
     for (const auto& snapshot : snapshots)
@@ -708,7 +1079,7 @@ void Visualizer::drawFreeSpaceMap()
         }
         else
         {
-            farRange = kVirtualSensorMaxRange;
+            farRange = snapshot.isAngular ? kVirtualSensorMaxRange : snapshot.orthMaxLat;
         }
 
         const auto polygon = buildFreeSpacePolygon(snapshot, farRange);
@@ -717,7 +1088,7 @@ void Visualizer::drawFreeSpaceMap()
             continue;
         }
 
-        const float alpha = snapshot.valid ? 0.35F : 0.15F;
+        const float alpha = snapshot.valid ? 0.15F + 0.2F * snapshot.confidence : 0.15F;
         const glm::vec3& color = freespaceColor;
         drawOverlayPolygon(polygon, color, alpha);
 
@@ -728,20 +1099,70 @@ void Visualizer::drawFreeSpaceMap()
     }
 }
 
+void Visualizer::drawClusters()
+{
+    std::vector<glm::vec2> box(4U);
+    for (const auto& cluster : m_obstacleClustering.clusters())
+    {
+        const auto corners = cluster.orientedCorners();
+        std::copy(corners.begin(), corners.end(), box.begin());
+        drawOverlayPolygon(box, glm::vec3(1.0F, 0.85F, 0.1F), 0.35F);
+    }
+}
+
+void Visualizer::drawOccupancyGrid()
+{
+    // With odometry the cells are in the odometry frame; draw them in the current vehicle frame.
+    const Eigen::Isometry3f toVehicle =
+        m_odometry.valid ? m_odometry.scanToOdometry.inverse() : Eigen::Isometry3f::Identity();
+    m_occupancyVertices.clear();
+    m_occupancyGrid.forEachOccupied([this, &toVehicle](const glm::vec2& center, float) {
+        const Eigen::Vector3f position = toVehicle * Eigen::Vector3f(center.x, center.y, 0.0F);
+        m_occupancyVertices.push_back(Vertex{position.x(), position.y(), 0.0F, 0.0F, 0.0F});
+    });
+    if (m_occupancyVertices.empty())
+    {
+        return;
+    }
+
+    glBindVertexArray(m_overlayVao);
+    glBindBuffer(GL_ARRAY_BUFFER, m_overlayVbo);
+    glBufferData(GL_ARRAY_BUFFER,
+                 static_cast<GLsizeiptr>(m_occupancyVertices.size() * sizeof(Vertex)),
+                 m_occupancyVertices.data(),
+                 GL_DYNAMIC_DRAW);
+
+    applyForceColor(glm::vec3(0.95F, 0.3F, 0.2F), 0.8F);
+    if (m_pointSizeLoc >= 0)
+    {
+        glUniform1f(m_pointSizeLoc, kVirtualSensorPointSize * 0.5F);
+    }
+    glDrawArrays(GL_POINTS, 0, static_cast<GLsizei>(m_occupancyVertices.size()));
+    resetForceColor();
+    if (m_pointSizeLoc >= 0)
+    {
+        glUniform1f(m_pointSizeLoc, m_worldFrameSettings.pointSize);
+    }
+}
+
 void Visualizer::drawBsplineFreeSpaceMap()
 {
-    if (m_freeSpaceBoundary.size() < 3)
+    // The simplified outline is what would be sent downstream, so it replaces the dense one.
+    const auto& boundary =
+        m_worldFrameSettings.simplifyFreeSpaceBoundary ? m_simplifiedBoundary : m_freeSpaceBoundary;
+    if (boundary.size() < 3)
     {
         return;
     }
 
     const glm::vec3 freespaceColor(0.2F, 0.6F, 1.0F);
-    drawOverlayPolygon(m_freeSpaceBoundary, freespaceColor, 0.45F);
+    drawOverlayPolygon(boundary, freespaceColor, 0.45F);
 }
 
-std::vector<glm::vec2> Visualizer::buildFreeSpaceBoundary() const
+std::vector<glm::vec2> Visualizer::buildFreeSpaceBoundary(
+    const mapping::LidarVirtualSensorMapping::SensorFrame& sensorFrame) const
 {
-    const auto snapshots = m_virtualSensorMapping.snapshots();
+    const auto& snapshots = sensorFrame.sensors;
     if (snapshots.size() < 3)
     {
         return {};
@@ -752,6 +1173,11 @@ std::vector<glm::vec2> Visualizer::buildFreeSpaceBoundary() const
     const float twoPi = glm::two_pi<float>();
     for (const auto& snapshot : snapshots)
     {
+        if (!snapshot.isAngular)
+        {
+            continue;
+        }
+
         float startAngle = snapshot.lowerAngle;
         float endAngle = snapshot.upperAngle;
         if (snapshot.wrapAround && endAngle < startAngle)
@@ -762,7 +1188,7 @@ std::vector<glm::vec2> Visualizer::buildFreeSpaceBoundary() const
         float sectorSpan = endAngle - startAngle;
         if (sectorSpan <= 1e-4F)
         {
-            sectorSpan = twoPi / static_cast<float>(mapping::LidarVirtualSensorMapping::kNumAngularSensors);
+            sectorSpan = twoPi / static_cast<float>(m_virtualSensorMapping.angularSensorCount());
         }
 
         float radius = kVirtualSensorMaxRange;
@@ -1058,6 +1484,88 @@ void Visualizer::applyUniforms()
     }
 }
 
+void Visualizer::setReplayController(lidar::ReplayController* replay, const lidar::FrameCache* cache)
+{
+    m_replay = replay;
+    m_frameCache = cache;
+}
+
+void Visualizer::drawReplayControls()
+{
+    if (!m_replay)
+    {
+        return;
+    }
+
+    ImGui::Begin("Replay");
+    if (ImGui::Button("<|"))
+    {
+        m_replay->stepBackward();
+    }
+    ImGui::SameLine();
+    if (ImGui::Button(m_replay->paused() ? "Play" : "Pause"))
+    {
+        if (m_replay->paused())
+        {
+            m_replay->play();
+        }
+        else
+        {
+            m_replay->pause();
+        }
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("|>"))
+    {
+        m_replay->stepForward();
+    }
+    ImGui::SameLine();
+    bool reverse = m_replay->reverse();
+    if (ImGui::Checkbox("Reverse", &reverse))
+    {
+        m_replay->setReverse(reverse);
+    }
+
+    const int lastFrame = static_cast<int>(m_replay->knownFrameCount()) - 1;
+    int frame = static_cast<int>(m_replay->position());
+    if (ImGui::SliderInt("Frame", &frame, 0, std::max(lastFrame, 0)))
+    {
+        m_replay->pause();
+        m_replay->jumpTo(static_cast<std::size_t>(frame));
+    }
+
+    if (ImGui::Button("Set A"))
+    {
+        m_replay->setLoopStart();
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Set B"))
+    {
+        m_replay->setLoopEnd();
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Clear loop"))
+    {
+        m_replay->clearLoop();
+    }
+    if (const auto& loop = m_replay->loop())
+    {
+        ImGui::Text("Loop: %zu - %zu", loop->first, loop->second);
+    }
+
+    if (m_frameCache)
+    {
+        ImGui::Text("Cache: %zu frames, %.1f / %.1f MB",
+                    m_frameCache->entryCount(),
+                    static_cast<double>(m_frameCache->sizeBytes()) / (1024.0 * 1024.0),
+                    static_cast<double>(m_frameCache->capacityBytes()) / (1024.0 * 1024.0));
+        ImGui::Text("Cache hits: %llu, misses: %llu",
+                    static_cast<unsigned long long>(m_frameCache->hits()),
+                    static_cast<unsigned long long>(m_frameCache->misses()));
+    }
+    ImGui::End();
+}
+
 void Visualizer::drawWorldControls()
 {
     ImGui::Begin("LiDAR Controls");
@@ -1069,6 +1577,92 @@ void Visualizer::drawWorldControls()
         ImGui::Checkbox(
             "Show B-spline freespace map",
             &m_worldFrameSettings.showBsplineFreeSpaceMap);
+        if (m_worldFrameSettings.showBsplineFreeSpaceMap)
+        {
+            auto simplifier = m_boundarySimplifier.settings();
+            int simplificationIdx = static_cast<int>(simplifier.mode);
+            int maxVertices = static_cast<int>(simplifier.maxVertices);
+            bool simplifierChanged =
+                ImGui::Checkbox("Simplify boundary", &m_worldFrameSettings.simplifyFreeSpaceBoundary);
+            if (m_worldFrameSettings.simplifyFreeSpaceBoundary)
+            {
+                simplifierChanged |= ImGui::Combo("Simplification",
+                                                  &simplificationIdx,
+                                                  kSimplificationLabels.data(),
+                                                  static_cast<int>(kSimplificationLabels.size()));
+                if (simplifier.mode == mapping::SimplificationMode::DouglasPeucker)
+                {
+                    simplifierChanged |= ImGui::SliderFloat("Boundary tolerance", &simplifier.tolerance, 0.01F, 1.0F);
+                }
+                else
+                {
+                    simplifierChanged |= ImGui::SliderInt("Boundary vertices",
+                                                          &maxVertices,
+                                                          static_cast<int>(mapping::BoundarySimplifier::kMinVertices),
+                                                          static_cast<int>(kFreeSpaceSplineSampleCount));
+                }
+            }
+            if (simplifierChanged)
+            {
+                simplifier.mode = static_cast<mapping::SimplificationMode>(simplificationIdx);
+                simplifier.maxVertices = static_cast<std::size_t>(maxVertices);
+                m_boundarySimplifier.configure(simplifier);
+                // Rebuild on the next frame even if the sensor frame has not changed.
+                m_freeSpaceBoundaryVersion = 0U;
+            }
+        }
+        if (ImGui::Checkbox("Show occupancy grid", &m_worldFrameSettings.showOccupancyGrid)
+            && !m_worldFrameSettings.showOccupancyGrid)
+        {
+            m_occupancyGrid.clear();
+        }
+        ImGui::Checkbox("Show clusters", &m_worldFrameSettings.showClusters);
+        if (ImGui::Checkbox("Estimate odometry", &m_worldFrameSettings.estimateOdometry))
+        {
+            m_scanRegistration.reset();
+            m_registrationResult = mapping::RegistrationResult{};
+        }
+
+        auto accumulator = m_virtualSensorMapping.accumulatorSettings();
+        int filterIdx = static_cast<int>(accumulator.filter);
+        int windowFrames = static_cast<int>(accumulator.windowFrames);
+        bool accumulatorChanged = ImGui::Combo(
+            "Free-space filter", &filterIdx, kFreeSpaceFilterLabels.data(), static_cast<int>(kFreeSpaceFilterLabels.size()));
+        accumulatorChanged |= ImGui::SliderInt(
+            "Filter frames", &windowFrames, 1, static_cast<int>(mapping::FreeSpaceAccumulator::kMaxWindowFrames));
+        if (accumulator.filter == mapping::FreeSpaceFilter::ExponentialDecay)
+        {
+            accumulatorChanged |= ImGui::SliderFloat("Filter decay", &accumulator.decay, 0.05F, 0.99F);
+        }
+        if (accumulatorChanged)
+        {
+            accumulator.filter = static_cast<mapping::FreeSpaceFilter>(filterIdx);
+            accumulator.windowFrames = static_cast<std::size_t>(windowFrames);
+            m_virtualSensorMapping.setAccumulatorSettings(accumulator);
+        }
+
+        if (ImGui::Checkbox("Show obstacle envelope", &m_worldFrameSettings.showObstacleEnvelope))
+        {
+            m_virtualSensorMapping.setEnvelopeEnabled(m_worldFrameSettings.showObstacleEnvelope);
+        }
+        if (m_worldFrameSettings.showObstacleEnvelope)
+        {
+            auto envelope = m_virtualSensorMapping.envelopeSettings();
+            int envelopeShapeIdx = static_cast<int>(envelope.shape);
+            bool envelopeChanged = ImGui::Combo("Envelope shape",
+                                                &envelopeShapeIdx,
+                                                kHullShapeLabels.data(),
+                                                static_cast<int>(kHullShapeLabels.size()));
+            if (envelope.shape == mapping::HullShape::Concave)
+            {
+                envelopeChanged |= ImGui::SliderFloat("Envelope edge length", &envelope.lengthThreshold, 0.1F, 5.0F);
+            }
+            if (envelopeChanged)
+            {
+                envelope.shape = static_cast<mapping::HullShape>(envelopeShapeIdx);
+                m_virtualSensorMapping.setEnvelopeSettings(envelope);
+            }
+        }
         ImGui::Checkbox("Show vehicle contour", &m_worldFrameSettings.showVehicleContour);
         if (!m_vehicleProfileEntries.empty())
         {
@@ -1154,11 +1748,23 @@ void Visualizer::drawWorldControls()
                 "Base transparency", &m_worldFrameSettings.commonTransparency, 0.1F, 1.0F);
         }
 
-        ImGui::SliderFloat(
-            "Ground height threshold",
-            &m_worldFrameSettings.groundClassificationHeight,
-            -2.0F,
-            2.0F);
+        auto segmentation = m_groundSegmentation.settings();
+        int segmentationIdx = static_cast<int>(segmentation.mode);
+        bool segmentationChanged = ImGui::Combo("Ground segmentation",
+                                                &segmentationIdx,
+                                                kGroundSegmentationLabels.data(),
+                                                static_cast<int>(kGroundSegmentationLabels.size()));
+        segmentationChanged |= ImGui::SliderFloat("Ground height threshold", &segmentation.heightThreshold, -2.0F, 2.0F);
+        if (segmentation.mode == mapping::GroundSegmentationMode::PolarPlaneFit)
+        {
+            segmentationChanged |=
+                ImGui::SliderFloat("Ground distance", &segmentation.distanceThreshold, 0.05F, 0.5F);
+        }
+        if (segmentationChanged)
+        {
+            segmentation.mode = static_cast<mapping::GroundSegmentationMode>(segmentationIdx);
+            m_groundSegmentation.configure(segmentation);
+        }
         ImGui::Separator();
 
         ImGui::Checkbox("Ground plane", &m_worldFrameSettings.enableGroundPlane);
@@ -1208,11 +1814,12 @@ void Visualizer::drawWorldControls()
 
 void Visualizer::drawVirtualSensorsFancy()
 {
-    const auto snapshots = m_virtualSensorMapping.snapshots();
-    if (snapshots.empty())
+    const auto sensorFrame = m_virtualSensorMapping.latestFrame();
+    if (!sensorFrame || sensorFrame->sensors.empty())
     {
         return;
     }
+    const auto& snapshots = sensorFrame->sensors;
 
     GLboolean depthMask = GL_TRUE;
     glGetBooleanv(GL_DEPTH_WRITEMASK, &depthMask);
@@ -1283,11 +1890,6 @@ void Visualizer::configureVertexArray(GLuint vao, GLuint vbo)
     glBindVertexArray(0);
 }
 
-bool Visualizer::isGroundPoint(const lidar::LidarPoint& point) const noexcept
-{
-    return point.z <= m_worldFrameSettings.groundClassificationHeight;
-}
-
 int Visualizer::zoneIndexFromHeight(float height) const noexcept
 {
     for (size_t i = 0; i < kZoneThresholds.size(); ++i)
@@ -1465,26 +2067,20 @@ std::vector<glm::vec2> Visualizer::buildSensorPolygon(
         return {nearLower, nearUpper, farUpper, farLower};
     }
 
-    const glm::vec2 baseLower = snapshot.reference + glm::vec2(snapshot.orthMinX, 0.0F);
-    const glm::vec2 baseUpper = snapshot.reference + glm::vec2(snapshot.orthMaxX, 0.0F);
+    // Slot ranges are lateral distances from the centre line; never draw inside the vehicle side.
     const float side = snapshot.orthSideSign != 0.0F ? snapshot.orthSideSign : 1.0F;
-    const glm::vec2 nearOffset(0.0F, side * normalizedNear);
-    const glm::vec2 farOffset(0.0F, side * normalizedFar);
-    return {baseLower + nearOffset, baseUpper + nearOffset, baseUpper + farOffset, baseLower + farOffset};
+    const float nearLateral = snapshot.reference.x + side * std::max(normalizedNear, snapshot.orthMinLat);
+    const float farLateral = snapshot.reference.x + side * std::max(normalizedFar, snapshot.orthMinLat);
+    return {glm::vec2(nearLateral, snapshot.orthMinLon),
+            glm::vec2(nearLateral, snapshot.orthMaxLon),
+            glm::vec2(farLateral, snapshot.orthMaxLon),
+            glm::vec2(farLateral, snapshot.orthMinLon)};
 }
 
 std::vector<glm::vec2> Visualizer::buildSensorMeasurementPolygon(
     const mapping::LidarVirtualSensorMapping::SensorSnapshot& snapshot) const
 {
-    float farRange;
-    if (snapshot.isAngular)
-    {
-        farRange = glm::clamp(std::sqrt(snapshot.distanceSquared), 0.0F, kVirtualSensorMaxRange);
-    }
-    else
-    {
-        farRange = glm::clamp(std::abs(snapshot.position.y - snapshot.reference.y), 0.0F, kVirtualSensorMaxRange);
-    }
+    const float farRange = glm::clamp(std::sqrt(snapshot.distanceSquared), 0.0F, kVirtualSensorMaxRange);
     const float nearRange = std::max(farRange - kVirtualSensorThickness, 0.0F);
     return buildSensorPolygon(snapshot, nearRange, farRange);
 }
@@ -1492,7 +2088,7 @@ std::vector<glm::vec2> Visualizer::buildSensorMeasurementPolygon(
 std::vector<glm::vec2> Visualizer::buildSensorShadowPolygon(
     const mapping::LidarVirtualSensorMapping::SensorSnapshot& snapshot) const
 {
-    return buildSensorPolygon(snapshot, 0.0F, kVirtualSensorMaxRange);
+    return buildSensorPolygon(snapshot, 0.0F, snapshot.isAngular ? kVirtualSensorMaxRange : snapshot.orthMaxLat);
 }
 
 std::vector<glm::vec2> Visualizer::buildFreeSpacePolygon(
@@ -1665,6 +2261,7 @@ void Visualizer::updateContourTranslation()
 
 void Visualizer::updateSensorOffsets()
 {
+    m_contourClearance.setContour(m_translatedContour);
     if (m_translatedContour.empty())
     {
         return;
@@ -1673,38 +2270,6 @@ void Visualizer::updateSensorOffsets()
     m_virtualSensorMapping.setVehicleContour(m_translatedContour);
 }
 
-float Visualizer::distanceToContour(const glm::vec2& point) const
-{
-    if (m_translatedContour.size() < 2)
-    {
-        return std::numeric_limits<float>::max();
-    }
-
-    float best = std::numeric_limits<float>::max();
-    for (std::size_t idx = 0; idx < m_translatedContour.size(); ++idx)
-    {
-        const auto& start = m_translatedContour[idx];
-        const auto& end = m_translatedContour[(idx + 1) % m_translatedContour.size()];
-        best = std::min(best, distanceToSegment(start, end, point));
-    }
-    return best;
-}
-
-float Visualizer::distanceToSegment(const glm::vec2& a, const glm::vec2& b, const glm::vec2& point) const
-{
-    const glm::vec2 ab = b - a;
-    const float abSquared = glm::dot(ab, ab);
-    if (abSquared < 1e-6F)
-    {
-        return glm::length(point - a);
-    }
-
-    float t = glm::dot(point - a, ab) / abSquared;
-    t = std::clamp(t, 0.0F, 1.0F);
-    const glm::vec2 projection = a + ab * t;
-    return glm::length(point - projection);
-}
-
 void Visualizer::refreshVehicleProfiles()
 {
     std::vector<std::string> entries;
@@ -1765,13 +2330,17 @@ void Visualizer::applyVehicleProfile(int index)
     m_mountHeight = m_currentVehicleProfile.lidarHeightAboveGround;
     m_floorHeight = -std::fabs(m_mountHeight);
     m_virtualSensorMapping.setFloorHeight(m_floorHeight);
+    m_virtualSensorMapping.setAngularSensorCount(m_currentVehicleProfile.angularSensorCount);
+    m_virtualSensorMapping.setSlotSettings(m_currentVehicleProfile.virtualSlots);
+    m_virtualSensorMapping.setHeightBands(m_currentVehicleProfile.heightBands);
     m_lidarSensorOffset = {
         m_currentVehicleProfile.lidarLatPos,
         -m_currentVehicleProfile.lidarLonPos - m_currentVehicleProfile.distRearAxle};
     m_lidarVcsPosition = -m_lidarSensorOffset;
     m_lidarOrientationIsoDeg = m_currentVehicleProfile.lidarOrientation;
     m_contourTranslation = glm::vec2(0.0F,0.0F);
-    m_virtualSensorMapping.setSensorOffset(m_lidarSensorOffset);
+    // The processing graph hands the mapper points that are already in the vehicle frame.
+    m_virtualSensorMapping.setSensorOffset(glm::vec2(0.0F));
     updateContourTranslation();
 }
 
@@ -1829,4 +2398,12 @@ float Visualizer::frameSpeedScale() const
     return std::max(0.01F, m_worldFrameSettings.replaySpeed);
 }
 
+void Visualizer::setThreadPool(lidar::ThreadPool* pool)
+{
+    m_threadPool = pool;
+    m_processingGraph.setThreadPool(pool);
+    m_virtualSensorMapping.setThreadPool(pool);
+    m_scanRegistration.setThreadPool(pool);
+}
+
 } // namespace visualization
@@ -1,7 +1,17 @@
 #pragma once
 
+#include "engine/StageGraph.hpp"
+#include "engine/ThreadPool.hpp"
 #include "sensors/BaseLidarSensor.hpp"
+#include "sensors/EgoMotion.hpp"
+#include "mapping/BoundarySimplifier.hpp"
+#include "mapping/ContourClearance.hpp"
+#include "mapping/EuclideanClustering.hpp"
+#include "mapping/GroundSegmentation.hpp"
 #include "mapping/LidarVirtualSensorMapping.hpp"
+#include "mapping/OccupancyGrid.hpp"
+#include "mapping/ScanRegistration.hpp"
+#include "mapping/VoxelGridFilter.hpp"
 #include "visualization/IVisualizer.hpp"
 #include "visualization/Shader.hpp"
 
@@ -12,6 +22,7 @@
 #include <algorithm>
 #include <array>
 #include <cstddef>
+#include <cstdint>
 #include <limits>
 #include <memory>
 #include <string>
@@ -36,6 +47,9 @@ struct VehicleProfileData
     float wheelBase = 0.0F;
     float width = 0.0F;
     float widthIncludingMirrors = 0.0F;
+    std::size_t angularSensorCount = mapping::LidarVirtualSensorMapping::kDefaultAngularSensorCount;
+    mapping::LidarVirtualSensorMapping::SlotSettings virtualSlots;
+    std::vector<mapping::LidarVirtualSensorMapping::HeightBand> heightBands;
 };
 using BaseLidarSensor = lidar::BaseLidarSensor;
 
@@ -46,12 +60,17 @@ public:
     ~Visualizer();
 
     bool initialize() override;
-    void updatePoints(const BaseLidarSensor::PointCloud& points) override;
+    void updatePoints(const BaseLidarSensor::PointCloud& points, uint64_t timestamp_us) override;
+    void updateSensorTilt(const lidar::SensorTilt& tilt) override;
     void render() override;
     bool windowShouldClose() const override;
     glm::vec3 computeCameraDirection() const;
     glm::vec3 computeCameraUp() const;
     float frameSpeedScale() const override;
+    void setThreadPool(lidar::ThreadPool* pool) override;
+    void setOdometryMotionSource(lidar::PoseStreamMotionSource* source) override { m_odometryMotion = source; }
+    void updateFrameStats(const lidar::FrameStats& stats) override { m_frameStats = stats; }
+    void setReplayController(lidar::ReplayController* replay, const lidar::FrameCache* cache) override;
 
 private:
     struct Vertex
@@ -109,25 +128,35 @@ private:
         float commonTransparency = 0.65F;
         float groundPlaneTransparency = 0.75F;
         float nongroundPlaneTransparency = 0.9F;
-        float groundClassificationHeight = -1.208F;
         float replaySpeed = 0.1F;
         std::array<float, 3> groundPlaneColor = {0.1F, 0.7F, 0.1F};
         std::array<float, 3> nonGroundPlaneColor = {1.0F, 0.35F, 0.0F};
         bool showVirtualSensorMap = false;
         bool showFreeSpaceMap = false;
         bool showBsplineFreeSpaceMap = false;
+        bool simplifyFreeSpaceBoundary = false;
+        bool showObstacleEnvelope = false;
+        bool showOccupancyGrid = false;
+        bool showClusters = false;
+        bool estimateOdometry = false;
         bool showVehicleContour = true;
         std::array<float, 3> vehicleContourColor = {0.15F, 0.7F, 1.0F};
         float vehicleContourTransparency = 0.65F;
         float vehicleContourRotation = 0.0F;
     };
 
+    void buildProcessingGraph();
+    void prepareVertices(const BaseLidarSensor::PointCloud& ground, const BaseLidarSensor::PointCloud& nonGround);
+    void updateClosestContourPoint(const BaseLidarSensor::PointCloud& nonGround);
     void uploadBuffer();
     void cleanUp();
     void applyUniforms();
     void drawWorldControls();
+    void drawReplayControls();
     void drawVirtualSensorsFancy();
     void drawFreeSpaceMap();
+    void drawOccupancyGrid();
+    void drawClusters();
     void drawBsplineFreeSpaceMap();
     void configureVertexArray(GLuint vao, GLuint vbo);
     void drawColorLegend();
@@ -137,7 +166,6 @@ private:
                          const glm::vec3& color,
                          float alpha,
                          float elevation = 0.0F);
-    bool isGroundPoint(const lidar::LidarPoint& point) const noexcept;
     void processCursorPos(double xpos, double ypos);
     void processScroll(double yoffset);
     void processMouseButton(int button, int action);
@@ -162,7 +190,7 @@ private:
     void drawSensorPoint(const mapping::LidarVirtualSensorMapping::SensorSnapshot& snapshot,
                          const glm::vec3& color,
                          float alpha);
-    std::vector<glm::vec2> buildFreeSpaceBoundary() const;
+    std::vector<glm::vec2> buildFreeSpaceBoundary(const mapping::LidarVirtualSensorMapping::SensorFrame& sensorFrame) const;
     float snapshotMidAngle(const mapping::LidarVirtualSensorMapping::SensorSnapshot& snapshot) const;
     std::vector<double> sampleBspline(const std::vector<double>& parameters,
                                       const std::vector<double>& values,
@@ -174,8 +202,6 @@ private:
     void resetForceColor();
     void updateContourTranslation();
     void updateSensorOffsets();
-    float distanceToContour(const glm::vec2& point) const;
-    float distanceToSegment(const glm::vec2& a, const glm::vec2& b, const glm::vec2& point) const;
     GLFWwindow* m_window = nullptr;
     GLuint m_vao = 0;
     GLuint m_vbo = 0;
@@ -201,11 +227,42 @@ private:
     std::vector<glm::vec2> m_translatedContour;
     glm::vec2 m_closestContourPoint = glm::vec2(0.0F);
     float m_closestContourDistance = std::numeric_limits<float>::max();
+    mapping::ContourClearance m_contourClearance;
+    std::vector<mapping::ContourClearance::ClearancePoint> m_closestContourPoints;
     std::vector<glm::vec2> m_freeSpaceBoundary;
+    uint64_t m_freeSpaceBoundaryVersion = 0U;
+    mapping::BoundarySimplifier m_boundarySimplifier;
+    std::vector<glm::vec2> m_simplifiedBoundary;
+    float m_boundaryDeviation = 0.0F;
     Camera m_camera;
     CameraMode m_cameraMode = CameraMode::FreeOrbit;
     int m_activeMouseButton = -1;
     mapping::LidarVirtualSensorMapping m_virtualSensorMapping;
+    mapping::GroundSegmentation m_groundSegmentation;
+    mapping::OccupancyGrid m_occupancyGrid;
+    mapping::VoxelGridFilter m_obstacleVoxelGrid;
+    mapping::EuclideanClustering m_obstacleClustering;
+    mapping::ScanRegistration m_scanRegistration;
+    mapping::RegistrationResult m_registrationResult;
+    /// Published by the scanRegistration stage for the stages reading kOdometryPort.
+    mapping::OdometryPose m_odometry;
+    /// Vehicle motion since the previous registered scan, valid when m_hasOdometryStep is set.
+    mapping::PlanarMotion m_odometryStep;
+    bool m_hasOdometryStep = false;
+    /// Receives the odometry in the sensor frame; owned by the engine.
+    lidar::PoseStreamMotionSource* m_odometryMotion = nullptr;
+    /// From the sensor's IMU; levels the ground segmentation's reference plane.
+    bool m_hasTilt = false;
+    float m_sensorRoll = 0.0F;
+    float m_sensorPitch = 0.0F;
+    std::vector<Vertex> m_occupancyVertices;
+    /// Coarse obstacles moved into the odometry frame for the occupancy grid.
+    BaseLidarSensor::PointCloud m_odometryObstacles;
+    lidar::ThreadPool* m_threadPool = nullptr;
+    lidar::StageGraph m_processingGraph;
+    lidar::FrameStats m_frameStats;
+    lidar::ReplayController* m_replay = nullptr;
+    const lidar::FrameCache* m_frameCache = nullptr;
     float m_mountHeight = 1.8F;
     float m_floorHeight = -1.5F;
     GLint m_forceColorLoc = -1;